@@ -0,0 +1,114 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/**
+ * @file Arduino.h
+ * @brief Minimal Arduino core for the native (host) build
+ *
+ * Only what the motion code uses: time base, GPIO as plain state arrays and a small
+ * String. millis()/micros() count from program start on the host kernel clock (real
+ * or virtual time, see HostKernel.h).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include "HostKernel.h"
+
+using std::max;
+using std::min;
+
+#define PI 3.14159265358979323846
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define IRAM_ATTR
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+namespace host {
+#define HOST_GPIO_COUNT 64
+inline int* pinStates() {
+    static int states[HOST_GPIO_COUNT] = {};
+    return states;
+}
+} // namespace host
+
+// 32-bit wrap like the device
+inline unsigned long micros() {
+    return (unsigned long)(uint32_t)host::Kernel::get().nowUs();
+}
+
+inline unsigned long millis() {
+    return (unsigned long)(uint32_t)(host::Kernel::get().nowUs() / 1000);
+}
+
+inline void delay(unsigned long ms) {
+    host::Kernel::get().sleepMs(ms);
+}
+
+// Blocks the calling task; the device busy-waits, which keeps its core just as long
+inline void delayMicroseconds(unsigned int us) {
+    host::Kernel::get().sleepUntil(host::Kernel::get().nowUs() + us);
+}
+
+inline void pinMode(uint8_t, uint8_t) {}
+
+inline void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < HOST_GPIO_COUNT) {
+        host::pinStates()[pin] = value;
+    }
+}
+
+inline int digitalRead(uint8_t pin) {
+    return pin < HOST_GPIO_COUNT ? host::pinStates()[pin] : LOW;
+}
+
+inline int analogRead(uint8_t) {
+    return 0;
+}
+
+// The serial port is only handed through - the TMC2209 model (TMC2209.h) times its own traffic
+class HardwareSerial {};
+
+class String {
+private:
+    std::string value;
+
+public:
+    String() {}
+    String(const char* text) : value(text ? text : "") {}
+    String(const std::string& text) : value(text) {}
+    String(int number) : value(std::to_string(number)) {}
+    String(unsigned int number) : value(std::to_string(number)) {}
+    String(long number) : value(std::to_string(number)) {}
+    String(unsigned long number) : value(std::to_string(number)) {}
+    String(float number, unsigned int decimals = 2) : String((double)number, decimals) {}
+    String(double number, unsigned int decimals = 2) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, number);
+        value = buffer;
+    }
+
+    const char* c_str() const { return value.c_str(); }
+    unsigned int length() const { return (unsigned int)value.size(); }
+    bool isEmpty() const { return value.empty(); }
+
+    String& operator+=(const String& other) {
+        value += other.value;
+        return *this;
+    }
+    friend String operator+(const String& a, const String& b) { return String(a.value + b.value); }
+    friend String operator+(const char* a, const String& b) { return String(a) + b; }
+    bool operator==(const String& other) const { return value == other.value; }
+    bool operator!=(const String& other) const { return value != other.value; }
+};
+
+#endif // HOST_ARDUINO_H
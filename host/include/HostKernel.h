@@ -0,0 +1,329 @@
+#ifndef HOST_KERNEL_H
+#define HOST_KERNEL_H
+
+/**
+ * @file HostKernel.h
+ * @brief Time base and task switching behind the host Arduino/FreeRTOS shims
+ *
+ * Every shim that can block (delay, vTaskDelay, queue send/receive, task notifications)
+ * waits through Kernel::waitUntil(), millis()/micros() read Kernel::nowUs() and
+ * xTaskCreate() goes through Kernel::createTask(). That is the firmware's clock/scheduler
+ * interface on the host: on the device the same calls go to the FreeRTOS tick, here they
+ * run on one of two clocks.
+ *
+ * - Real time (default): tasks are threads, waits sleep on the steady clock.
+ * - Virtual time (enableVirtualTime() before any task starts): discrete-event simulation.
+ *   Tasks are cooperative fibers on the calling thread. Time stands still while any task
+ *   is runnable; once every task is blocked it jumps straight to the earliest wait
+ *   deadline. Code between two blocking calls takes zero time, so hours of firmware time
+ *   pass in a second of host time and every run is identical. A task that polls millis()
+ *   in a loop without blocking stalls the clock.
+ *
+ * On x86-64 Linux fibers switch with a few lines of assembly that only swap the callee-saved
+ * registers and the stack pointer. swapcontext() also saves and restores the signal mask with
+ * a system call on every switch - a fifth of the host time of the 12 h virtual cook. Other
+ * hosts keep swapcontext().
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define HOST_KERNEL_FAST_SWITCH 1
+#else
+#define HOST_KERNEL_FAST_SWITCH 0
+#endif
+
+#if HOST_KERNEL_FAST_SWITCH
+// Save the callee-saved registers on the current stack, store its pointer to *saveStack and
+// continue on loadStack (same layout). One copy per program via the COMDAT group.
+asm(R"(
+    .pushsection .text.host_fiber_switch,"axG",@progbits,host_fiber_switch,comdat
+    .weak host_fiber_switch
+    .hidden host_fiber_switch
+    .type host_fiber_switch,@function
+host_fiber_switch:
+    pushq %rbp
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    movq %rsp, (%rdi)
+    movq %rsi, %rsp
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    popq %rbp
+    ret
+    .size host_fiber_switch, .-host_fiber_switch
+    .popsection
+)");
+extern "C" void host_fiber_switch(void** saveStack, void* loadStack);
+#endif
+
+struct HostTask {
+    uint32_t notificationValue = 0; // Guarded by the kernel lock
+};
+
+namespace host {
+
+// Kernel lock (and ESP-IDF critical sections): a mutex in real time. In virtual time every
+// fiber runs on one thread and only switches inside Kernel::waitUntil(), which releases it
+// first, so there is nothing to exclude and locking is skipped.
+class HostMutex {
+private:
+    std::mutex mutex;
+
+public:
+    static bool& bypassed() {
+        static bool bypass = false;
+        return bypass;
+    }
+    void lock() {
+        if (!bypassed()) {
+            mutex.lock();
+        }
+    }
+    void unlock() {
+        if (!bypassed()) {
+            mutex.unlock();
+        }
+    }
+};
+
+static const uint64_t WAIT_FOREVER = UINT64_MAX;
+static const size_t FIBER_STACK_SIZE = 256 * 1024; // Device stack sizes are far too small for host code
+
+class Kernel {
+private:
+    typedef void (*TaskFunction)(void*);
+
+    struct Fiber {
+#if HOST_KERNEL_FAST_SWITCH
+        void* stackPointer; // Saved by host_fiber_switch() while switched out
+#else
+        ucontext_t context;
+#endif
+        HostTask task;
+        TaskFunction function;
+        void* parameter;
+        // Current wait (virtual time)
+        uint64_t deadlineUs;
+        const void* channel; // Woken by notify() on this object (queue, task), nullptr: only by its deadline
+        bool waiting;
+    };
+
+    HostMutex lock;
+    std::condition_variable_any changed; // Real time: any shared state change
+    const std::chrono::steady_clock::time_point start;
+
+    // Virtual time
+    bool virtualTime;
+    uint64_t virtualNowUs;
+    Fiber mainFiber;
+    Fiber* current;
+    std::vector<Fiber*> fibers; // Every task and main - a handful, so waits are flags scanned in place
+    std::vector<Fiber*> ready;  // Runnable, in wake order
+
+    __attribute__((noinline)) Kernel() // Out of line, so get() stays small enough to inline
+        : start(std::chrono::steady_clock::now()), virtualTime(false), virtualNowUs(0), mainFiber(), current(&mainFiber),
+          fibers(1, &mainFiber) {}
+
+    static HostTask*& threadTask() {
+        thread_local HostTask* task = nullptr;
+        return task;
+    }
+
+    static void fiberEntry() {
+        Kernel& kernel = get();
+        Fiber* fiber = kernel.current;
+        fiber->function(fiber->parameter);
+
+        // Task returned - never scheduled again (its stack is not reclaimed)
+        kernel.switchToNext();
+    }
+
+    void wake(Fiber* fiber) {
+        fiber->waiting = false;
+        ready.push_back(fiber);
+    }
+
+    // Every task is blocked: jump to the earliest deadline and wake what is due
+    void advance() {
+        uint64_t next = WAIT_FOREVER;
+        for (Fiber* fiber : fibers) {
+            if (fiber->waiting && fiber->deadlineUs < next) {
+                next = fiber->deadlineUs;
+            }
+        }
+        if (next == WAIT_FOREVER) {
+            fprintf(stderr, "host: every task is blocked without a timeout - virtual clock stopped\n");
+            abort();
+        }
+        if (next > virtualNowUs) {
+            virtualNowUs = next;
+        }
+        for (Fiber* fiber : fibers) {
+            if (fiber->waiting && fiber->deadlineUs <= virtualNowUs) {
+                wake(fiber);
+            }
+        }
+    }
+
+    // Leave the current fiber (already waiting or finished) for the next runnable one
+    void switchToNext() {
+        if (ready.empty()) {
+            advance();
+        }
+        Fiber* previous = current;
+        current = ready.front();
+        ready.erase(ready.begin());
+        if (current != previous) {
+#if HOST_KERNEL_FAST_SWITCH
+            host_fiber_switch(&previous->stackPointer, current->stackPointer);
+#else
+            swapcontext(&previous->context, &current->context);
+#endif
+        }
+    }
+
+public:
+    static Kernel& get() {
+        static Kernel kernel;
+        return kernel;
+    }
+
+    // Switch to the discrete-event clock; call from main() before starting any task
+    void enableVirtualTime() {
+        virtualTime = true;
+        HostMutex::bypassed() = true;
+    }
+    bool isVirtualTime() const { return virtualTime; }
+
+    HostMutex& mutex() { return lock; }
+
+    uint64_t nowUs() {
+        if (virtualTime) {
+            return virtualNowUs;
+        }
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Deadline for a relative timeout in ms
+    uint64_t deadlineInMs(uint64_t timeoutMs) {
+        return timeoutMs == WAIT_FOREVER ? WAIT_FOREVER : nowUs() + timeoutMs * 1000;
+    }
+
+    // Task record of the caller (notification value)
+    HostTask* currentTask() {
+        if (virtualTime) {
+            return &current->task;
+        }
+        HostTask*& task = threadTask();
+        if (!task) {
+            task = new HostTask(); // main thread
+        }
+        return task;
+    }
+
+    HostTask* createTask(TaskFunction function, void* parameter) {
+        if (virtualTime) {
+            Fiber* fiber = new Fiber();
+            fiber->function = function;
+            fiber->parameter = parameter;
+            char* stack = static_cast<char*>(malloc(FIBER_STACK_SIZE));
+#if HOST_KERNEL_FAST_SWITCH
+            // First switch pops six zero registers and returns into fiberEntry() as if called
+            // from a 16-byte aligned frame (fiberEntry never returns)
+            void** top = reinterpret_cast<void**>(reinterpret_cast<uintptr_t>(stack + FIBER_STACK_SIZE) & ~uintptr_t(15));
+            *--top = nullptr;
+            *--top = reinterpret_cast<void*>(&fiberEntry);
+            for (int i = 0; i < 6; i++) {
+                *--top = nullptr;
+            }
+            fiber->stackPointer = top;
+#else
+            getcontext(&fiber->context);
+            fiber->context.uc_stack.ss_sp = stack;
+            fiber->context.uc_stack.ss_size = FIBER_STACK_SIZE;
+            fiber->context.uc_link = nullptr;
+            makecontext(&fiber->context, fiberEntry, 0);
+#endif
+            fibers.push_back(fiber);
+            ready.push_back(fiber); // Starts at the creator's next blocking call
+            return &fiber->task;
+        }
+
+        HostTask* task = new HostTask();
+        std::thread([function, parameter, task] {
+            threadTask() = task;
+            function(parameter);
+        }).detach();
+        return task;
+    }
+
+    // Block until ready() holds (true) or the deadline passes (false). Caller holds the lock;
+    // ready() is re-evaluated whenever notify() is called for the channel the caller waits on.
+    template <typename Predicate>
+    bool waitUntil(std::unique_lock<HostMutex>& guard, uint64_t deadlineUs, Predicate isReady, const void* channel) {
+        while (!isReady()) {
+            if (nowUs() >= deadlineUs) {
+                return false;
+            }
+            if (!virtualTime) {
+                if (deadlineUs == WAIT_FOREVER) {
+                    changed.wait(guard);
+                } else {
+                    changed.wait_until(guard, start + std::chrono::microseconds(deadlineUs));
+                }
+                continue;
+            }
+
+            // All fibers share this thread - nobody else can take the lock while we are switched out
+            current->deadlineUs = deadlineUs;
+            current->channel = channel;
+            current->waiting = true;
+            guard.unlock();
+            switchToNext();
+            guard.lock();
+        }
+        return true;
+    }
+
+    // Channel state changed (caller holds the lock) - let the tasks blocked on it re-check. Only
+    // those wake in virtual time: a status publish must not cost a switch to every other task.
+    void notify(const void* channel) {
+        if (virtualTime) {
+            for (Fiber* fiber : fibers) {
+                if (fiber->waiting && fiber->channel == channel) {
+                    wake(fiber);
+                }
+            }
+            return;
+        }
+        changed.notify_all();
+    }
+
+    void sleepUntil(uint64_t deadlineUs) {
+        std::unique_lock<HostMutex> guard(lock);
+        waitUntil(guard, deadlineUs, [] { return false; }, nullptr);
+    }
+
+    void sleepMs(uint64_t ms) {
+        sleepUntil(deadlineInMs(ms));
+    }
+};
+
+} // namespace host
+
+#endif // HOST_KERNEL_H
@@ -0,0 +1,80 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+/**
+ * @file Preferences.h
+ * @brief In-memory stand-in for the ESP32 NVS Preferences on the native build
+ *
+ * Values live for the lifetime of the process; every run starts from defaults.
+ */
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+private:
+    std::map<std::string, std::vector<uint8_t>> values;
+    bool opened = false;
+
+    template <typename T>
+    T getValue(const char* key, T defaultValue) {
+        auto it = values.find(key);
+        if (it == values.end() || it->second.size() != sizeof(T)) {
+            return defaultValue;
+        }
+        T result;
+        memcpy(&result, it->second.data(), sizeof(T));
+        return result;
+    }
+
+    template <typename T>
+    size_t putValue(const char* key, T value) {
+        return putBytes(key, &value, sizeof(T));
+    }
+
+public:
+    bool begin(const char*, bool = false) {
+        opened = true;
+        return true;
+    }
+    void end() { opened = false; }
+
+    bool isKey(const char* key) { return values.count(key) != 0; }
+    bool remove(const char* key) { return values.erase(key) != 0; }
+    bool clear() {
+        values.clear();
+        return true;
+    }
+
+    size_t putBytes(const char* key, const void* data, size_t length) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        values[key].assign(bytes, bytes + length);
+        return length;
+    }
+    size_t getBytesLength(const char* key) {
+        auto it = values.find(key);
+        return it == values.end() ? 0 : it->second.size();
+    }
+    size_t getBytes(const char* key, void* buffer, size_t maxLength) {
+        auto it = values.find(key);
+        if (it == values.end() || it->second.size() > maxLength) {
+            return 0;
+        }
+        memcpy(buffer, it->second.data(), it->second.size());
+        return it->second.size();
+    }
+
+    size_t putBool(const char* key, bool value) { return putValue(key, value); }
+    size_t putInt(const char* key, int32_t value) { return putValue(key, value); }
+    size_t putUInt(const char* key, uint32_t value) { return putValue(key, value); }
+    size_t putFloat(const char* key, float value) { return putValue(key, value); }
+
+    bool getBool(const char* key, bool defaultValue = false) { return getValue(key, defaultValue); }
+    int32_t getInt(const char* key, int32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    float getFloat(const char* key, float defaultValue = NAN) { return getValue(key, defaultValue); }
+};
+
+#endif // HOST_PREFERENCES_H
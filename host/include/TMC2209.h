@@ -0,0 +1,107 @@
+#ifndef HOST_TMC2209_H
+#define HOST_TMC2209_H
+
+/**
+ * @file TMC2209.h
+ * @brief Timing model of the TMC2209 UART library on the native build
+ *
+ * Only the calls TMC2209RegisterCache and DriverIOTask make. Register values are not
+ * modelled, the bus time is: every write sends one 8-byte datagram, every read a 4-byte
+ * request and waits for the 8-byte reply, and the calling task is blocked for as long as
+ * the bytes take at the configured baud rate. The bus model (shared by all drivers) injects
+ * faults: an extra delay before each reply, or no reply at all - then every read waits
+ * TMC2209_HOST_REPLY_TIMEOUT_US and fails, and writes are not counted in IFCNT.
+ */
+
+#include <Arduino.h>
+
+#define TMC2209_HOST_REPLY_TIMEOUT_US 5000 // Model assumption: how long a read waits for a missing reply
+#define TMC2209_HOST_BITS_PER_BYTE 10      // Start + 8 data + stop bit
+
+// Fault injection for every TMC2209 on the bus
+struct TMC2209BusModel {
+    uint32_t replyDelayUs; // Extra wait before each reply (slow or disturbed driver)
+    bool answering;        // false: reads time out, writes are lost
+
+    TMC2209BusModel() : replyDelayUs(0), answering(true) {}
+};
+
+class TMC2209 {
+public:
+    enum SerialAddress {
+        SERIAL_ADDRESS_0 = 0,
+        SERIAL_ADDRESS_1 = 1,
+        SERIAL_ADDRESS_2 = 2,
+        SERIAL_ADDRESS_3 = 3
+    };
+
+    struct Status {
+        uint32_t over_temperature_warning : 1;
+        uint32_t over_temperature_shutdown : 1;
+        uint32_t over_temperature_120c : 1;
+        uint32_t over_temperature_143c : 1;
+        uint32_t over_temperature_150c : 1;
+        uint32_t over_temperature_157c : 1;
+    };
+
+private:
+    long baudRate;
+    uint8_t transmissionCounter;
+
+    void transfer(uint8_t bytes) {
+        delayMicroseconds((unsigned int)(bytes * TMC2209_HOST_BITS_PER_BYTE * 1000000L / baudRate));
+    }
+
+    void write() {
+        transfer(8);
+        if (bus().answering) {
+            transmissionCounter++;
+        }
+    }
+
+    bool read() {
+        transfer(4);
+        if (!bus().answering) {
+            delayMicroseconds(TMC2209_HOST_REPLY_TIMEOUT_US);
+            return false;
+        }
+        delayMicroseconds(bus().replyDelayUs);
+        transfer(8);
+        return true;
+    }
+
+public:
+    TMC2209() : baudRate(115200), transmissionCounter(0) {}
+
+    static TMC2209BusModel& bus() {
+        static TMC2209BusModel model;
+        return model;
+    }
+
+    void setup(HardwareSerial&, long serialBaudRate, SerialAddress, int16_t = -1, int16_t = -1) {
+        baudRate = serialBaudRate;
+    }
+
+    bool isSetupAndCommunicating() { return read(); }
+
+    void enable() { write(); }
+    void disable() { write(); }
+    void setMicrostepsPerStep(uint16_t) { write(); }
+    void setRunCurrent(uint8_t) { write(); }
+    void enableAutomaticCurrentScaling() { write(); }
+    void disableAutomaticCurrentScaling() { write(); }
+    void enableAutomaticGradientAdaptation() { write(); }
+    void disableAutomaticGradientAdaptation() { write(); }
+    void enableStealthChop() { write(); }
+    void disableStealthChop() { write(); }
+    void setCoolStepDurationThreshold(uint32_t) { write(); }
+    void setStallGuardThreshold(uint8_t) { write(); }
+    void moveAtVelocity(int32_t) { write(); }
+    void moveUsingStepDirInterface() { write(); }
+
+    uint16_t getStallGuardResult() { return read() ? 250 : 0; }
+    Status getStatus() { read(); return Status(); }
+    uint8_t getInterfaceTransmissionCounter() { return read() ? transmissionCounter : 0; }
+};
+
+#endif // HOST_TMC2209_H
@@ -0,0 +1,48 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+/**
+ * @file FreeRTOS.h
+ * @brief FreeRTOS subset on std::thread for the native (host) build
+ *
+ * Tasks are threads, queues are ring buffers and the tick is 1 ms of the host kernel
+ * clock, so the whole task set can run in real or virtual time (see HostKernel.h).
+ * Priorities and core affinity are accepted and ignored; ESP-IDF critical sections are mutexes.
+ */
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <mutex>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+#define errQUEUE_FULL 0
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+// ESP-IDF critical section (spinlock) API
+struct portMUX_TYPE {
+    host::HostMutex lock;
+};
+#define portMUX_INITIALIZE(mux) ((void)(mux))
+inline void portENTER_CRITICAL(portMUX_TYPE* mux) { mux->lock.lock(); }
+inline void portEXIT_CRITICAL(portMUX_TYPE* mux) { mux->lock.unlock(); }
+
+namespace host {
+// Absolute kernel deadline for a FreeRTOS timeout (caller holds the kernel lock)
+inline uint64_t ticksToDeadline(TickType_t ticks) {
+    return ticks == portMAX_DELAY ? WAIT_FOREVER : Kernel::get().deadlineInMs((uint64_t)ticks * portTICK_PERIOD_MS);
+}
+} // namespace host
+
+#endif // HOST_FREERTOS_H
@@ -0,0 +1,113 @@
+#ifndef HOST_FREERTOS_QUEUE_H
+#define HOST_FREERTOS_QUEUE_H
+
+#include "FreeRTOS.h"
+#include <vector>
+
+// Ring buffer guarded by the host kernel lock (blocking goes through Kernel::waitUntil)
+struct HostQueue {
+    std::vector<uint8_t> storage;
+    UBaseType_t itemSize;
+    UBaseType_t length;
+    UBaseType_t head;
+    UBaseType_t count;
+
+    HostQueue(UBaseType_t length, UBaseType_t itemSize)
+        : storage(length * itemSize), itemSize(itemSize), length(length), head(0), count(0) {}
+
+    void push(const void* item) {
+        memcpy(&storage[((head + count) % length) * itemSize], item, itemSize);
+        count++;
+    }
+};
+
+typedef HostQueue* QueueHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    return new HostQueue(length, itemSize);
+}
+
+inline void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    host::Kernel& kernel = host::Kernel::get();
+    std::unique_lock<host::HostMutex> lock(kernel.mutex());
+    if (!kernel.waitUntil(lock, host::ticksToDeadline(ticksToWait), [queue] { return queue->count < queue->length; }, queue)) {
+        return errQUEUE_FULL;
+    }
+    queue->push(item);
+    kernel.notify(queue);
+    return pdPASS;
+}
+
+#define xQueueSendToBack xQueueSend
+
+inline BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    host::Kernel& kernel = host::Kernel::get();
+    std::unique_lock<host::HostMutex> lock(kernel.mutex());
+    if (!kernel.waitUntil(lock, host::ticksToDeadline(ticksToWait), [queue] { return queue->count < queue->length; }, queue)) {
+        return errQUEUE_FULL;
+    }
+    queue->head = (queue->head + queue->length - 1) % queue->length;
+    memcpy(&queue->storage[queue->head * queue->itemSize], item, queue->itemSize);
+    queue->count++;
+    kernel.notify(queue);
+    return pdPASS;
+}
+
+inline BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item) {
+    // Only defined for length-1 queues (mailboxes)
+    host::Kernel& kernel = host::Kernel::get();
+    std::lock_guard<host::HostMutex> lock(kernel.mutex());
+    queue->head = 0;
+    queue->count = 0;
+    queue->push(item);
+    kernel.notify(queue);
+    return pdPASS;
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    host::Kernel& kernel = host::Kernel::get();
+    std::unique_lock<host::HostMutex> lock(kernel.mutex());
+    if (!kernel.waitUntil(lock, host::ticksToDeadline(ticksToWait), [queue] { return queue->count > 0; }, queue)) {
+        return pdFALSE;
+    }
+    memcpy(item, &queue->storage[queue->head * queue->itemSize], queue->itemSize);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    kernel.notify(queue);
+    return pdTRUE;
+}
+
+inline BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    host::Kernel& kernel = host::Kernel::get();
+    std::unique_lock<host::HostMutex> lock(kernel.mutex());
+    if (!kernel.waitUntil(lock, host::ticksToDeadline(ticksToWait), [queue] { return queue->count > 0; }, queue)) {
+        return pdFALSE;
+    }
+    memcpy(item, &queue->storage[queue->head * queue->itemSize], queue->itemSize);
+    return pdTRUE;
+}
+
+inline BaseType_t xQueueReset(QueueHandle_t queue) {
+    host::Kernel& kernel = host::Kernel::get();
+    std::lock_guard<host::HostMutex> lock(kernel.mutex());
+    queue->head = 0;
+    queue->count = 0;
+    kernel.notify(queue);
+    return pdPASS;
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<host::HostMutex> lock(host::Kernel::get().mutex());
+    return queue->count;
+}
+
+inline UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    std::lock_guard<host::HostMutex> lock(host::Kernel::get().mutex());
+    return queue->length - queue->count;
+}
+
+#endif // HOST_FREERTOS_QUEUE_H
@@ -0,0 +1,59 @@
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void*);
+typedef HostTask* TaskHandle_t;
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char*, uint32_t, void* parameter,
+                                          UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    HostTask* task = host::Kernel::get().createTask(function, parameter);
+    if (handle) {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+inline BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackSize, void* parameter,
+                              UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(function, name, stackSize, parameter, priority, handle, tskNO_AFFINITY);
+}
+
+// Threads cannot be killed from outside: deleting another task only forgets its handle, and a
+// task deleting itself (end of Task::taskWrapper) simply returns from its thread function.
+inline void vTaskDelete(TaskHandle_t) {}
+
+inline void vTaskDelay(TickType_t ticks) {
+    host::Kernel::get().sleepMs((uint64_t)ticks * portTICK_PERIOD_MS);
+}
+
+inline TickType_t xTaskGetTickCount() {
+    return (TickType_t)(millis() / portTICK_PERIOD_MS);
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return host::Kernel::get().currentTask();
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    host::Kernel& kernel = host::Kernel::get();
+    std::lock_guard<host::HostMutex> lock(kernel.mutex());
+    task->notificationValue++;
+    kernel.notify(task);
+    return pdPASS;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+    host::Kernel& kernel = host::Kernel::get();
+    HostTask* task = kernel.currentTask();
+    std::unique_lock<host::HostMutex> lock(kernel.mutex());
+    kernel.waitUntil(lock, host::ticksToDeadline(ticksToWait), [task] { return task->notificationValue > 0; }, task);
+    const uint32_t value = task->notificationValue;
+    if (value > 0) {
+        task->notificationValue = clearCountOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+#endif // HOST_FREERTOS_TASK_H
@@ -46,12 +46,16 @@ public:
     CommandCharacteristicCallbacks(BLEManager* manager) : bleManager(manager) {}
     
     void onWrite(BLECharacteristic* pCharacteristic) override {
+        const uint32_t receivedUs = micros(); // Start of the command trace
         std::string value = pCharacteristic->getValue();
         
         if (value.length() > 0 && value.length() <= 256) {
+            // All writes arrive on the BLE stack's callback task - it owns the lock-free command lane
+            bleManager->systemCommand.claimRingLane();
+            
             // Process command directly - SystemCommand handles thread-safe queuing
             // Commands are lightweight as they just queue data to SystemCommand
-            bleManager->handleCommand(value);
+            bleManager->handleCommand(value, receivedUs);
         }
     }
 };
@@ -133,7 +137,7 @@ bool BLEManager::begin(const char* deviceName) {
 
 // setStepperController method removed - using SystemCommand singleton directly
 
-void BLEManager::handleCommand(const std::string& command) {
+void BLEManager::handleCommand(const std::string& command, uint32_t receivedUs) {
     dbg_printf("Processing command: %s (length: %d)\n", command.c_str(), command.length());
     
     // Prevent buffer overflow attacks  
@@ -145,46 +149,75 @@ void BLEManager::handleCommand(const std::string& command) {
     // Use fixed-size JSON document to prevent heap issues (compatible with ArduinoJson v6)
     JsonDocument doc;
     DeserializationError error = deserializeJson(doc, command);
+    commandTrace = CommandTrace();
+    commandTrace.receivedUs = receivedUs;
+    commandTrace.parsedUs = micros();
     
     if (error) {
         dbg_printf("JSON parse error: %s\n", error.c_str());
         return;
     }
     
+    // Optional client sequence number - every command that carries one is acknowledged
+    commandTrace.seq = doc["seq"] | 0;
+    
     const char* type = doc["type"];
     if (!type) {
         dbg_println("Missing command type");
+        acknowledge(CommandResult::REJECTED);
         return;
     }
     
     // Validate that we have the required value field for most commands
-    if (strcmp(type, "status_request") != 0 && doc["value"].isNull()) {
+    const bool valueless = strcmp(type, "status_request") == 0 || strcmp(type, "latency_dump") == 0 ||
+                           strcmp(type, "latency_reset") == 0 || strcmp(type, "emergency_stop") == 0;
+    if (!valueless && doc["value"].isNull()) {
         dbg_println("ERROR: Command missing required 'value' field");
+        acknowledge(CommandResult::REJECTED);
         return;
     }
     
-    dbg_printf("Processing command type: %s\n", type);
+    // Optional axis ID - commands without one address the main spit (axis 0)
+    const int axisValue = doc["axis"] | 0;
+    if (axisValue < 0 || axisValue >= STEPPER_MAX_AXES) {
+        dbg_printf("ERROR: Invalid axis: %d\n", axisValue);
+        sendNotification("error", "Axis must be 0-3");
+        acknowledge(CommandResult::REJECTED);
+        return;
+    }
+    const uint8_t axis = static_cast<uint8_t>(axisValue);
     
-    if (strcmp(type, "speed") == 0) {
+    dbg_printf("Processing command type: %s (axis %u)\n", type, axis);
+    
+    if (strcmp(type, "emergency_stop") == 0) {
+        // Fast lane - overtakes everything queued and is never dropped; always stops every axis
+        systemCommand.emergencyStop(commandTrace);
+        dbg_println("Emergency stop queued");
+    }
+    else if (strcmp(type, "speed") == 0) {
         float speed = doc["value"];
         StepperCommandData cmd(StepperCommand::SET_SPEED, speed);
-        systemCommand.sendCommand(cmd);
+        cmd.axis = axis;
+        sendStepperCommand(cmd);
         dbg_printf("Speed command queued: %.2f RPM\n", speed);
     }
     else if (strcmp(type, "direction") == 0) {
         bool clockwise = doc["value"];
         StepperCommandData cmd(StepperCommand::SET_DIRECTION, clockwise);
-        systemCommand.sendCommand(cmd);
+        cmd.axis = axis;
+        sendStepperCommand(cmd);
         dbg_printf("Direction command queued: %s\n", clockwise ? "clockwise" : "counter-clockwise");
     }
     else if (strcmp(type, "enable") == 0) {
         bool enable = doc["value"];
         if (enable) {
             StepperCommandData cmd(StepperCommand::ENABLE);
-            systemCommand.sendCommand(cmd);
+            cmd.axis = axis;
+            sendStepperCommand(cmd);
         } else {
             StepperCommandData cmd(StepperCommand::DISABLE);
-            systemCommand.sendCommand(cmd);
+            cmd.axis = axis;
+            sendStepperCommand(cmd);
         }
         dbg_printf("Motor %s command queued\n", enable ? "enable" : "disable");
     }
@@ -192,27 +225,43 @@ void BLEManager::handleCommand(const std::string& command) {
         int current = doc["value"];
         if (current >= 10 && current <= 100) {
             StepperCommandData cmd(StepperCommand::SET_CURRENT, current);
-            systemCommand.sendCommand(cmd);
+            cmd.axis = axis;
+            sendStepperCommand(cmd);
             dbg_printf("Current command queued: %d%%\n", current);
+        } else {
+            dbg_println("Invalid current");
+            acknowledge(CommandResult::REJECTED);
         }
     }
     else if (strcmp(type, "reset") == 0) {
         StepperCommandData cmd(StepperCommand::RESET_COUNTERS);
-        systemCommand.sendCommand(cmd);
+        cmd.axis = axis;
+        sendStepperCommand(cmd);
         dbg_printf("Reset counters command queued\n");
     }
     else if (strcmp(type, "reset_stall") == 0) {
         StepperCommandData cmd(StepperCommand::RESET_STALL_COUNT);
-        systemCommand.sendCommand(cmd);
+        cmd.axis = axis;
+        sendStepperCommand(cmd);
         dbg_printf("Reset stall count command queued\n");
     }
     else if (strcmp(type, "status_request") == 0) {
         // Request all current status from StepperController
         dbg_println("Status request received, requesting all current status...");
         StepperCommandData cmd(StepperCommand::REQUEST_ALL_STATUS);
-        systemCommand.sendCommand(cmd);
+        cmd.axis = doc["axis"].isNull() ? STEPPER_AXIS_ALL : axis;
+        sendStepperCommand(cmd);
         PowerDeliveryCommandData pdCmd(PowerDeliveryCommand::REQUEST_ALL_STATUS);
-        systemCommand.sendPowerDeliveryCommand(pdCmd);
+        systemCommand.sendPowerDeliveryCommand(pdCmd); // Acked by the stepper task
+    }
+    else if (strcmp(type, "latency_dump") == 0) {
+        // Latency histograms of all scheduler jobs and the command queue (one status update each)
+        sendStepperCommand(StepperCommandData(StepperCommand::REQUEST_LATENCY_HISTOGRAMS));
+        dbg_println("Latency histogram dump requested");
+    }
+    else if (strcmp(type, "latency_reset") == 0) {
+        sendStepperCommand(StepperCommandData(StepperCommand::RESET_LATENCY_HISTOGRAMS));
+        dbg_println("Latency histogram reset requested");
     }
     else if (strcmp(type, "acceleration") == 0) {
         // Set acceleration directly in steps/s²
@@ -220,49 +269,161 @@ void BLEManager::handleCommand(const std::string& command) {
         
         if (accelerationStepsPerSec2 >= 100 && accelerationStepsPerSec2 <= 100000) {
             StepperCommandData cmd(StepperCommand::SET_ACCELERATION, (int)accelerationStepsPerSec2);
-            systemCommand.sendCommand(cmd);
+            cmd.axis = axis;
+            sendStepperCommand(cmd);
             dbg_printf("Acceleration command queued: %u steps/s²\n", accelerationStepsPerSec2);
         } else {
             dbg_println("Invalid acceleration parameters");
             sendNotification("error", "Acceleration must be 100-100000 steps/s²");
+            acknowledge(CommandResult::REJECTED);
+        }
+    }
+    else if (strcmp(type, "jerk_limit") == 0) {
+        // S-curve jerk limit in steps/s³, 0 turns the S-curve off
+        uint32_t jerkStepsPerSec3 = doc["value"];
+
+        if (jerkStepsPerSec3 <= 10000000) {
+            StepperCommandData cmd(StepperCommand::SET_JERK_LIMIT, jerkStepsPerSec3);
+            cmd.axis = axis;
+            sendStepperCommand(cmd);
+            dbg_printf("Jerk limit command queued: %u steps/s³\n", jerkStepsPerSec3);
+        } else {
+            dbg_println("Invalid jerk limit");
+            sendNotification("error", "Jerk limit must be 0-10000000 steps/s³");
+            acknowledge(CommandResult::REJECTED);
         }
     }
     else if (strcmp(type, "speed_variation_strength") == 0) {
         float strength = doc["value"];
         if (strength >= 0.0f && strength <= 1.0f) {
             StepperCommandData cmd(StepperCommand::SET_SPEED_VARIATION, strength);
-            systemCommand.sendCommand(cmd);
+            cmd.axis = axis;
+            sendStepperCommand(cmd);
             dbg_printf("Speed variation strength command queued: %.2f\n", strength);
         } else {
             dbg_println("Invalid speed variation strength");
             sendNotification("error", "Speed variation strength must be 0.0-1.0");
+            acknowledge(CommandResult::REJECTED);
         }
     }
     else if (strcmp(type, "speed_variation_phase") == 0) {
         float phase = doc["value"];
         StepperCommandData cmd(StepperCommand::SET_SPEED_VARIATION_PHASE, phase);
-        systemCommand.sendCommand(cmd);
+        cmd.axis = axis;
+        sendStepperCommand(cmd);
         dbg_printf("Speed variation phase command queued: %.2f radians\n", phase);
     }
+    else if (strcmp(type, "transaction") == 0) {
+        // Several parameters applied at once, e.g. a preset - same keys as in status_update:
+        // {"type":"transaction","value":{"speed":2.0,"acceleration":800,"speedVariationStrength":0.3,
+        //  "speedVariationPhase":0.0,"speedVariationEnabled":true,"enabled":true}}
+        JsonObject params = doc["value"];
+        StepperTransaction transaction = {};
+        if (!params["speed"].isNull()) {
+            transaction.fields |= TRANSACTION_SPEED;
+            transaction.speed = params["speed"];
+        }
+        if (!params["acceleration"].isNull()) {
+            transaction.fields |= TRANSACTION_ACCELERATION;
+            transaction.acceleration = params["acceleration"];
+        }
+        if (!params["speedVariationStrength"].isNull()) {
+            transaction.fields |= TRANSACTION_VARIATION_STRENGTH;
+            transaction.variationStrength = params["speedVariationStrength"];
+        }
+        if (!params["speedVariationPhase"].isNull()) {
+            transaction.fields |= TRANSACTION_VARIATION_PHASE;
+            transaction.variationPhase = params["speedVariationPhase"];
+        }
+        if (!params["speedVariationEnabled"].isNull()) {
+            transaction.fields |= TRANSACTION_VARIATION_ENABLE;
+            transaction.variationEnable = params["speedVariationEnabled"];
+        }
+        if (!params["enabled"].isNull()) {
+            transaction.fields |= TRANSACTION_ENABLE;
+            transaction.enable = params["enabled"];
+        }
+        
+        // Reject the whole transaction if one value is out of range
+        if (transaction.fields == 0) {
+            dbg_println("Transaction without parameters");
+            sendNotification("error", "Transaction has no parameters");
+            acknowledge(CommandResult::REJECTED);
+        } else if ((transaction.fields & TRANSACTION_SPEED) &&
+                   (transaction.speed < 0.1f || transaction.speed > 30.0f)) {
+            sendNotification("error", "Transaction rejected: speed must be 0.1-30 RPM");
+            acknowledge(CommandResult::REJECTED);
+        } else if ((transaction.fields & TRANSACTION_ACCELERATION) &&
+                   (transaction.acceleration < 100 || transaction.acceleration > 100000)) {
+            sendNotification("error", "Transaction rejected: acceleration must be 100-100000 steps/s²");
+            acknowledge(CommandResult::REJECTED);
+        } else if ((transaction.fields & TRANSACTION_VARIATION_STRENGTH) &&
+                   (transaction.variationStrength < 0.0f || transaction.variationStrength > 1.0f)) {
+            sendNotification("error", "Transaction rejected: speed variation strength must be 0.0-1.0");
+            acknowledge(CommandResult::REJECTED);
+        } else {
+            StepperCommandData cmd(transaction);
+            cmd.axis = axis;
+            sendStepperCommand(cmd);
+            dbg_printf("Transaction queued (fields 0x%02x)\n", transaction.fields);
+        }
+    }
     else if (strcmp(type, "enable_speed_variation") == 0) {
         StepperCommandData cmd(StepperCommand::ENABLE_SPEED_VARIATION);
-        systemCommand.sendCommand(cmd);
+        cmd.axis = axis;
+        sendStepperCommand(cmd);
         dbg_printf("Enable speed variation command queued\n");
     }
     else if (strcmp(type, "disable_speed_variation") == 0) {
         StepperCommandData cmd(StepperCommand::DISABLE_SPEED_VARIATION);
-        systemCommand.sendCommand(cmd);
+        cmd.axis = axis;
+        sendStepperCommand(cmd);
         dbg_printf("Disable speed variation command queued\n");
     }
+    else if (strcmp(type, "speed_variation_auto_tune") == 0) {
+        bool enable = doc["value"];
+        StepperCommandData cmd(StepperCommand::SET_SPEED_VARIATION_AUTO_TUNE, enable);
+        cmd.axis = axis;
+        sendStepperCommand(cmd);
+        dbg_printf("Speed variation auto-tune %s command queued\n", enable ? "enable" : "disable");
+    }
     else if (strcmp(type, "stallguard_threshold") == 0) {
         int threshold = doc["value"];
         if (threshold >= 0 && threshold <= 255) {
             StepperCommandData cmd(StepperCommand::SET_STALLGUARD_THRESHOLD, threshold);
-            systemCommand.sendCommand(cmd);
+            cmd.axis = axis;
+            sendStepperCommand(cmd);
             dbg_printf("StallGuard threshold command queued: %d\n", threshold);
         } else {
             dbg_println("Invalid StallGuard threshold");
             sendNotification("error", "StallGuard threshold must be 0-255");
+            acknowledge(CommandResult::REJECTED);
+        }
+    }
+    else if (strcmp(type, "stallguard_calibrate") == 0) {
+        int revolutions = doc["value"];
+        if (revolutions >= 1 && revolutions <= 20) {
+            StepperCommandData cmd(StepperCommand::CALIBRATE_STALLGUARD, revolutions);
+            cmd.axis = axis;
+            sendStepperCommand(cmd);
+            dbg_printf("StallGuard calibration command queued: %d revolutions\n", revolutions);
+        } else {
+            dbg_println("Invalid calibration revolutions");
+            sendNotification("error", "Calibration revolutions must be 1-20");
+            acknowledge(CommandResult::REJECTED);
+        }
+    }
+    else if (strcmp(type, "stallguard_calibration_margin") == 0) {
+        int margin = doc["value"];
+        if (margin >= 0 && margin <= 90) {
+            StepperCommandData cmd(StepperCommand::SET_STALLGUARD_CALIBRATION_MARGIN, margin);
+            cmd.axis = axis;
+            sendStepperCommand(cmd);
+            dbg_printf("StallGuard calibration margin command queued: %d%%\n", margin);
+        } else {
+            dbg_println("Invalid calibration margin");
+            sendNotification("error", "Calibration margin must be 0-90%");
+            acknowledge(CommandResult::REJECTED);
         }
     }
     else if (strcmp(type, "pd_voltage") == 0) {
@@ -270,22 +431,24 @@ void BLEManager::handleCommand(const std::string& command) {
         int voltage = doc["value"];
         if (voltage >= 5 && voltage <= 20) {
             PowerDeliveryCommandData cmd(PowerDeliveryCommand::SET_TARGET_VOLTAGE, voltage);
-            systemCommand.sendPowerDeliveryCommand(cmd);
+            sendPowerDeliveryCommand(cmd);
             
             dbg_printf("Power delivery voltage set to %dV and negotiation started\n", voltage);
         } else {
             dbg_printf("Invalid voltage value: %d (must be 5-20V)\n", voltage);
+            acknowledge(CommandResult::REJECTED);
         }
     }
     else if (strcmp(type, "pd_auto_negotiate") == 0) {
         // Start auto-negotiation for highest available voltage
         PowerDeliveryCommandData cmd(PowerDeliveryCommand::AUTO_NEGOTIATE_HIGHEST);
-        systemCommand.sendPowerDeliveryCommand(cmd);
+        sendPowerDeliveryCommand(cmd);
         
         dbg_printf("Power delivery auto-negotiation started\n");
     }
     else {
         dbg_printf("Unknown command type: %s\n", type);
+        acknowledge(CommandResult::REJECTED);
     }
 }
 
@@ -311,6 +474,8 @@ void BLEManager::update() {
     
     // Process status updates from StepperController (simple batching)
     processStatusUpdates();
+    processStatusBlocks();
+    processCommandAcks();
     
     // Handle connection state changes
     if (!deviceConnected && oldDeviceConnected) {
@@ -330,6 +495,28 @@ void BLEManager::update() {
 
 // Queue methods removed - using SystemCommand singleton directly
 
+bool BLEManager::sendStepperCommand(StepperCommandData cmd) {
+    cmd.trace = commandTrace; // SystemCommand adds the trace ID and queue time
+    if (!systemCommand.sendCommand(cmd)) {
+        acknowledge(CommandResult::QUEUE_FULL);
+        return false;
+    }
+    return true; // Acked by the stepper task once applied
+}
+
+bool BLEManager::sendPowerDeliveryCommand(PowerDeliveryCommandData cmd) {
+    cmd.seq = commandTrace.seq;
+    if (!systemCommand.sendPowerDeliveryCommand(cmd)) {
+        acknowledge(CommandResult::QUEUE_FULL);
+        return false;
+    }
+    return true; // Acked by the power delivery task
+}
+
+void BLEManager::acknowledge(CommandResult result) {
+    systemStatus.publishCommandAck(commandTrace.seq, 0, result);
+}
+
 void BLEManager::processNotifications() {
     NotificationData notification;
     // Process all available notifications (warnings and errors only)
@@ -361,36 +548,208 @@ void BLEManager::processNotifications() {
 void BLEManager::processStatusUpdates() {
     if (!commandCharacteristic || !deviceConnected) return;
     
+    JsonDocument statusDoc;
+    statusDoc["type"] = "status_update";
+    bool hasUpdates = false;
+    
+    // Newest telemetry snapshot of every axis - no queue traffic, intermediate values are skipped
+    StepperTelemetry telemetry;
+    for (uint8_t axis = 0; axis < STEPPER_MAX_AXES; axis++) {
+        if (systemStatus.getTelemetry(axis, telemetry)) {
+            addTelemetryToJson(getAxisJson(statusDoc, axis), telemetry);
+            hasUpdates = true;
+        }
+    }
+    
+    // Process all status updates in the queue
     StatusUpdateData statusUpdate;
+    while (systemStatus.getStatusUpdate(statusUpdate)) {
+        addStatusToJson(getAxisJson(statusDoc, statusUpdate.axis), statusUpdate);
+        hasUpdates = true;
+        
+        // Check if we're approaching size limit
+        String tempString;
+        size_t tempSize = serializeJson(statusDoc, tempString);
+        if (tempSize >= MAX_BLE_PACKET_SIZE) {
+            dbg_printf("Warning: Status update approaching size limit (%d bytes), sending now\n", tempSize);
+            break;
+        }
+    }
+    
+    // Send the batched updates
+    if (hasUpdates) {
+        sendStatusUpdate(statusDoc);
+    }
+}
+
+void BLEManager::processStatusBlocks() {
+    if (!commandCharacteristic || !deviceConnected) return;
     
-    // Check if there are any status updates available
-    if (systemStatus.getStatusUpdate(statusUpdate)) {
-        // Create JSON document and add the first update
+    StatusBlockData block;
+    
+    // Blocks are already compact arrays - send each one as its own status update
+    while (systemStatus.getStatusBlock(block)) {
         JsonDocument statusDoc;
         statusDoc["type"] = "status_update";
+        addStatusBlockToJson(getAxisJson(statusDoc, block.axis), block);
+        sendStatusUpdate(statusDoc);
+    }
+}
+
+void BLEManager::processCommandAcks() {
+    if (!commandCharacteristic || !deviceConnected) return;
+    
+    // Compact: {"type":"ack","acks":[[seq, result, value], [seq, result], ...]} (result = CommandResult)
+    JsonDocument ackDoc;
+    ackDoc["type"] = "ack";
+    JsonArray acks = ackDoc["acks"].to<JsonArray>();
+    
+    CommandAckData ack;
+    while (systemStatus.getCommandAck(ack)) {
+        JsonArray entry = acks.add<JsonArray>();
+        entry.add(ack.seq);
+        entry.add(static_cast<uint8_t>(ack.result));
+        if (ack.hasValue) {
+            entry.add(ack.value);
+        }
         
-        // Add the first status update
-        addStatusToJson(statusDoc, statusUpdate);
-        
-        // Process all remaining status updates in the queue
-        while (systemStatus.getStatusUpdate(statusUpdate)) {
-            addStatusToJson(statusDoc, statusUpdate);
-            
-            // Check if we're approaching size limit
-            String tempString;
-            size_t tempSize = serializeJson(statusDoc, tempString);
-            if (tempSize >= MAX_BLE_PACKET_SIZE) {
-                dbg_printf("Warning: Status update approaching size limit (%d bytes), sending now\n", tempSize);
-                break;
+        if (measureJson(ackDoc) >= MAX_BLE_PACKET_SIZE - 32) {
+            break; // The rest goes out with the next update
+        }
+    }
+    
+    if (acks.size() > 0) {
+        sendStatusUpdate(ackDoc);
+    }
+}
+
+JsonObject BLEManager::getAxisJson(JsonDocument& doc, uint8_t axis) {
+    // The main spit keeps the flat keys; further axes are nested as "axis1".."axis3" with the same keys
+    static const char* const axisKeys[STEPPER_MAX_AXES] = {nullptr, "axis1", "axis2", "axis3"};
+    if (axis == 0 || axis >= STEPPER_MAX_AXES) {
+        return doc.as<JsonObject>();
+    }
+    
+    JsonObject axisObject = doc[axisKeys[axis]];
+    if (axisObject.isNull()) {
+        axisObject = doc[axisKeys[axis]].to<JsonObject>();
+    }
+    return axisObject;
+}
+
+void BLEManager::addTelemetryToJson(JsonObject doc, const StepperTelemetry& telemetry) {
+    doc["currentSpeed"] = telemetry.currentSpeed;  // Actual speed for display
+    doc["totalRevolutions"] = telemetry.totalRevolutions;
+    if (telemetry.runtimeValid) {
+        doc["runtime"] = telemetry.runtime;
+    }
+    if (telemetry.stallGuardResult >= 0) {
+        doc["stallguardResult"] = telemetry.stallGuardResult;
+    }
+    doc["stepRate"] = telemetry.stepRate;
+}
+
+void BLEManager::addStatusBlockToJson(JsonObject doc, const StatusBlockData& block) {
+    JsonArray values;
+    switch (block.type) {
+        case StatusBlockType::LOAD_MAP:
+            values = doc["loadMap"].to<JsonArray>();
+            doc["loadMapSamples"] = block.info;
+            break;
+        case StatusBlockType::STALLGUARD_CALIBRATION: {
+            JsonObject calibration = doc["stallguardCalibration"].to<JsonObject>();
+            static const char* const fields[] = {"min", "mean", "p5", "p50", "p95", "max", "threshold", "margin"};
+            const uint16_t fieldCount = sizeof(fields) / sizeof(fields[0]);
+            calibration["samples"] = block.info;
+            for (uint16_t i = 0; i < fieldCount && i < block.count; i++) {
+                calibration[fields[i]] = block.values[i];
+            }
+            JsonArray histogram = calibration["histogram"].to<JsonArray>();
+            for (uint16_t i = fieldCount; i < block.count; i++) {
+                histogram.add(block.values[i]);
             }
+            return;
         }
-        
-        // Send the batched updates
-        sendStatusUpdate(statusDoc);
+        case StatusBlockType::MOTION_TIMING: {
+            JsonObject timing = doc["motionTiming"].to<JsonObject>();
+            static const char* const fields[] = {"isrPerSecond", "isrCyclesPerSecond", "isrMaxCycles", "cpuMHz",
+                                                 "loopWakes", "wakeJitterMeanUs", "wakeJitterMaxUs", "loopBusyMaxUs",
+                                                 "commands", "commandLatencyMeanUs", "commandLatencyMaxUs"};
+            const uint16_t fieldCount = sizeof(fields) / sizeof(fields[0]);
+            timing["windowMs"] = block.info;
+            for (uint16_t i = 0; i < fieldCount && i < block.count; i++) {
+                timing[fields[i]] = block.values[i];
+            }
+            return;
+        }
+        case StatusBlockType::LATENCY_HISTOGRAM: {
+            JsonObject histogram = doc["latencyHistogram"].to<JsonObject>();
+            static const char* const kinds[] = {"lateness", "execution", "queueWait"};
+            static const char* const fields[] = {"count", "minUs", "meanUs", "p50Us", "p90Us", "p99Us", "p999Us", "maxUs"};
+            const uint16_t fieldCount = sizeof(fields) / sizeof(fields[0]);
+            histogram["job"] = block.label ? block.label : "";
+            histogram["kind"] = block.info < sizeof(kinds) / sizeof(kinds[0]) ? kinds[block.info] : "unknown";
+            for (uint16_t i = 0; i < fieldCount && i < block.count; i++) {
+                histogram[fields[i]] = block.values[i];
+            }
+            // Flat (bucket lower bound in us, count) pairs
+            JsonArray buckets = histogram["buckets"].to<JsonArray>();
+            for (uint16_t i = fieldCount; i < block.count; i++) {
+                buckets.add(block.values[i]);
+            }
+            return;
+        }
+        case StatusBlockType::COMMAND_TRACE: {
+            JsonObject trace = doc["commandTrace"].to<JsonObject>();
+            static const char* const fields[] = {"command", "parseUs", "handoffUs", "queueUs", "applyUs", "totalUs"};
+            const uint16_t fieldCount = sizeof(fields) / sizeof(fields[0]);
+            trace["id"] = block.info;
+            for (uint16_t i = 0; i < fieldCount && i < block.count; i++) {
+                if (block.values[i] >= 0) {
+                    trace[fields[i]] = block.values[i]; // Stages a command did not pass are left out
+                }
+            }
+            return;
+        }
+        case StatusBlockType::TRANSACTION: {
+            // Same keys as the single updates, so clients update their controls in one pass
+            if (block.count < 9) return;
+            JsonObject transaction = doc["transaction"].to<JsonObject>();
+            transaction["id"] = block.info;
+            transaction["applied"] = block.values[0] != 0;
+            doc["speed"] = block.values[1] / 1000.0f;
+            doc["acceleration"] = block.values[2];
+            doc["speedVariationStrength"] = block.values[3] / 1000.0f;
+            doc["speedVariationPhase"] = block.values[4] / 1000.0f;
+            doc["speedVariationEnabled"] = block.values[5] != 0;
+            doc["speedVariationAutoTune"] = block.values[6] != 0;
+            doc["enabled"] = block.values[7] != 0;
+            doc["direction"] = block.values[8] ? "cw" : "ccw";
+            return;
+        }
+        case StatusBlockType::COMMAND_LATENCY: {
+            JsonObject latency = doc["commandLatency"].to<JsonObject>();
+            static const char* const stages[] = {"parse", "handoff", "queue", "apply", "total"};
+            static const char* const fields[] = {"count", "p50Us", "p99Us", "p999Us", "maxUs"};
+            const uint16_t stageCount = sizeof(stages) / sizeof(stages[0]);
+            const uint16_t fieldCount = sizeof(fields) / sizeof(fields[0]);
+            latency["commands"] = block.info;
+            for (uint16_t stage = 0; stage < stageCount && (stage + 1) * fieldCount <= block.count; stage++) {
+                JsonObject stageJson = latency[stages[stage]].to<JsonObject>();
+                for (uint16_t i = 0; i < fieldCount; i++) {
+                    stageJson[fields[i]] = block.values[stage * fieldCount + i];
+                }
+            }
+            return;
+        }
+    }
+    
+    for (uint16_t i = 0; i < block.count; i++) {
+        values.add(block.values[i]);
     }
 }
 
-void BLEManager::addStatusToJson(JsonDocument& doc, const StatusUpdateData& statusUpdate) {
+void BLEManager::addStatusToJson(JsonObject doc, const StatusUpdateData& statusUpdate) {
     switch (statusUpdate.type) {
         case StatusUpdateType::SPEED_UPDATE:
             doc["currentSpeed"] = statusUpdate.floatValue;  // Actual speed for display
@@ -410,6 +769,12 @@ void BLEManager::addStatusToJson(JsonDocument& doc, const StatusUpdateData& stat
         case StatusUpdateType::ACCELERATION_CHANGED:
             doc["acceleration"] = statusUpdate.uint32Value;
             break;
+        case StatusUpdateType::JERK_LIMIT_CHANGED:
+            doc["jerkLimit"] = statusUpdate.uint32Value;
+            break;
+        case StatusUpdateType::MICROSTEPS_CHANGED:
+            doc["microsteps"] = statusUpdate.intValue;
+            break;
         case StatusUpdateType::SPEED_VARIATION_ENABLED_CHANGED:
             doc["speedVariationEnabled"] = statusUpdate.boolValue;
             break;
@@ -419,9 +784,15 @@ void BLEManager::addStatusToJson(JsonDocument& doc, const StatusUpdateData& stat
         case StatusUpdateType::SPEED_VARIATION_PHASE_CHANGED:
             doc["speedVariationPhase"] = statusUpdate.floatValue;
             break;
+        case StatusUpdateType::SPEED_VARIATION_AUTO_TUNE_CHANGED:
+            doc["speedVariationAutoTune"] = statusUpdate.boolValue;
+            break;
         case StatusUpdateType::TOTAL_REVOLUTIONS_UPDATE:
             doc["totalRevolutions"] = statusUpdate.floatValue;
             break;
+        case StatusUpdateType::LIFETIME_REVOLUTIONS_UPDATE:
+            doc["lifetimeRevolutions"] = statusUpdate.floatValue;
+            break;
         case StatusUpdateType::RUNTIME_UPDATE:
             doc["runtime"] = statusUpdate.ulongValue;
             break;
@@ -437,12 +808,39 @@ void BLEManager::addStatusToJson(JsonDocument& doc, const StatusUpdateData& stat
         case StatusUpdateType::TMC2209_TEMPERATURE_UPDATE:
             doc["tmc2209Temperature"] = statusUpdate.intValue;
             break;
+        case StatusUpdateType::SPEED_SCHEDULE_WAKEUPS_SAVED:
+            doc["speedScheduleWakeupsSaved"] = statusUpdate.intValue;
+            break;
+        case StatusUpdateType::MOTION_LOOP_MAX_LATENCY_US:
+            doc["motionLoopMaxLatencyUs"] = statusUpdate.uint32Value;
+            break;
+        case StatusUpdateType::SETTINGS_FLASH_WRITES:
+            doc["settingsFlashWrites"] = statusUpdate.uint32Value;
+            break;
+        case StatusUpdateType::SETTINGS_SAVE_REQUESTS:
+            doc["settingsSaveRequests"] = statusUpdate.uint32Value;
+            break;
+        case StatusUpdateType::COMMANDS_COALESCED:
+            doc["commandsCoalesced"] = statusUpdate.uint32Value;
+            break;
+        case StatusUpdateType::COMMANDS_DROPPED:
+            doc["commandsDropped"] = statusUpdate.uint32Value;
+            break;
         case StatusUpdateType::STALLGUARD_THRESHOLD_CHANGED:
             doc["stallguardThreshold"] = statusUpdate.intValue;
             break;
         case StatusUpdateType::STALLGUARD_RESULT_UPDATE:
             doc["stallguardResult"] = statusUpdate.intValue;
             break;
+        case StatusUpdateType::LOAD_RIPPLE_UPDATE:
+            doc["loadRipple"] = statusUpdate.floatValue;
+            break;
+        case StatusUpdateType::STALLGUARD_CALIBRATION_ACTIVE:
+            doc["stallguardCalibrating"] = statusUpdate.boolValue;
+            break;
+        case StatusUpdateType::STALLGUARD_CALIBRATION_MARGIN_CHANGED:
+            doc["stallguardCalibrationMargin"] = statusUpdate.intValue;
+            break;
         case StatusUpdateType::PD_NEGOTIATION_STATUS:
             doc["pdNegotiationStatus"] = statusUpdate.intValue;
             break;
@@ -525,6 +923,7 @@ void BLEManager::sendAllCurrentStatus() {
     
     // Use the thread-safe SystemCommand to request all status information
     StepperCommandData stepperCmd(StepperCommand::REQUEST_ALL_STATUS);
+    stepperCmd.axis = STEPPER_AXIS_ALL;
     systemCommand.sendCommand(stepperCmd);
     
     // Also request power delivery status
@@ -47,6 +47,9 @@ private:
     // Cached reference to SystemCommand singleton  
     SystemCommand& systemCommand;
     
+    // Receive and parse time of the BLE write being handled (carried by its stepper commands)
+    CommandTrace commandTrace;
+    
     // Status update batching configuration
     static const size_t MAX_BLE_PACKET_SIZE = 500;            // Conservative BLE MTU size
 
@@ -59,13 +62,21 @@ private:
     
     void processNotifications(); // Process notifications from StepperController (warnings and errors only)
     void processStatusUpdates(); // Process status updates from StepperController
+    void processStatusBlocks();  // Send array status blocks (one BLE message each)
+    void processCommandAcks();   // Send pending command acks batched as one "ack" message
     void update();
     bool isConnected() const { return deviceConnected; }
-    void addStatusToJson(JsonDocument& doc, const StatusUpdateData& statusUpdate); // Helper to add status to JSON
+    JsonObject getAxisJson(JsonDocument& doc, uint8_t axis);                     // Object holding the keys of one axis
+    void addStatusToJson(JsonObject doc, const StatusUpdateData& statusUpdate);   // Helper to add status to JSON
+    void addStatusBlockToJson(JsonObject doc, const StatusBlockData& block);      // Helper to add a status block to JSON
+    void addTelemetryToJson(JsonObject doc, const StepperTelemetry& telemetry);   // Helper to add an axis telemetry snapshot
     void sendStatusUpdate(JsonDocument& statusDoc); // Send a status update JSON
     void sendNotification(const String& level, const String& message = "");
     void sendAllCurrentStatus(); // Send all current status information to newly connected client
-    void handleCommand(const std::string& command);
+    void handleCommand(const std::string& command, uint32_t receivedUs);
+    bool sendStepperCommand(StepperCommandData cmd); // Queue a command of the current BLE write with its trace
+    bool sendPowerDeliveryCommand(PowerDeliveryCommandData cmd); // Same for power delivery commands
+    void acknowledge(CommandResult result); // Ack the current BLE write right away (invalid or not queued)
 
     friend class ServerCallbacks;
     friend class CommandCharacteristicCallbacks;
@@ -0,0 +1,36 @@
+#include "CommandTracer.h"
+
+CommandTracer::CommandTracer() : commandCount(0) {
+}
+
+CommandTraceRecord CommandTracer::record(const StepperCommandData& cmd, uint32_t dequeuedUs, uint32_t appliedUs) {
+    const CommandTrace& trace = cmd.trace;
+    const bool fromBle = trace.receivedUs != 0 && trace.parsedUs != 0;
+
+    CommandTraceRecord result;
+    result.id = trace.id;
+    result.command = cmd.command;
+    result.stageUs[static_cast<uint8_t>(CommandStage::PARSE)] =
+        fromBle ? (int32_t)(trace.parsedUs - trace.receivedUs) : COMMAND_STAGE_NOT_PASSED;
+    result.stageUs[static_cast<uint8_t>(CommandStage::HANDOFF)] =
+        fromBle ? (int32_t)(trace.queuedUs - trace.parsedUs) : COMMAND_STAGE_NOT_PASSED;
+    result.stageUs[static_cast<uint8_t>(CommandStage::QUEUE)] = (int32_t)(dequeuedUs - trace.queuedUs);
+    result.stageUs[static_cast<uint8_t>(CommandStage::APPLY)] = (int32_t)(appliedUs - dequeuedUs);
+    result.stageUs[static_cast<uint8_t>(CommandStage::TOTAL)] =
+        (int32_t)(appliedUs - (fromBle ? trace.receivedUs : trace.queuedUs));
+
+    for (uint8_t i = 0; i < COMMAND_STAGE_COUNT; i++) {
+        if (result.stageUs[i] >= 0) {
+            stages[i].record(result.stageUs[i]);
+        }
+    }
+    commandCount++;
+    return result;
+}
+
+void CommandTracer::reset() {
+    for (LatencyHistogram& stage : stages) {
+        stage.reset();
+    }
+    commandCount = 0;
+}
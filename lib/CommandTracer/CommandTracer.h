@@ -0,0 +1,59 @@
+#ifndef COMMAND_TRACER_H
+#define COMMAND_TRACER_H
+
+/**
+ * @file CommandTracer.h
+ * @brief Stage latencies of stepper commands from the BLE write to the applied change
+ *
+ * Every command carries a CommandTrace (ID and the timestamps of the hops before the queue).
+ * When the motion task has applied it, the tracer turns the timestamps into stage durations
+ * and records each stage in a LatencyHistogram:
+ *
+ *   parse    BLE write received -> JSON parsed (BLEManager::handleCommand)
+ *   handoff  JSON parsed -> queued (validation, SystemCommand::sendCommand)
+ *   queue    queued -> taken by the motion task
+ *   apply    taken -> StepperController::processCommand() returned (e.g. applyStop())
+ *   total    first stamped hop -> applied
+ *
+ * Commands that do not come from BLE have no parse and handoff stage. Used by the motion task only.
+ */
+
+#include <Arduino.h>
+#include "CommandTypes.h"
+#include "LatencyHistogram.h"
+
+enum class CommandStage {
+    PARSE,
+    HANDOFF,
+    QUEUE,
+    APPLY,
+    TOTAL
+};
+
+#define COMMAND_STAGE_COUNT 5
+#define COMMAND_STAGE_NOT_PASSED -1
+
+// One traced command: stage durations in us, COMMAND_STAGE_NOT_PASSED for stages it skipped
+struct CommandTraceRecord {
+    uint32_t id;
+    StepperCommand command;
+    int32_t stageUs[COMMAND_STAGE_COUNT];
+};
+
+class CommandTracer {
+private:
+    LatencyHistogram stages[COMMAND_STAGE_COUNT];
+    uint32_t commandCount; // Commands traced since the last reset
+
+public:
+    CommandTracer();
+
+    // Record a command taken from the queue at dequeuedUs and applied at appliedUs
+    CommandTraceRecord record(const StepperCommandData& cmd, uint32_t dequeuedUs, uint32_t appliedUs);
+
+    const LatencyHistogram& getStage(CommandStage stage) const { return stages[static_cast<uint8_t>(stage)]; }
+    uint32_t getCommandCount() const { return commandCount; }
+    void reset();
+};
+
+#endif // COMMAND_TRACER_H
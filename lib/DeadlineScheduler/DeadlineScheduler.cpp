@@ -0,0 +1,150 @@
+#include "DeadlineScheduler.h"
+
+DeadlineScheduler::DeadlineScheduler() : jobs(), jobCount(0), histogramsEnabled(false), earliestDue(0), hasDeadline(false) {
+}
+
+void DeadlineScheduler::noteDeadline(uint32_t due) {
+    if (!hasDeadline || isAtOrAfter(earliestDue, due)) {
+        earliestDue = due;
+        hasDeadline = true;
+    }
+}
+
+int8_t DeadlineScheduler::addJob(const char* name, uint32_t periodMs, JobCallback callback, void* context, uint32_t firstDelayMs) {
+    if (jobCount >= DEADLINE_SCHEDULER_MAX_JOBS || callback == nullptr) {
+        dbg_printf("ERROR: Cannot add scheduler job '%s'\n", name);
+        return DEADLINE_SCHEDULER_INVALID_JOB;
+    }
+
+    Job& job = jobs[jobCount];
+    job.name = name;
+    job.periodMs = periodMs;
+    job.nextDue = millis() + firstDelayMs;
+    job.callback = callback;
+    job.context = context;
+    job.rescheduled = false;
+    job.parked = false;
+    job.stats = DeadlineJobStats();
+    job.histograms = histogramsEnabled ? new DeadlineJobHistograms() : nullptr;
+    noteDeadline(job.nextDue);
+
+    return static_cast<int8_t>(jobCount++);
+}
+
+void DeadlineScheduler::rescheduleIn(int8_t jobId, uint32_t delayMs) {
+    if (jobId < 0 || jobId >= jobCount) return;
+
+    jobs[jobId].parked = delayMs == DEADLINE_SCHEDULER_PARKED;
+    if (!jobs[jobId].parked) {
+        jobs[jobId].nextDue = millis() + delayMs;
+        noteDeadline(jobs[jobId].nextDue);
+    }
+    jobs[jobId].rescheduled = true;
+}
+
+uint32_t DeadlineScheduler::msUntilNextDue() const {
+    if (!hasDeadline) return UINT32_MAX;
+
+    const uint32_t now = millis();
+    if (isAtOrAfter(now, earliestDue)) {
+        return 0; // Already due
+    }
+    return earliestDue - now;
+}
+
+TickType_t DeadlineScheduler::ticksUntilNextDue() const {
+    const uint32_t ms = msUntilNextDue();
+    if (ms == UINT32_MAX) return portMAX_DELAY;
+
+    // Round up so a wait never ends just before the deadline
+    return (ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+}
+
+void DeadlineScheduler::runDueJobs() {
+    uint32_t now = millis();
+    if (!hasDeadline || !isAtOrAfter(now, earliestDue)) return;
+
+    for (uint8_t i = 0; i < jobCount; i++) {
+        Job& job = jobs[i];
+        if (job.parked || !isAtOrAfter(now, job.nextDue)) continue;
+
+        const uint32_t lateness = now - job.nextDue;
+        job.stats.runCount++;
+        job.stats.lastLatenessMs = lateness;
+        job.stats.maxLatenessMs = max(job.stats.maxLatenessMs, lateness);
+
+        job.rescheduled = false;
+        if (job.histograms) {
+            // millis() and micros() count the same clock, so deadline * 1000 wraps in step with micros()
+            const uint32_t startUs = micros();
+            job.histograms->lateness.record(startUs - job.nextDue * 1000);
+            job.callback(job.context);
+            job.histograms->execution.record(micros() - startUs);
+        } else {
+            job.callback(job.context);
+        }
+        const uint32_t started = now;
+        now = millis(); // The clock only moves while a callback runs
+
+        if (job.rescheduled) continue; // Callback chose its own next deadline
+
+        if (lateness >= job.periodMs) {
+            // Missed at least one whole period - resynchronize instead of firing a burst of catch-up runs
+            job.stats.overrunCount++;
+            job.nextDue = started + job.periodMs;
+        } else {
+            // Stay phase-locked to the original deadline grid so lateness does not accumulate
+            job.nextDue += job.periodMs;
+        }
+    }
+
+    hasDeadline = false;
+    for (uint8_t i = 0; i < jobCount; i++) {
+        if (!jobs[i].parked) {
+            noteDeadline(jobs[i].nextDue);
+        }
+    }
+}
+
+const char* DeadlineScheduler::getJobName(int8_t jobId) const {
+    if (jobId < 0 || jobId >= jobCount) return "";
+    return jobs[jobId].name;
+}
+
+const DeadlineJobStats& DeadlineScheduler::getStats(int8_t jobId) const {
+    static const DeadlineJobStats emptyStats;
+    if (jobId < 0 || jobId >= jobCount) return emptyStats;
+    return jobs[jobId].stats;
+}
+
+const DeadlineJobHistograms* DeadlineScheduler::getHistograms(int8_t jobId) const {
+    if (jobId < 0 || jobId >= jobCount) return nullptr;
+    return jobs[jobId].histograms;
+}
+
+void DeadlineScheduler::enableHistograms() {
+    histogramsEnabled = true;
+    for (uint8_t i = 0; i < jobCount; i++) {
+        if (jobs[i].histograms == nullptr) {
+            jobs[i].histograms = new DeadlineJobHistograms();
+        }
+    }
+}
+
+void DeadlineScheduler::resetStats() {
+    for (uint8_t i = 0; i < jobCount; i++) {
+        jobs[i].stats = DeadlineJobStats();
+        if (jobs[i].histograms) {
+            jobs[i].histograms->lateness.reset();
+            jobs[i].histograms->execution.reset();
+        }
+    }
+}
+
+void DeadlineScheduler::logStats() const {
+    for (uint8_t i = 0; i < jobCount; i++) {
+        dbg_printf("Job '%s': %u runs, %u overruns, lateness last %u ms / max %u ms\n",
+                   jobs[i].name, jobs[i].stats.runCount, jobs[i].stats.overrunCount,
+                   jobs[i].stats.lastLatenessMs, jobs[i].stats.maxLatenessMs);
+    }
+}
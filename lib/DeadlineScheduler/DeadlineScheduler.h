@@ -0,0 +1,104 @@
+#ifndef DEADLINE_SCHEDULER_H
+#define DEADLINE_SCHEDULER_H
+
+/**
+ * @file DeadlineScheduler.h
+ * @brief Small wrap-safe deadline scheduler for periodic jobs inside a task loop
+ *
+ * Tasks register their periodic jobs once and then block on their command queue
+ * with ticksUntilNextDue() as timeout, so they only wake when a command arrives
+ * or a job is actually due. All deadline comparisons use signed differences of
+ * millis() values and therefore survive the 49-day millis() wrap.
+ *
+ * With enableHistograms() every job also records the distribution of its start lateness
+ * and execution time in microseconds (two LatencyHistograms per job, allocated once).
+ */
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "LatencyHistogram.h"
+#include "dbg_print.h"
+
+#define DEADLINE_SCHEDULER_MAX_JOBS 12
+#define DEADLINE_SCHEDULER_INVALID_JOB -1
+#define DEADLINE_SCHEDULER_PARKED UINT32_MAX // rescheduleIn() delay: not due until rescheduled again
+
+// Per-job timing statistics
+struct DeadlineJobStats {
+    uint32_t runCount;        // Number of times the job ran
+    uint32_t overrunCount;    // Runs that started a full period or more late (periods were skipped)
+    uint32_t lastLatenessMs;  // Start time minus deadline of the most recent run
+    uint32_t maxLatenessMs;   // Worst lateness (jitter) observed since the last reset
+
+    DeadlineJobStats() : runCount(0), overrunCount(0), lastLatenessMs(0), maxLatenessMs(0) {}
+};
+
+// Per-job latency distributions (microseconds)
+struct DeadlineJobHistograms {
+    LatencyHistogram lateness;   // Start time minus deadline
+    LatencyHistogram execution;  // Callback run time
+};
+
+class DeadlineScheduler {
+public:
+    typedef void (*JobCallback)(void* context);
+
+private:
+    struct Job {
+        const char* name;
+        uint32_t periodMs;
+        uint32_t nextDue;     // millis() value when the job is due next
+        JobCallback callback;
+        void* context;
+        bool rescheduled;     // Set when the callback picked its own next deadline
+        bool parked;          // No deadline - waits for the next rescheduleIn()
+        DeadlineJobStats stats;
+        DeadlineJobHistograms* histograms; // nullptr unless histograms are enabled
+    };
+
+    Job jobs[DEADLINE_SCHEDULER_MAX_JOBS];
+    uint8_t jobCount;
+    bool histogramsEnabled;
+
+    // Earliest deadline of all jobs, so a wakeup with nothing due does not scan them. Exact after
+    // runDueJobs(); a job moved to a later deadline in between only costs one early scan.
+    uint32_t earliestDue;
+    bool hasDeadline; // false while no job has one (none registered or all parked)
+
+    void noteDeadline(uint32_t due);
+
+    // Wrap-safe "a is at or after b"
+    static bool isAtOrAfter(uint32_t a, uint32_t b) {
+        return static_cast<int32_t>(a - b) >= 0;
+    }
+
+public:
+    DeadlineScheduler();
+
+    // Register a periodic job, first due after firstDelayMs. Returns the job id.
+    int8_t addJob(const char* name, uint32_t periodMs, JobCallback callback, void* context, uint32_t firstDelayMs = 0);
+
+    // Move a job's next deadline (DEADLINE_SCHEDULER_PARKED: none, e.g. for a job that only has
+    // work after an event that reschedules it); may be called from inside the job's own callback
+    void rescheduleIn(int8_t jobId, uint32_t delayMs);
+
+    // Time until the earliest job is due (0 if one is already due)
+    uint32_t msUntilNextDue() const;
+    TickType_t ticksUntilNextDue() const;
+
+    // Run every job whose deadline has passed and update its statistics
+    void runDueJobs();
+
+    // Record lateness/execution histograms for every job, registered or still to come (allocates)
+    void enableHistograms();
+
+    // Statistics access
+    uint8_t getJobCount() const { return jobCount; }
+    const char* getJobName(int8_t jobId) const;
+    const DeadlineJobStats& getStats(int8_t jobId) const;
+    const DeadlineJobHistograms* getHistograms(int8_t jobId) const; // nullptr without enableHistograms()
+    void resetStats();            // Statistics and histograms
+    void logStats() const;
+};
+
+#endif // DEADLINE_SCHEDULER_H
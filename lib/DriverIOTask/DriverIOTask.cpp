@@ -0,0 +1,148 @@
+#include "DriverIOTask.h"
+
+DriverIOTask::DriverIOTask()
+    : Task("DriverIO_Task", 3072, 1, 0), // Task name, 3KB stack, priority 1 (below BLE), core 0 (away from the stepper task)
+      serialStream(nullptr), rxPin(-1), txPin(-1) {
+}
+
+void DriverIOTask::begin(HardwareSerial& serial, int16_t rx, int16_t tx) {
+    serialStream = &serial;
+    rxPin = rx;
+    txPin = tx;
+}
+
+void DriverIOTask::attachDriver(uint8_t channel, TMC2209::SerialAddress address) {
+    if (channel >= DRIVER_IO_MAX_DRIVERS) return;
+
+    channels[channel].serialAddress = address;
+    channels[channel].attached = true;
+}
+
+void DriverIOTask::run() {
+    dbg_println("DriverIO Task started");
+
+    if (serialStream == nullptr) {
+        dbg_println("ERROR: DriverIOTask started without UART configuration");
+        return;
+    }
+
+    for (uint8_t i = 0; i < DRIVER_IO_MAX_DRIVERS; i++) {
+        DriverChannel& channel = channels[i];
+        if (!channel.attached) continue;
+
+        channel.driver.setup(*serialStream, DRIVER_IO_BAUD_RATE, channel.serialAddress, rxPin, txPin);
+
+        // Establish communication and write the full register set requested so far
+        channel.registers.markAllDirty();
+        if (channel.registers.probe() && channel.registers.flush()) {
+            dbg_printf("TMC2209 at address %d initialized and communicating successfully\n", channel.serialAddress);
+        } else {
+            dbg_printf("WARNING: TMC2209 at address %d initialization failed or not responding\n", channel.serialAddress);
+        }
+        publishDiagnostics(channel);
+    }
+
+    scheduler.addJob("sg_result", DRIVER_IO_STALLGUARD_INTERVAL, stallGuardJob, this, DRIVER_IO_STALLGUARD_INTERVAL);
+    scheduler.addJob("drv_status", DRIVER_IO_STATUS_INTERVAL, statusJob, this, DRIVER_IO_STATUS_INTERVAL);
+
+    while (true) {
+        // Sleep until register writes or a sample are requested or the next diagnostic read is due
+        if (ulTaskNotifyTake(pdTRUE, scheduler.ticksUntilNextDue()) > 0) {
+            for (DriverChannel& channel : channels) {
+                if (!channel.attached) continue;
+
+                const bool wasCommunicating = channel.registers.isCommunicating();
+                const uint32_t previousMicrostepsUs = channel.registers.getMicrostepsAppliedUs();
+                const int32_t previousVelocity = channel.registers.getAppliedVelocity();
+                channel.registers.flush();
+                // A confirmed resolution or velocity change is waited for by the motion task - hand it over at once
+                if (channel.registers.isCommunicating() != wasCommunicating ||
+                    channel.registers.getMicrostepsAppliedUs() != previousMicrostepsUs ||
+                    channel.registers.getAppliedVelocity() != previousVelocity) {
+                    publishDiagnostics(channel);
+                }
+
+                processSampleRequest(channel);
+            }
+        }
+
+        scheduler.runDueJobs();
+    }
+}
+
+void DriverIOTask::stallGuardJob(void* context) {
+    DriverIOTask* self = static_cast<DriverIOTask*>(context);
+
+    for (DriverChannel& channel : self->channels) {
+        if (!channel.attached || !channel.registers.isCommunicating()) continue;
+
+        // Read StallGuard result from TMC2209 (0-510 per datasheet)
+        channel.registers.readStallGuardResult();
+        self->publishDiagnostics(channel);
+    }
+}
+
+void DriverIOTask::statusJob(void* context) {
+    DriverIOTask* self = static_cast<DriverIOTask*>(context);
+
+    for (DriverChannel& channel : self->channels) {
+        if (!channel.attached) continue;
+
+        // Flush anything still pending, then confirm health with a single IFCNT read.
+        // The full setup/communication probe is only needed when that fails.
+        channel.registers.flush();
+        if (channel.registers.verifyCommunication() || channel.registers.probe()) {
+            channel.registers.readStatus();
+        }
+        self->publishDiagnostics(channel);
+    }
+}
+
+void DriverIOTask::processSampleRequest(DriverChannel& channel) {
+    const uint32_t request = channel.pendingSample.exchange(0);
+    if (!(request & SAMPLE_PENDING) || !channel.registers.isCommunicating()) return;
+
+    channel.diagnostics.sampleStallGuardResult = channel.registers.readStallGuardResult();
+    channel.diagnostics.sampleTag = static_cast<uint8_t>(request);
+    channel.diagnostics.sampleSequence++;
+    publishDiagnostics(channel);
+}
+
+void DriverIOTask::publishDiagnostics(DriverChannel& channel) {
+    DriverDiagnostics& diagnostics = channel.diagnostics;
+    diagnostics.communicating = channel.registers.isCommunicating();
+    diagnostics.stallGuardResult = channel.registers.getStallGuardResult();
+    const TMC2209::Status& status = channel.registers.getStatus();
+    diagnostics.status.over_temperature_warning = status.over_temperature_warning;
+    diagnostics.status.over_temperature_shutdown = status.over_temperature_shutdown;
+    diagnostics.status.over_temperature_120c = status.over_temperature_120c;
+    diagnostics.status.over_temperature_143c = status.over_temperature_143c;
+    diagnostics.status.over_temperature_150c = status.over_temperature_150c;
+    diagnostics.status.over_temperature_157c = status.over_temperature_157c;
+    diagnostics.registerWriteCount = channel.registers.getWriteCount();
+    diagnostics.communicationErrorCount = channel.registers.getCommunicationErrorCount();
+    diagnostics.appliedMicrosteps = channel.registers.getAppliedMicrosteps();
+    diagnostics.microstepsAppliedUs = channel.registers.getMicrostepsAppliedUs();
+    diagnostics.appliedVelocity = channel.registers.getAppliedVelocity();
+    diagnostics.lastUpdateMs = millis();
+
+    channel.snapshot.publish(diagnostics);
+}
+
+void DriverIOTask::requestFlush() {
+    if (taskHandle != NULL) {
+        xTaskNotifyGive(taskHandle);
+    }
+}
+
+void DriverIOTask::requestStallGuardSample(uint8_t channel, uint8_t tag) {
+    channels[channel].pendingSample.store(SAMPLE_PENDING | tag);
+    if (taskHandle != NULL) {
+        xTaskNotifyGive(taskHandle);
+    }
+}
+
+const DriverDiagnostics& DriverIOTask::getDiagnostics(uint8_t channel) {
+    channels[channel].snapshot.update();
+    return channels[channel].snapshot.read();
+}
@@ -0,0 +1,99 @@
+#ifndef DRIVER_IO_TASK_H
+#define DRIVER_IO_TASK_H
+
+/**
+ * @file DriverIOTask.h
+ * @brief Low-priority task that owns all TMC2209 UART traffic
+ *
+ * Register writes requested by the motion task are only recorded in the
+ * TMC2209RegisterCache and flushed here; diagnostics (StallGuard result, driver
+ * status, communication health) are read here on a fixed schedule and handed to
+ * the motion task through a wait-free TripleBuffer. A slow or failing UART can
+ * therefore never delay the stepper control loop.
+ */
+
+#include <Arduino.h>
+#include <atomic>
+#include <TMC2209.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "Task.h"
+#include "DeadlineScheduler.h"
+#include "TMC2209RegisterCache.h"
+#include "TripleBuffer.h"
+#include "IDriverBackend.h"
+#include "dbg_print.h"
+
+// Timing configuration
+#define DRIVER_IO_STALLGUARD_INTERVAL   100     // SG_RESULT read every 100ms
+#define DRIVER_IO_STATUS_INTERVAL       2000    // DRV_STATUS read and communication check every 2s
+#define DRIVER_IO_BAUD_RATE             115200
+#define DRIVER_IO_MAX_DRIVERS           4       // TMC2209 serial addresses 0-3
+
+class DriverIOTask : public Task {
+private:
+    // One TMC2209 on the bus
+    struct DriverChannel {
+        TMC2209 driver;
+        TMC2209RegisterCache registers;
+        TMC2209::SerialAddress serialAddress;
+        bool attached;
+        std::atomic<uint32_t> pendingSample;         // SAMPLE_PENDING | tag, set by the motion task
+        DriverDiagnostics diagnostics;               // Working copy, owned by this task
+        TripleBuffer<DriverDiagnostics> snapshot;    // Handed over to the motion task
+
+        DriverChannel()
+            : registers(driver), serialAddress(TMC2209::SERIAL_ADDRESS_0), attached(false), pendingSample(0) {}
+    };
+
+    DriverChannel channels[DRIVER_IO_MAX_DRIVERS];
+
+    // UART configuration (set by begin())
+    HardwareSerial* serialStream;
+    int16_t rxPin;
+    int16_t txPin;
+
+    DeadlineScheduler scheduler;
+
+    DriverIOTask();
+    ~DriverIOTask() {}
+    DriverIOTask(const DriverIOTask&) = delete;
+    DriverIOTask& operator=(const DriverIOTask&) = delete;
+
+    static const uint32_t SAMPLE_PENDING = 0x100;
+
+    void publishDiagnostics(DriverChannel& channel);
+    void processSampleRequest(DriverChannel& channel);
+
+    // Scheduler job trampolines
+    static void stallGuardJob(void* context);
+    static void statusJob(void* context);
+
+protected:
+    void run() override;
+
+public:
+    // Configure the UART and attach the drivers on it; call before start()
+    void begin(HardwareSerial& serial, int16_t rx, int16_t tx);
+    void attachDriver(uint8_t channel, TMC2209::SerialAddress address);
+
+    // Desired register values - setters are safe to call from the motion task
+    TMC2209RegisterCache& getRegisters(uint8_t channel) { return channels[channel].registers; }
+
+    // Wake the task to flush pending register writes of all drivers now
+    void requestFlush();
+
+    // Read SG_RESULT as soon as possible and report it with the given tag (e.g. an angle bin).
+    // A request that is still pending on that channel is replaced by the newer one.
+    void requestStallGuardSample(uint8_t channel, uint8_t tag);
+
+    // Latest diagnostics snapshot of one driver; never blocks. Single reader per channel (its motion axis) only.
+    const DriverDiagnostics& getDiagnostics(uint8_t channel);
+
+    static DriverIOTask& getInstance() {
+        static DriverIOTask instance;
+        return instance;
+    }
+};
+
+#endif // DRIVER_IO_TASK_H
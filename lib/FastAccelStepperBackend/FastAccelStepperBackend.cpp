@@ -0,0 +1,45 @@
+#include "FastAccelStepperBackend.h"
+
+FastAccelStepperBackend::FastAccelStepperBackend(uint8_t stepPin, uint8_t dirPin, uint8_t enablePin)
+    : stepPin(stepPin), dirPin(dirPin), enablePin(enablePin), stepper(nullptr) {
+}
+
+FastAccelStepperEngine& FastAccelStepperBackend::getEngine() {
+    // One engine generates the step pulses of every axis
+    static FastAccelStepperEngine engine;
+    static bool initialized = false;
+    if (!initialized) {
+        engine.init();
+        initialized = true;
+    }
+    return engine;
+}
+
+bool FastAccelStepperBackend::begin() {
+    pinMode(enablePin, OUTPUT);
+
+    // Connect stepper to pin
+    stepper = getEngine().stepperConnectToPin(stepPin);
+    if (!stepper) {
+        dbg_println("Failed to initialize FastAccelStepper");
+        return false;
+    }
+
+    // Configure FastAccelStepper
+    stepper->setDirectionPin(dirPin);
+    stepper->setEnablePin(enablePin);
+    stepper->setAutoEnable(true);
+
+    // Set delays for enable/disable
+    stepper->setDelayToEnable(50);
+    stepper->setDelayToDisable(1000);
+
+    return true;
+}
+
+void FastAccelStepperBackend::setAutoEnable(bool enabled) {
+    stepper->setAutoEnable(enabled);
+    if (!enabled) {
+        stepper->enableOutputs();
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef FAST_ACCEL_STEPPER_BACKEND_H
+#define FAST_ACCEL_STEPPER_BACKEND_H
+
+/**
+ * @file FastAccelStepperBackend.h
+ * @brief IStepperBackend on FastAccelStepper hardware step generation
+ *
+ * All axes share one FastAccelStepperEngine, initialized on first use.
+ */
+
+#include <Arduino.h>
+#include "FastAccelStepper.h"
+#include "IStepperBackend.h"
+#include "dbg_print.h"
+
+class FastAccelStepperBackend : public IStepperBackend {
+private:
+    const uint8_t stepPin;
+    const uint8_t dirPin;
+    const uint8_t enablePin;
+    FastAccelStepper* stepper;
+
+    static FastAccelStepperEngine& getEngine();
+
+public:
+    FastAccelStepperBackend(uint8_t stepPin, uint8_t dirPin, uint8_t enablePin);
+
+    bool begin() override;
+
+    void setSpeedInHz(uint32_t stepsPerSecond) override { stepper->setSpeedInHz(stepsPerSecond); }
+    void setAcceleration(uint32_t stepsPerSecond2) override { stepper->setAcceleration(stepsPerSecond2); }
+    void applySpeedAcceleration() override { stepper->applySpeedAcceleration(); }
+
+    void runForward() override { stepper->runForward(); }
+    void runBackward() override { stepper->runBackward(); }
+    void stopMove() override { stepper->stopMove(); }
+    void forceStopAndNewPosition(int32_t position) override { stepper->forceStopAndNewPosition(position); }
+    void setAutoEnable(bool enabled) override;
+
+    bool isRunning() override { return stepper->isRunning(); }
+    int32_t getCurrentPosition() override { return stepper->getCurrentPosition(); }
+    int32_t getCurrentSpeedInMilliHz() override { return stepper->getCurrentSpeedInMilliHz(); }
+};
+
+#endif // FAST_ACCEL_STEPPER_BACKEND_H
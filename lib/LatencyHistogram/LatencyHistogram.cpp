@@ -0,0 +1,102 @@
+#include "LatencyHistogram.h"
+
+static const uint16_t SUB_BUCKETS = 1 << LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+static const uint32_t RANGE_LIMIT = (uint32_t)1 << LATENCY_HISTOGRAM_RANGE_BITS;
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    memset(counts, 0, sizeof(counts));
+    totalCount = 0;
+    minValue = UINT32_MAX;
+    maxValue = 0;
+    sum = 0;
+}
+
+uint16_t LatencyHistogram::bucketIndex(uint32_t value) {
+    if (value >= RANGE_LIMIT) {
+        return LATENCY_HISTOGRAM_BUCKETS - 1;
+    }
+    if (value < 2 * SUB_BUCKETS) {
+        return value; // Exact buckets below the first split power of two
+    }
+
+    // Top SUB_BUCKET_BITS + 1 bits of the value select the bucket within its power of two
+    const uint8_t msb = 31 - __builtin_clz(value);
+    const uint8_t shift = msb - LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+    return (shift << LATENCY_HISTOGRAM_SUB_BUCKET_BITS) + (value >> shift);
+}
+
+uint32_t LatencyHistogram::getBucketLowerBound(uint16_t bucket) {
+    if (bucket < 2 * SUB_BUCKETS) {
+        return bucket;
+    }
+    const uint8_t shift = (bucket >> LATENCY_HISTOGRAM_SUB_BUCKET_BITS) - 1;
+    const uint32_t mantissa = bucket - (shift << LATENCY_HISTOGRAM_SUB_BUCKET_BITS);
+    return mantissa << shift;
+}
+
+void LatencyHistogram::record(uint32_t valueUs) {
+    counts[bucketIndex(valueUs)]++;
+    totalCount++;
+    sum += valueUs;
+    if (valueUs < minValue) minValue = valueUs;
+    if (valueUs > maxValue) maxValue = valueUs;
+}
+
+uint32_t LatencyHistogram::valueAtPercentile(float percentile) const {
+    if (totalCount == 0) {
+        return 0;
+    }
+
+    uint32_t rank = (uint32_t)ceilf(percentile / 100.0f * totalCount);
+    if (rank < 1) rank = 1;
+    if (rank > totalCount) rank = totalCount;
+
+    uint32_t seen = 0;
+    for (uint16_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            const uint32_t upper = getBucketLowerBound(i + 1) - 1;
+            return upper < maxValue ? upper : maxValue;
+        }
+    }
+    return maxValue;
+}
+
+uint16_t LatencyHistogram::exportBuckets(int32_t* values, uint16_t maxPairs) const {
+    if (maxPairs == 0) {
+        return 0;
+    }
+
+    // Smallest power-of-two group size whose non-empty groups fit
+    uint8_t mergeShift = 0;
+    while (true) {
+        uint16_t groups = 0;
+        int32_t lastGroup = -1;
+        for (uint16_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+            if (counts[i] > 0 && (int32_t)(i >> mergeShift) != lastGroup) {
+                lastGroup = i >> mergeShift;
+                groups++;
+            }
+        }
+        if (groups <= maxPairs) break;
+        mergeShift++;
+    }
+
+    uint16_t pairs = 0;
+    for (uint16_t group = 0; (group << mergeShift) < LATENCY_HISTOGRAM_BUCKETS; group++) {
+        uint32_t count = 0;
+        for (uint16_t i = group << mergeShift; i < ((group + 1) << mergeShift) && i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+            count += counts[i];
+        }
+        if (count == 0) continue;
+
+        values[2 * pairs] = (int32_t)getBucketLowerBound(group << mergeShift);
+        values[2 * pairs + 1] = (int32_t)count;
+        pairs++;
+    }
+    return pairs;
+}
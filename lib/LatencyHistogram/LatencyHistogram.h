@@ -0,0 +1,54 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+/**
+ * @file LatencyHistogram.h
+ * @brief Fixed-size log-linear (HDR-style) histogram of microsecond latencies
+ *
+ * Values below 2^(LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1) get one bucket each; above that every
+ * power of two is split into 2^LATENCY_HISTOGRAM_SUB_BUCKET_BITS equal buckets, so a bucket is
+ * never wider than 1/4 of its lower bound. Values at or above 2^LATENCY_HISTOGRAM_RANGE_BITS
+ * land in the last bucket; min, max and mean stay exact. The memory is fixed (no allocation),
+ * so a histogram can record for hours of cooking. Not thread-safe: record and read from one task.
+ */
+
+#include <Arduino.h>
+
+#define LATENCY_HISTOGRAM_SUB_BUCKET_BITS 2 // 4 buckets per power of two (<= 25% bucket width)
+#define LATENCY_HISTOGRAM_RANGE_BITS 22     // Resolved range up to 2^22 us (4.2 s)
+#define LATENCY_HISTOGRAM_BUCKETS ((LATENCY_HISTOGRAM_RANGE_BITS - LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1) << LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+
+class LatencyHistogram {
+private:
+    uint32_t counts[LATENCY_HISTOGRAM_BUCKETS];
+    uint32_t totalCount;
+    uint32_t minValue;
+    uint32_t maxValue;
+    uint64_t sum;
+
+    static uint16_t bucketIndex(uint32_t value);
+
+public:
+    LatencyHistogram();
+
+    void reset();
+    void record(uint32_t valueUs);
+
+    uint32_t getCount() const { return totalCount; }
+    uint32_t getMin() const { return totalCount ? minValue : 0; }
+    uint32_t getMax() const { return maxValue; }
+    uint32_t getMean() const { return totalCount ? (uint32_t)(sum / totalCount) : 0; }
+
+    // Highest value of the bucket holding the given percentile (0-100), capped at the maximum
+    uint32_t valueAtPercentile(float percentile) const;
+
+    // Bucket boundaries: bucket i holds [getBucketLowerBound(i), getBucketLowerBound(i + 1))
+    static uint32_t getBucketLowerBound(uint16_t bucket);
+
+    // Non-empty buckets as (lower bound, count) pairs, at most maxPairs. Neighbouring buckets are
+    // merged pairwise until they fit, so a wide distribution loses resolution instead of its tail.
+    // Returns the number of pairs written (2 values each).
+    uint16_t exportBuckets(int32_t* values, uint16_t maxPairs) const;
+};
+
+#endif // LATENCY_HISTOGRAM_H
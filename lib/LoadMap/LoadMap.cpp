@@ -0,0 +1,80 @@
+#include "LoadMap.h"
+
+LoadMap::LoadMap() {
+    reset();
+}
+
+void LoadMap::reset() {
+    memset(averages, 0, sizeof(averages));
+    memset(sampleCounts, 0, sizeof(sampleCounts));
+    totalSamples = 0;
+}
+
+void LoadMap::addSample(uint8_t bin, uint16_t stallGuardResult) {
+    if (bin >= LOAD_MAP_BINS) return;
+
+    const int32_t sample = static_cast<int32_t>(stallGuardResult) << LOAD_MAP_FRACTION_BITS;
+
+    if (sampleCounts[bin] == 0) {
+        // First sample seeds the average instead of dragging it up from zero
+        averages[bin] = static_cast<uint16_t>(sample);
+    } else {
+        const int32_t average = averages[bin];
+        averages[bin] = static_cast<uint16_t>(average + ((sample - average) >> LOAD_MAP_EMA_SHIFT));
+    }
+
+    if (sampleCounts[bin] < UINT8_MAX) {
+        sampleCounts[bin]++;
+    }
+    totalSamples++;
+}
+
+uint16_t LoadMap::getValue(uint8_t bin) const {
+    if (bin >= LOAD_MAP_BINS) return 0;
+    return (averages[bin] + (1 << (LOAD_MAP_FRACTION_BITS - 1))) >> LOAD_MAP_FRACTION_BITS;
+}
+
+uint8_t LoadMap::getCoveredBinCount() const {
+    uint8_t covered = 0;
+    for (uint8_t bin = 0; bin < LOAD_MAP_BINS; bin++) {
+        if (sampleCounts[bin] > 0) {
+            covered++;
+        }
+    }
+    return covered;
+}
+
+uint8_t LoadMap::getMinSampleCount() const {
+    uint8_t minCount = UINT8_MAX;
+    for (uint8_t bin = 0; bin < LOAD_MAP_BINS; bin++) {
+        minCount = min(minCount, sampleCounts[bin]);
+    }
+    return minCount;
+}
+
+bool LoadMap::fitFirstHarmonic(float& mean, float& amplitude, float& peakAngle) const {
+    if (getMinSampleCount() == 0) return false;
+
+    // With equally spaced bins the least-squares fit reduces to the first DFT coefficient
+    const float binAngle = 6.28318530718f / static_cast<float>(LOAD_MAP_BINS);
+    float sum = 0.0f;
+    float sumCos = 0.0f;
+    float sumSin = 0.0f;
+
+    for (uint8_t bin = 0; bin < LOAD_MAP_BINS; bin++) {
+        const float value = static_cast<float>(averages[bin]) / static_cast<float>(1 << LOAD_MAP_FRACTION_BITS);
+        const float angle = (static_cast<float>(bin) + 0.5f) * binAngle;
+        sum += value;
+        sumCos += value * cosf(angle);
+        sumSin += value * sinf(angle);
+    }
+
+    mean = sum / LOAD_MAP_BINS;
+    amplitude = 2.0f * sqrtf(sumCos * sumCos + sumSin * sumSin) / LOAD_MAP_BINS;
+    peakAngle = atan2f(sumSin, sumCos);
+    if (peakAngle < 0.0f) {
+        peakAngle += 6.28318530718f;
+    }
+
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef LOAD_MAP_H
+#define LOAD_MAP_H
+
+/**
+ * @file LoadMap.h
+ * @brief Angle-resolved StallGuard load map over one output revolution
+ *
+ * Each bin holds an exponential moving average of the SG_RESULT samples taken while
+ * the shaft was inside that bin. SG_RESULT drops as the load rises, so the bins with
+ * the lowest values mark the heavy side of an unbalanced roast.
+ */
+
+#include <Arduino.h>
+
+#define LOAD_MAP_BINS 64          // Bins per output revolution (5.625° per bin)
+#define LOAD_MAP_EMA_SHIFT 2      // EMA weight of a new sample = 1/2^shift (1/4 settles within a few revolutions)
+#define LOAD_MAP_FRACTION_BITS 4  // Fixed-point fraction bits of the stored averages
+
+class LoadMap {
+private:
+    uint16_t averages[LOAD_MAP_BINS];    // EMA of SG_RESULT in 1/2^LOAD_MAP_FRACTION_BITS units
+    uint8_t sampleCounts[LOAD_MAP_BINS]; // Samples per bin, saturating at 255
+    uint32_t totalSamples;
+
+public:
+    LoadMap();
+
+    void reset();
+    void addSample(uint8_t bin, uint16_t stallGuardResult);
+
+    bool hasSamples(uint8_t bin) const { return sampleCounts[bin] > 0; }
+    uint16_t getValue(uint8_t bin) const; // Averaged SG_RESULT (0-510), 0 if the bin has no samples
+    uint8_t getCoveredBinCount() const;
+    uint8_t getMinSampleCount() const;    // Lowest per-bin sample count (0 until every bin was visited)
+    uint32_t getTotalSamples() const { return totalSamples; }
+
+    // Least-squares fit of mean + amplitude * cos(angle - peakAngle) over all bins (bin centre angles).
+    // Returns false unless every bin has samples.
+    bool fitFirstHarmonic(float& mean, float& amplitude, float& peakAngle) const;
+};
+
+#endif // LOAD_MAP_H
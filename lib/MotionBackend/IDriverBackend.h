@@ -0,0 +1,87 @@
+#ifndef I_DRIVER_BACKEND_H
+#define I_DRIVER_BACKEND_H
+
+/**
+ * @file IDriverBackend.h
+ * @brief Stepper driver (TMC2209) interface used by StepperController
+ *
+ * Register setters only record desired values; applyRegisters() hands them to
+ * whoever talks to the driver. Diagnostics are read from a snapshot and never
+ * block, so the motion loop does not depend on how the backend reaches the driver.
+ */
+
+#include <stdint.h>
+
+// Driver status flags (mirrors the DRV_STATUS fields of TMC2209::Status the controller uses)
+struct DriverStatus {
+    bool over_temperature_warning;
+    bool over_temperature_shutdown;
+    bool over_temperature_120c;
+    bool over_temperature_143c;
+    bool over_temperature_150c;
+    bool over_temperature_157c;
+
+    DriverStatus()
+        : over_temperature_warning(false), over_temperature_shutdown(false), over_temperature_120c(false),
+          over_temperature_143c(false), over_temperature_150c(false), over_temperature_157c(false) {}
+};
+
+// Diagnostics snapshot published to the motion task
+struct DriverDiagnostics {
+    bool communicating;               // Driver answers and acknowledged all register writes
+    uint16_t stallGuardResult;        // Last SG_RESULT (0-510)
+    DriverStatus status;              // Last DRV_STATUS
+    uint32_t registerWriteCount;      // Total register writes issued
+    uint32_t communicationErrorCount; // IFCNT mismatches and failed probes
+    uint32_t lastUpdateMs;            // millis() of the last snapshot
+
+    // Last on-demand StallGuard sample (see requestStallGuardSample())
+    uint32_t sampleSequence;          // Incremented for every completed sample
+    uint8_t sampleTag;                // Tag passed with the request
+    uint16_t sampleStallGuardResult;  // SG_RESULT read for that request
+
+    // Microstep resolution (MRES) the driver has acknowledged, for a position-consistent switch
+    uint16_t appliedMicrosteps;       // Last verified CHOPCONF write, 0 = none yet
+    uint32_t microstepsAppliedUs;     // micros() right after that write was sent
+
+    // Internal step generator velocity (VACTUAL) the driver has acknowledged, 0 = following STEP/DIR
+    int32_t appliedVelocity;
+
+    DriverDiagnostics()
+        : communicating(false), stallGuardResult(0), status(), registerWriteCount(0),
+          communicationErrorCount(0), lastUpdateMs(0),
+          sampleSequence(0), sampleTag(0), sampleStallGuardResult(0),
+          appliedMicrosteps(0), microstepsAppliedUs(0), appliedVelocity(0) {}
+};
+
+class IDriverBackend {
+public:
+    virtual ~IDriverBackend() {}
+
+    // Claim pins/resources (e.g. the DIAG input)
+    virtual bool begin() = 0;
+
+    // Desired register values (not applied until applyRegisters())
+    virtual void setStealthChop(bool enabled) = 0;
+    virtual void setAutomaticPwm(bool enabled) = 0;
+    virtual void setRunCurrent(uint8_t percent) = 0;
+    virtual void setMicrostepsPerStep(uint16_t microsteps) = 0;
+    virtual void setEnabled(bool enabled) = 0;
+    virtual void setCoolStepDurationThreshold(uint32_t threshold) = 0;
+    virtual void setStallGuardThreshold(uint8_t threshold) = 0;
+    virtual void setVelocity(int32_t vactual) = 0; // Internal step generator (VACTUAL), 0 = follow STEP/DIR
+    virtual void markAllDirty() = 0; // Rewrite everything on the next apply
+    virtual void applyRegisters() = 0;
+
+    // Read SG_RESULT as soon as possible and report it with the given tag in the diagnostics.
+    // A request that is still pending is replaced by the newer one.
+    virtual void requestStallGuardSample(uint8_t tag) = 0;
+
+    // Latest diagnostics snapshot; never blocks. Single reader (the motion task) only.
+    virtual const DriverDiagnostics& getDiagnostics() = 0;
+
+    // StallGuard stall output (DIAG line)
+    virtual bool isStallDetected() = 0;
+};
+
+#endif // I_DRIVER_BACKEND_H
@@ -0,0 +1,51 @@
+#ifndef I_STEPPER_BACKEND_H
+#define I_STEPPER_BACKEND_H
+
+/**
+ * @file IStepperBackend.h
+ * @brief Step generation interface used by StepperController
+ *
+ * Mirrors the subset of FastAccelStepper the controller uses, so the hardware
+ * implementation is a thin forwarder and the simulated one can stand in for it
+ * on a host build. Positions are in microsteps, speeds in steps/s (Hz).
+ */
+
+#include <stdint.h>
+
+#define STEPPER_BACKEND_IDLE_UPDATE 1000 // update() interval of a backend with nothing to advance (ms)
+
+class IStepperBackend {
+public:
+    virtual ~IStepperBackend() {}
+
+    // Claim pins/resources; false if the axis cannot be driven
+    virtual bool begin() = 0;
+
+    // Target speed and acceleration take effect on the next run*() or applySpeedAcceleration()
+    virtual void setSpeedInHz(uint32_t stepsPerSecond) = 0;
+    virtual void setAcceleration(uint32_t stepsPerSecond2) = 0;
+    virtual void applySpeedAcceleration() = 0;
+
+    // Continuous motion; forward means clockwise in this project
+    virtual void runForward() = 0;
+    virtual void runBackward() = 0;
+    virtual void stopMove() = 0;                               // Decelerate to standstill
+    virtual void forceStopAndNewPosition(int32_t position) = 0; // Immediate stop, no ramp
+
+    // false keeps the driver's enable output asserted while no steps are generated (the motor is
+    // moved by another source); true (default) enables it only around step generation
+    virtual void setAutoEnable(bool enabled) { (void)enabled; }
+
+    virtual bool isRunning() = 0;
+    virtual int32_t getCurrentPosition() = 0;       // Wraps like the 32-bit hardware counter
+    virtual int32_t getCurrentSpeedInMilliHz() = 0; // Signed, negative while running backward
+
+    // Backends that generate the motion in software (e.g. ramping a driver's velocity register) are
+    // advanced here by the owner after every command and periodically; returns ms until the next call
+    virtual uint32_t update() { return STEPPER_BACKEND_IDLE_UPDATE; }
+
+    // true for backends with an update() worth calling; the others are never scheduled for it
+    virtual bool needsUpdate() const { return false; }
+};
+
+#endif // I_STEPPER_BACKEND_H
@@ -0,0 +1,125 @@
+#include "MotionTiming.h"
+
+#if defined(ESP_PLATFORM) && MOTION_TIMING_ISR_PROBE
+#include <esp_freertos_hooks.h>
+#endif
+
+MotionTiming::MotionTiming()
+    : isrCount(0), isrCycles(0), isrMaxCycles(0), lastIdleCycles(0), idlePassCycles(UINT32_MAX), isrMaxGapCycles(0),
+      windowStartMs(0), loopWakes(0), loopJitterTotalUs(0), loopJitterMaxUs(0), loopBusyMaxUs(0),
+      commandCount(0), commandLatencyTotalUs(0), commandLatencyMaxUs(0) {
+}
+
+uint32_t MotionTiming::cycleCount() {
+#if defined(ESP_PLATFORM)
+    return ESP.getCycleCount();
+#else
+    return micros();
+#endif
+}
+
+uint32_t MotionTiming::cpuFrequencyMHz() {
+#if defined(ESP_PLATFORM)
+    return ESP.getCpuFreqMHz();
+#else
+    return 1;
+#endif
+}
+
+void MotionTiming::begin(uint8_t core) {
+    windowStartMs = millis();
+    isrMaxGapCycles = MOTION_TIMING_ISR_MAX_US * cpuFrequencyMHz();
+
+#if defined(ESP_PLATFORM) && MOTION_TIMING_ISR_PROBE
+    lastIdleCycles = cycleCount();
+    if (esp_register_freertos_idle_hook_for_cpu(idleHook, core) != ESP_OK) {
+        dbg_println("MotionTiming: Failed to register the idle hook - no interrupt load measurement");
+    }
+#else
+    (void)core;
+#endif
+}
+
+bool MotionTiming::idleHook() {
+    getInstance().sampleIdlePass();
+    return false; // Call again right away - a WAITI between passes would count as interrupt time
+}
+
+void MotionTiming::sampleIdlePass() {
+    const uint32_t now = cycleCount();
+    const uint32_t pass = now - lastIdleCycles;
+    lastIdleCycles = now;
+
+    if (pass < idlePassCycles) {
+        idlePassCycles = pass;
+        return;
+    }
+
+    const uint32_t interrupted = pass - idlePassCycles;
+    if (interrupted < MOTION_TIMING_ISR_MIN_CYCLES || interrupted > isrMaxGapCycles) {
+        return;
+    }
+
+    isrCount.fetch_add(1, std::memory_order_relaxed);
+    isrCycles.fetch_add(interrupted, std::memory_order_relaxed);
+    if (interrupted > isrMaxCycles.load(std::memory_order_relaxed)) {
+        isrMaxCycles.store(interrupted, std::memory_order_relaxed);
+    }
+}
+
+void MotionTiming::recordLoopWake(uint32_t plannedUs, uint32_t actualUs) {
+    const int32_t lateness = (int32_t)(actualUs - plannedUs);
+    const uint32_t jitter = (uint32_t)(lateness < 0 ? -lateness : lateness);
+
+    loopWakes++;
+    loopJitterTotalUs += jitter;
+    if (jitter > loopJitterMaxUs) {
+        loopJitterMaxUs = jitter;
+    }
+}
+
+void MotionTiming::recordLoopBusy(uint32_t busyUs) {
+    if (busyUs > loopBusyMaxUs) {
+        loopBusyMaxUs = busyUs;
+    }
+}
+
+void MotionTiming::recordCommandLatency(uint32_t latencyUs) {
+    commandCount++;
+    commandLatencyTotalUs += latencyUs;
+    if (latencyUs > commandLatencyMaxUs) {
+        commandLatencyMaxUs = latencyUs;
+    }
+}
+
+void MotionTiming::takeWindow(MotionTimingWindow& window) {
+    const uint32_t now = millis();
+    const uint32_t elapsedMs = now - windowStartMs;
+    const uint32_t windowMs = elapsedMs > 0 ? elapsedMs : 1;
+    windowStartMs = now;
+
+    // Interrupts sampled while the counters are swapped may land in either window
+    const uint32_t count = isrCount.exchange(0, std::memory_order_relaxed);
+    const uint32_t cycles = isrCycles.exchange(0, std::memory_order_relaxed);
+
+    window.windowMs = windowMs;
+    window.isrCountPerSecond = (uint32_t)((uint64_t)count * 1000 / windowMs);
+    window.isrCyclesPerSecond = (uint32_t)((uint64_t)cycles * 1000 / windowMs);
+    window.isrMaxCycles = isrMaxCycles.exchange(0, std::memory_order_relaxed);
+    window.cpuFrequencyMHz = cpuFrequencyMHz();
+    window.loopWakes = loopWakes;
+    window.loopJitterMeanUs = loopWakes ? (uint32_t)(loopJitterTotalUs / loopWakes) : 0;
+    window.loopJitterMaxUs = loopJitterMaxUs;
+    window.loopBusyMaxUs = loopBusyMaxUs;
+    window.commandCount = commandCount;
+    window.commandLatencyMeanUs = commandCount ? (uint32_t)(commandLatencyTotalUs / commandCount) : 0;
+    window.commandLatencyMaxUs = commandLatencyMaxUs;
+
+    loopWakes = 0;
+    loopJitterTotalUs = 0;
+    loopJitterMaxUs = 0;
+    loopBusyMaxUs = 0;
+    commandCount = 0;
+    commandLatencyTotalUs = 0;
+    commandLatencyMaxUs = 0;
+}
@@ -0,0 +1,109 @@
+#ifndef MOTION_TIMING_H
+#define MOTION_TIMING_H
+
+/**
+ * @file MotionTiming.h
+ * @brief CPU cost and timing of the motion core: step interrupts, loop jitter, command latency
+ *
+ * Three measurements, collected into fixed windows and taken by the motion task:
+ *
+ * - Interrupt load on the motion core. FastAccelStepper's step interrupts live inside the
+ *   library, so they are measured from the outside with the cycle counter: an idle hook on
+ *   the motion core spins and timestamps every pass. A pass that is longer than the plain
+ *   idle loop (the shortest pass seen) was interrupted, and the difference is the time the
+ *   interrupt took. Gaps above MOTION_TIMING_ISR_MAX_US are task switches, not interrupts.
+ *   With the core otherwise idle most of the time this sees nearly every step interrupt;
+ *   interrupts that hit while a task runs are not counted. The spinning idle hook keeps the
+ *   core out of WAITI, so it is a diagnostic build option (MOTION_TIMING_ISR_PROBE 1, see the
+ *   esp32-s3-devkitm-1-timing environment); production builds report no interrupt load.
+ * - Motion loop wake jitter: planned vs. actual wake time of the motion task when it woke
+ *   for a due job (not for a command).
+ * - Command-to-apply latency: from SystemCommand::sendCommand() to the end of the dispatch.
+ *
+ * The recorders are lock-free; the idle hook is the only writer of the interrupt counters and
+ * the motion task the only writer of the rest.
+ */
+
+#include <Arduino.h>
+#include <atomic>
+#include "dbg_print.h"
+
+#ifndef MOTION_TIMING_ISR_PROBE
+#define MOTION_TIMING_ISR_PROBE 0   // 1 = idle-hook interrupt probe on the motion core (device build only)
+#endif
+#define MOTION_TIMING_ISR_MAX_US 100 // Longer idle gaps are task switches, not interrupts
+#define MOTION_TIMING_ISR_MIN_CYCLES 20 // Pass-to-pass noise of the idle loop itself
+#ifndef MOTION_TIMING_LOG
+#define MOTION_TIMING_LOG 0         // 1 = also print every window on the serial console
+#endif
+
+// One measurement window, rates normalized to one second
+struct MotionTimingWindow {
+    uint32_t windowMs;
+    uint32_t isrCountPerSecond;      // Interrupts seen on the motion core
+    uint32_t isrCyclesPerSecond;     // CPU cycles spent in them
+    uint32_t isrMaxCycles;           // Longest single interrupt
+    uint32_t cpuFrequencyMHz;        // Cycle counter rate (1 on the host: microseconds)
+    uint32_t loopWakes;              // Timed wakes of the motion task
+    uint32_t loopJitterMeanUs;       // |actual - planned| wake time
+    uint32_t loopJitterMaxUs;
+    uint32_t loopBusyMaxUs;          // Longest loop pass
+    uint32_t commandCount;
+    uint32_t commandLatencyMeanUs;   // sendCommand() to applied
+    uint32_t commandLatencyMaxUs;
+
+    MotionTimingWindow()
+        : windowMs(0), isrCountPerSecond(0), isrCyclesPerSecond(0), isrMaxCycles(0), cpuFrequencyMHz(0),
+          loopWakes(0), loopJitterMeanUs(0), loopJitterMaxUs(0), loopBusyMaxUs(0),
+          commandCount(0), commandLatencyMeanUs(0), commandLatencyMaxUs(0) {}
+};
+
+class MotionTiming {
+private:
+    // Written by the idle hook only
+    std::atomic<uint32_t> isrCount;
+    std::atomic<uint32_t> isrCycles;
+    std::atomic<uint32_t> isrMaxCycles;
+    uint32_t lastIdleCycles;
+    uint32_t idlePassCycles;       // Shortest idle pass seen (uninterrupted)
+    uint32_t isrMaxGapCycles;
+
+    // Written by the motion task only
+    uint32_t windowStartMs;
+    uint32_t loopWakes;
+    uint64_t loopJitterTotalUs;
+    uint32_t loopJitterMaxUs;
+    uint32_t loopBusyMaxUs;
+    uint32_t commandCount;
+    uint64_t commandLatencyTotalUs;
+    uint32_t commandLatencyMaxUs;
+
+    MotionTiming();
+    MotionTiming(const MotionTiming&) = delete;
+    MotionTiming& operator=(const MotionTiming&) = delete;
+
+    static bool idleHook();
+    void sampleIdlePass();
+
+public:
+    static MotionTiming& getInstance() {
+        static MotionTiming instance;
+        return instance;
+    }
+
+    static uint32_t cycleCount();
+    static uint32_t cpuFrequencyMHz();
+
+    // Install the interrupt probe on the given core (no-op without MOTION_TIMING_ISR_PROBE or on the host)
+    void begin(uint8_t core);
+
+    // Motion task recorders
+    void recordLoopWake(uint32_t plannedUs, uint32_t actualUs);
+    void recordLoopBusy(uint32_t busyUs);
+    void recordCommandLatency(uint32_t latencyUs);
+
+    // Close the current window and start the next one
+    void takeWindow(MotionTimingWindow& window);
+};
+
+#endif // MOTION_TIMING_H
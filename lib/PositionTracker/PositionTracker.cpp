@@ -0,0 +1,56 @@
+#include "PositionTracker.h"
+
+PositionTracker::PositionTracker(int32_t stepsPerRevolution)
+    : stepsPerRevolution(stepsPerRevolution), lastRawPosition(0), position(0), odometer(0), revolutionPosition(0),
+      rawMicrosteps(1), unitMicrosteps(1), rawRemainder(0) {
+}
+
+void PositionTracker::begin(int32_t rawPosition) {
+    lastRawPosition = rawPosition;
+}
+
+void PositionTracker::update(int32_t rawPosition) {
+    // Unsigned subtraction gives the correct signed delta across the int32_t wrap
+    const int32_t rawDelta = static_cast<int32_t>(static_cast<uint32_t>(rawPosition) - static_cast<uint32_t>(lastRawPosition));
+    lastRawPosition = rawPosition;
+
+    if (rawDelta == 0) return;
+
+    // Whole counter units; the rest is carried (same sign as the movement) into the next update
+    const int64_t scaled = static_cast<int64_t>(rawDelta) * unitMicrosteps + rawRemainder;
+    const int32_t delta = static_cast<int32_t>(scaled / rawMicrosteps);
+    rawRemainder = static_cast<int32_t>(scaled - static_cast<int64_t>(delta) * rawMicrosteps);
+
+    if (delta == 0) return;
+
+    position += delta;
+    odometer += static_cast<uint32_t>(delta < 0 ? -static_cast<int64_t>(delta) : delta);
+
+    // Integer phase: exact modulo one revolution, no float accumulation
+    revolutionPosition = static_cast<int32_t>((static_cast<int64_t>(revolutionPosition) + delta) % stepsPerRevolution);
+    if (revolutionPosition < 0) {
+        revolutionPosition += stepsPerRevolution;
+    }
+}
+
+void PositionTracker::setRawScaleAt(int32_t rawSwitchPosition, uint16_t rawMicrosteps, uint16_t unitMicrosteps) {
+    const int32_t rawPosition = lastRawPosition;
+
+    // Step back to the switch; the odometer had counted that stretch forward, so take it out again
+    const uint64_t odometerBefore = odometer;
+    update(rawSwitchPosition);
+    odometer = 2 * odometerBefore - odometer;
+
+    setRawScale(rawMicrosteps, unitMicrosteps);
+    update(rawPosition);
+}
+
+void PositionTracker::setRawScale(uint16_t rawMicrosteps, uint16_t unitMicrosteps) {
+    if (rawMicrosteps == 0 || unitMicrosteps == 0) return;
+
+    // Keep the carried fraction of a unit at the new raw resolution
+    rawRemainder = static_cast<int32_t>(static_cast<int64_t>(rawRemainder) * rawMicrosteps / this->rawMicrosteps *
+                                        unitMicrosteps / this->unitMicrosteps);
+    this->rawMicrosteps = rawMicrosteps;
+    this->unitMicrosteps = unitMicrosteps;
+}
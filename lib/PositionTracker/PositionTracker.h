@@ -0,0 +1,55 @@
+#ifndef POSITION_TRACKER_H
+#define POSITION_TRACKER_H
+
+/**
+ * @file PositionTracker.h
+ * @brief Unwraps the 32-bit stepper position into 64-bit counters
+ *
+ * FastAccelStepper reports a wrapping int32_t position. Each update() adds the
+ * wrap-safe delta since the previous call to a 64-bit position, a 64-bit odometer
+ * (absolute distance) and an integer position within one output revolution, so none
+ * of them drift or jump however long the motor runs. update() has to be called at
+ * least once per 2^31 microsteps - at full speed that is more than a day.
+ *
+ * The raw counter may run at a different microstep resolution than the counters
+ * (dynamic microstepping): setRawScale() converts raw steps into counter units, carrying
+ * the fraction of a unit between updates, so a resolution change neither jumps nor
+ * drifts the 64-bit position.
+ */
+
+#include <Arduino.h>
+
+class PositionTracker {
+private:
+    const int32_t stepsPerRevolution;
+    int32_t lastRawPosition;
+    int64_t position;           // Unwrapped position in microsteps
+    uint64_t odometer;          // Microsteps travelled in either direction
+    int32_t revolutionPosition; // Position relative to the revolution origin, 0 .. stepsPerRevolution-1
+    uint16_t rawMicrosteps;     // Resolution of the raw counter
+    uint16_t unitMicrosteps;    // Resolution of the counters
+    int32_t rawRemainder;       // Raw movement not yet worth a whole unit (scaled by unitMicrosteps)
+
+public:
+    explicit PositionTracker(int32_t stepsPerRevolution);
+
+    void begin(int32_t rawPosition);  // Adopt the current raw position without counting it as movement
+    void update(int32_t rawPosition); // Accumulate the movement since the last call
+
+    // Raw counts are 1/rawMicrosteps steps, counters 1/unitMicrosteps steps. Call update() with
+    // the last position at the old resolution first.
+    void setRawScale(uint16_t rawMicrosteps, uint16_t unitMicrosteps);
+
+    // The raw resolution changed at rawSwitchPosition, which earlier update() calls may already have
+    // passed at the old resolution: that movement is counted again at the new one (position, phase
+    // and odometer), then counting continues at the new resolution from the last raw position.
+    void setRawScaleAt(int32_t rawSwitchPosition, uint16_t rawMicrosteps, uint16_t unitMicrosteps);
+
+    void setRevolutionOrigin() { revolutionPosition = 0; } // Current position becomes angle 0
+
+    int64_t getPosition() const { return position; }
+    uint64_t getOdometer() const { return odometer; }
+    uint32_t getRevolutionPosition() const { return static_cast<uint32_t>(revolutionPosition); }
+};
+
+#endif // POSITION_TRACKER_H
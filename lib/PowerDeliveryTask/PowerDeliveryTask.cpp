@@ -15,8 +15,7 @@ PowerDeliveryTask::PowerDeliveryTask()
       isAutoNegotiating(false),
       autoNegotiationVoltageIndex(0),
       autoNegotiationHighestVoltage(0),
-      lastStatusUpdate(0),
-      lastVoltageUpdate(0),
+      negotiationJobId(DEADLINE_SCHEDULER_INVALID_JOB),
       isInitialized(false) {
 }
 
@@ -33,32 +32,44 @@ void PowerDeliveryTask::run() {
     isInitialized = true;
     dbg_println("PowerDeliveryTask: Initialization complete");
     
+    // Register periodic jobs (negotiation polling is parked until a negotiation starts)
+    negotiationJobId = scheduler.addJob("pd_negotiation", PD_NEGOTIATION_POLL_INTERVAL, negotiationJob, this);
+    scheduler.addJob("pd_status", PD_STATUS_UPDATE_INTERVAL, statusJob, this, PD_STATUS_UPDATE_INTERVAL);
+    
     // Start with automatic highest voltage negotiation
     autoNegotiateHighestVoltageInternal();
     
     // Main task loop
+    PowerDeliveryCommandData command;
     while (true) {
-        unsigned long currentTime = millis();
-        
-        // Process incoming commands
-        processCommands();
-        
-        // Update negotiation state machine
-        updateNegotiationState();
-        
-        // Publish periodic status updates
-        if (currentTime - lastStatusUpdate >= PD_STATUS_UPDATE_INTERVAL) {
-            publishPeriodicStatusUpdates();
-            publishPowerGoodStatus();
-            publishVoltageStatus();
-            lastStatusUpdate = currentTime;
+        // Sleep until a command arrives or the earliest job is due
+        if (SystemCommand::getInstance().getPowerDeliveryCommand(command, scheduler.ticksUntilNextDue())) {
+            processCommand(command);
+            processCommands(); // Drain anything else that queued up
         }
         
-        // Small delay to prevent overwhelming the system
-        vTaskDelay(pdMS_TO_TICKS(10));
+        scheduler.runDueJobs();
     }
 }
 
+void PowerDeliveryTask::negotiationJob(void* context) {
+    PowerDeliveryTask* self = static_cast<PowerDeliveryTask*>(context);
+    
+    // Update negotiation state machine
+    self->updateNegotiationState();
+    
+    // Nothing to poll once negotiation has finished - park until the next one starts
+    if (self->negotiationState != PDNegotiationState::NEGOTIATING &&
+        self->negotiationState != PDNegotiationState::AUTO_NEGOTIATING) {
+        self->scheduler.rescheduleIn(self->negotiationJobId, DEADLINE_SCHEDULER_PARKED);
+    }
+}
+
+void PowerDeliveryTask::statusJob(void* context) {
+    // Publish periodic status updates
+    static_cast<PowerDeliveryTask*>(context)->publishPeriodicStatusUpdates();
+}
+
 // ============================================================================
 // HARDWARE ABSTRACTION LAYER (Pure Hardware Control)
 // ============================================================================
@@ -173,6 +184,9 @@ void PowerDeliveryTask::applyNegotiationVoltage(int voltage) {
     
     // Configure hardware for target voltage
     pdConfigureVoltage(voltage);
+    
+    // Start polling for power good
+    scheduler.rescheduleIn(negotiationJobId, 0);
 
     publishNegotiationStatus();
 }
@@ -305,32 +319,47 @@ void PowerDeliveryTask::handleAutoNegotiation(unsigned long currentTime) {
 // COMMAND PROCESSING (Internal Methods)
 // ============================================================================
 
+void PowerDeliveryTask::processCommand(const PowerDeliveryCommandData& command) {
+    SystemStatus& systemStatus = SystemStatus::getInstance();
+    
+    // Acks carry the voltage the negotiation now aims for; its outcome follows as status updates
+    switch (command.command) {
+        case PowerDeliveryCommand::SET_TARGET_VOLTAGE: {
+            const bool accepted = setTargetVoltageInternal(command.intValue);
+            systemStatus.publishCommandAck(command.seq, 0, accepted ? CommandResult::OK : CommandResult::REJECTED,
+                                           static_cast<float>(targetVoltage));
+            break;
+        }
+            
+        case PowerDeliveryCommand::AUTO_NEGOTIATE_HIGHEST: {
+            const bool accepted = autoNegotiateHighestVoltageInternal();
+            systemStatus.publishCommandAck(command.seq, 0, accepted ? CommandResult::OK : CommandResult::REJECTED,
+                                           static_cast<float>(targetVoltage));
+            break;
+        }
+            
+        case PowerDeliveryCommand::REQUEST_ALL_STATUS:
+            requestAllStatusInternal();
+            systemStatus.publishCommandAck(command.seq, 0, CommandResult::OK);
+            break;
+            
+        default:
+            dbg_printf("PowerDeliveryTask: Unknown command %d\n", static_cast<int>(command.command));
+            systemStatus.publishCommandAck(command.seq, 0, CommandResult::REJECTED);
+            break;
+    }
+}
+
 void PowerDeliveryTask::processCommands() {
     PowerDeliveryCommandData command;
     
     // Process all pending commands
     while (SystemCommand::getInstance().getPowerDeliveryCommand(command, 0)) {
-        switch (command.command) {
-            case PowerDeliveryCommand::SET_TARGET_VOLTAGE:
-                setTargetVoltageInternal(command.intValue);
-                break;
-                
-            case PowerDeliveryCommand::AUTO_NEGOTIATE_HIGHEST:
-                autoNegotiateHighestVoltageInternal();
-                break;
-                
-            case PowerDeliveryCommand::REQUEST_ALL_STATUS:
-                requestAllStatusInternal();
-                break;
-                
-            default:
-                dbg_printf("PowerDeliveryTask: Unknown command %d\n", static_cast<int>(command.command));
-                break;
-        }
+        processCommand(command);
     }
 }
 
-void PowerDeliveryTask::setTargetVoltageInternal(int voltage) {
+bool PowerDeliveryTask::setTargetVoltageInternal(int voltage) {
     // Validate voltage range
     if (voltage < PD_VOLTAGE_5V || voltage > PD_VOLTAGE_20V) {
         dbg_printf("PowerDeliveryTask: Invalid target voltage %dV (allowed: 5V, 9V, 12V, 15V, 20V)\n", voltage);
@@ -340,19 +369,20 @@ void PowerDeliveryTask::setTargetVoltageInternal(int voltage) {
         publishVoltageStatus();
         SystemStatus::getInstance().sendNotification(NotificationType::ERROR, 
             "Invalid target voltage requested: " + String(voltage) + "V");
-        return;
+        return false;
     }
     
     // Apply voltage negotiation
     applyNegotiationVoltage(voltage);
     
     dbg_printf("PowerDeliveryTask: Target voltage set to %dV\n", voltage);
+    return true;
 }
 
-void PowerDeliveryTask::autoNegotiateHighestVoltageInternal() {
+bool PowerDeliveryTask::autoNegotiateHighestVoltageInternal() {
     if (!isInitialized) {
         dbg_println("WARNING: Cannot start auto-negotiation - hardware not initialized");
-        return;
+        return false;
     }
     
     dbg_println("PowerDeliveryTask: Starting auto-negotiation for highest available voltage");
@@ -374,8 +404,12 @@ void PowerDeliveryTask::autoNegotiateHighestVoltageInternal() {
     // Configure hardware for first voltage
     pdConfigureVoltage(startVoltage);
     
+    // Start polling for power good
+    scheduler.rescheduleIn(negotiationJobId, 0);
+    
     // Publish status update
     publishNegotiationStatus();
+    return true;
 }
 
 void PowerDeliveryTask::requestAllStatusInternal() {
@@ -13,6 +13,7 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
 #include "Task.h"
+#include "DeadlineScheduler.h"
 #include "SystemStatus.h"
 #include "SystemCommand.h"
 #include "dbg_print.h"
@@ -39,6 +40,7 @@
 
 // Timing configuration
 #define PD_STATUS_UPDATE_INTERVAL       500     // Update every 500ms
+#define PD_NEGOTIATION_POLL_INTERVAL    10      // Poll power good every 10ms while negotiating
 #define PD_NEGOTIATION_TIMEOUT          2000    // 2 second timeout for negotiation
 #define PD_POWER_GOOD_DEBOUNCE          100     // Debounce power good signal
 
@@ -68,9 +70,9 @@ private:
     static const int autoNegotiationVoltages[5]; // Available voltages in descending order
     int autoNegotiationHighestVoltage;
     
-    // Timing variables
-    unsigned long lastStatusUpdate;
-    unsigned long lastVoltageUpdate;
+    // Periodic job scheduling for run()
+    DeadlineScheduler scheduler;
+    int8_t negotiationJobId;
     
     // Initialization flag
     bool isInitialized;
@@ -101,11 +103,16 @@ private:
     void updateNegotiationState();
     void handleSingleVoltageNegotiation(unsigned long currentTime);
     void handleAutoNegotiation(unsigned long currentTime);
+    void processCommand(const PowerDeliveryCommandData& command);
     void processCommands();
     
+    // Scheduler job trampolines
+    static void negotiationJob(void* context);
+    static void statusJob(void* context);
+    
     // Internal command processors (with validation)
-    void setTargetVoltageInternal(int voltage);
-    void autoNegotiateHighestVoltageInternal();
+    bool setTargetVoltageInternal(int voltage);      // False if rejected
+    bool autoNegotiateHighestVoltageInternal();
     void requestAllStatusInternal();
     
     // Initialization and settings
@@ -0,0 +1,102 @@
+#include "RotisserieModel.h"
+
+#define ROTISSERIE_GRAVITY 9.81f
+#define ROTISSERIE_TWO_PI 6.28318530718f
+
+RotisserieModel::RotisserieModel(const RotisserieParameters& parameters)
+    : parameters(parameters), stats(), torqueIntegral(0.0), torqueSquareIntegral(0.0), hasSamples(false) {
+    radiansPerStep = ROTISSERIE_TWO_PI / parameters.microStepsPerMotorRevolution;
+    gravityTorque = parameters.eccentricMass * ROTISSERIE_GRAVITY * parameters.eccentricRadius;
+
+    // The eccentric mass adds m·r² to the spit inertia; both are reduced by the gear ratio squared
+    const float spitInertia = parameters.spitInertia + parameters.eccentricMass * parameters.eccentricRadius * parameters.eccentricRadius;
+    reflectedInertia = spitInertia / (parameters.gearRatio * parameters.gearRatio);
+}
+
+float RotisserieModel::calculateSpitAngle(double motorPositionSteps) const {
+    const double spitRevolutions = motorPositionSteps / (parameters.microStepsPerMotorRevolution * parameters.gearRatio);
+    return (float)(ROTISSERIE_TWO_PI * (spitRevolutions - floor(spitRevolutions)));
+}
+
+float RotisserieModel::calculateMotorTorque(double motorPositionSteps, double motorSpeedSteps, double motorAccelerationSteps) const {
+    const float motorSpeed = (float)motorSpeedSteps * radiansPerStep;
+    const float motorAcceleration = (float)motorAccelerationSteps * radiansPerStep;
+    const float spitSpeed = motorSpeed / parameters.gearRatio;
+
+    // Load torque at the spit: eccentric mass (helps on the way down) and friction against the motion
+    float spitTorque = gravityTorque * cosf(calculateSpitAngle(motorPositionSteps) - parameters.eccentricAngle);
+    if (spitSpeed > 0.0f) {
+        spitTorque += parameters.coulombFriction;
+    } else if (spitSpeed < 0.0f) {
+        spitTorque -= parameters.coulombFriction;
+    }
+    spitTorque += parameters.viscousFriction * spitSpeed;
+
+    // Through the gearbox: losses add to the torque when the motor drives, reduce it when the load overhauls
+    float motorTorque = spitTorque / parameters.gearRatio;
+    const bool driving = (motorTorque >= 0.0f) == (motorSpeed >= 0.0f);
+    motorTorque = driving ? motorTorque / parameters.gearEfficiency : motorTorque * parameters.gearEfficiency;
+
+    return motorTorque + (parameters.rotorInertia + reflectedInertia) * motorAcceleration;
+}
+
+float RotisserieModel::calculateAvailableTorque(double motorSpeedSteps) const {
+    const float motorSpeed = fabsf((float)motorSpeedSteps * radiansPerStep);
+    return parameters.holdingTorque * parameters.runCurrent / (1.0f + motorSpeed / parameters.cornerSpeed);
+}
+
+uint16_t RotisserieModel::calculateStallGuardResult(double motorPositionSteps, double motorSpeedSteps, double motorAccelerationSteps) const {
+    const float available = calculateAvailableTorque(motorSpeedSteps);
+    if (motorSpeedSteps == 0.0 || available <= 0.0f) {
+        return 0;
+    }
+    // Back-EMF grows with velocity, and the load eats into it as it approaches the pull-out torque
+    const float motorSpeed = fabsf((float)motorSpeedSteps * radiansPerStep);
+    const float torque = fabsf(calculateMotorTorque(motorPositionSteps, motorSpeedSteps, motorAccelerationSteps));
+    const float result = parameters.stallGuardGain * motorSpeed * (1.0f - torque / available);
+    return (uint16_t)(result < 0.0f ? 0.0f : (result > 510.0f ? 510.0f : result));
+}
+
+void RotisserieModel::addSample(double motorPositionSteps, double motorSpeedSteps, double motorAccelerationSteps, double dt) {
+    const float torque = calculateMotorTorque(motorPositionSteps, motorSpeedSteps, motorAccelerationSteps);
+    const float available = calculateAvailableTorque(motorSpeedSteps);
+    const float margin = available > 0.0f ? 1.0f - fabsf(torque) / available : -1.0f;
+
+    if (!hasSamples) {
+        stats.minMotorTorque = torque;
+        stats.maxMotorTorque = torque;
+        stats.minStallMargin = margin;
+        hasSamples = true;
+    }
+    if (torque < stats.minMotorTorque) {
+        stats.minMotorTorque = torque;
+    }
+    if (torque > stats.maxMotorTorque) {
+        stats.maxMotorTorque = torque;
+    }
+    if (margin < stats.minStallMargin) {
+        stats.minStallMargin = margin;
+    }
+
+    torqueIntegral += torque * dt;
+    torqueSquareIntegral += (double)torque * torque * dt;
+    stats.simulatedTime += dt;
+}
+
+void RotisserieModel::resetStats() {
+    stats = RotisserieStats();
+    torqueIntegral = 0.0;
+    torqueSquareIntegral = 0.0;
+    hasSamples = false;
+}
+
+RotisserieStats RotisserieModel::getStats() const {
+    RotisserieStats result = stats;
+    result.peakMotorTorque = fmaxf(fabsf(stats.minMotorTorque), fabsf(stats.maxMotorTorque));
+    result.torqueRipple = stats.maxMotorTorque - stats.minMotorTorque;
+    if (stats.simulatedTime > 0.0) {
+        result.meanMotorTorque = (float)(torqueIntegral / stats.simulatedTime);
+        result.rmsMotorTorque = (float)sqrt(torqueSquareIntegral / stats.simulatedTime);
+    }
+    return result;
+}
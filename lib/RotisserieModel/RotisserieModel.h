@@ -0,0 +1,110 @@
+#ifndef ROTISSERIE_MODEL_H
+#define ROTISSERIE_MODEL_H
+
+/**
+ * @file RotisserieModel.h
+ * @brief Rigid-body load model of the spit for simulation and profile benchmarks
+ *
+ * The stepper imposes the motor shaft motion (it is position controlled), so the model
+ * works backwards from position, speed and acceleration to the torque the motor has to
+ * deliver: rotor inertia, spit inertia and an eccentric mass seen through the gearbox,
+ * plus Coulomb and viscous friction. Comparing that against the speed-dependent
+ * pull-out torque gives the stall margin. The synthetic SG_RESULT follows the TMC2209's
+ * StallGuard4: it measures back-EMF, so it rises with motor velocity and falls as the load
+ * takes up more of the pull-out torque.
+ *
+ * All motion inputs are in motor microsteps (the controller's units); torques are N·m
+ * at the motor shaft.
+ */
+
+#include <math.h>
+#include <stdint.h>
+
+struct RotisserieParameters {
+    // Drive train
+    float microStepsPerMotorRevolution; // STEPS_PER_REVOLUTION * MICRO_STEPS
+    float gearRatio;                    // Motor revolutions per spit revolution
+    float gearEfficiency;               // 0-1, applied in the driving direction
+    float rotorInertia;                 // kg·m² (motor rotor)
+
+    // Load at the spit
+    float spitInertia;                  // kg·m² (spit and roast about the axis)
+    float eccentricMass;                // kg, off-center part of the roast
+    float eccentricRadius;              // m from the axis
+    float eccentricAngle;               // rad, spit angle where the eccentric mass resists most
+    float coulombFriction;              // N·m (bearings, seals)
+    float viscousFriction;              // N·m per rad/s of spit speed
+
+    // Motor
+    float holdingTorque;                // N·m at 100% run current
+    float runCurrent;                   // 0-1 (TMC2209 run current / 100)
+    float cornerSpeed;                  // rad/s where the pull-out torque has dropped to half
+    float stallGuardGain;               // SG_RESULT per rad/s of motor speed without load (back-EMF slope)
+
+    // NEMA17 on the 1:10 gearbox turning a ~3 kg roast with 0.5 kg off-center by 3 cm
+    RotisserieParameters()
+        : microStepsPerMotorRevolution(3200.0f), gearRatio(10.0f), gearEfficiency(0.7f), rotorInertia(5.7e-6f),
+          spitInertia(5.4e-3f), eccentricMass(0.5f), eccentricRadius(0.03f), eccentricAngle(0.0f),
+          coulombFriction(0.05f), viscousFriction(0.01f),
+          holdingTorque(0.45f), runCurrent(0.3f), cornerSpeed(50.0f), stallGuardGain(20.0f) {}
+};
+
+// Load figures accumulated over a run (torques in N·m at the motor shaft)
+struct RotisserieStats {
+    float peakMotorTorque;   // Largest |torque|
+    float minMotorTorque;    // Signed extremes - torqueRipple = max - min
+    float maxMotorTorque;
+    float meanMotorTorque;   // Time-weighted
+    float rmsMotorTorque;
+    float torqueRipple;      // Peak-to-peak
+    float minStallMargin;    // Smallest 1 - |torque| / pull-out torque (negative = would stall)
+    double simulatedTime;    // s
+
+    // Step generator load, filled in by the profile simulation (steps/s at the driver resolution)
+    uint16_t microsteps;
+    float meanStepRate;
+    float peakStepRate;
+
+    RotisserieStats()
+        : peakMotorTorque(0.0f), minMotorTorque(0.0f), maxMotorTorque(0.0f), meanMotorTorque(0.0f),
+          rmsMotorTorque(0.0f), torqueRipple(0.0f), minStallMargin(1.0f), simulatedTime(0.0),
+          microsteps(0), meanStepRate(0.0f), peakStepRate(0.0f) {}
+};
+
+class RotisserieModel {
+private:
+    RotisserieParameters parameters;
+    float radiansPerStep;      // Motor shaft radians per microstep
+    float gravityTorque;       // Peak eccentric torque at the spit (N·m)
+    float reflectedInertia;    // Spit inertia seen at the motor (kg·m²)
+
+    RotisserieStats stats;
+    double torqueIntegral;
+    double torqueSquareIntegral;
+    bool hasSamples;
+
+public:
+    explicit RotisserieModel(const RotisserieParameters& parameters = RotisserieParameters());
+
+    const RotisserieParameters& getParameters() const { return parameters; }
+    void setRunCurrent(float fraction) { parameters.runCurrent = fraction; }
+
+    // Spit angle (rad, 0-2π) for a motor position
+    float calculateSpitAngle(double motorPositionSteps) const;
+
+    // Torque the motor must deliver for the imposed motion
+    float calculateMotorTorque(double motorPositionSteps, double motorSpeedSteps, double motorAccelerationSteps) const;
+
+    // Pull-out torque at the given motor speed (falls off with back-EMF)
+    float calculateAvailableTorque(double motorSpeedSteps) const;
+
+    // SG_RESULT estimate (0-510): stallGuardGain * |motor rad/s| * (1 - |torque| / pull-out torque)
+    uint16_t calculateStallGuardResult(double motorPositionSteps, double motorSpeedSteps, double motorAccelerationSteps) const;
+
+    // Statistics over a run; samples are weighted by dt
+    void addSample(double motorPositionSteps, double motorSpeedSteps, double motorAccelerationSteps, double dt);
+    void resetStats();
+    RotisserieStats getStats() const;
+};
+
+#endif // ROTISSERIE_MODEL_H
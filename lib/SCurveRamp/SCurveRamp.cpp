@@ -0,0 +1,68 @@
+#include "SCurveRamp.h"
+
+SCurveRamp::SCurveRamp()
+    : jerk(0.0f), maxAcceleration(0.0f), target(0.0f), speed(0.0f), acceleration(0.0f), stepAcceleration(0.0f) {
+}
+
+void SCurveRamp::reset(float stepsPerSecond) {
+    speed = stepsPerSecond > 0.0f ? stepsPerSecond : 0.0f;
+    acceleration = 0.0f;
+    stepAcceleration = 0.0f;
+}
+
+bool SCurveRamp::update(float dt) {
+    if (isSettled() || dt <= 0.0f) {
+        stepAcceleration = 0.0f;
+        return false;
+    }
+
+    const float startSpeed = speed;
+    const float startAcceleration = acceleration;
+    const float remaining = target - speed;
+    const float maxJerkStep = jerk * dt;
+
+    // Without a usable limit there is nothing to shape - jump straight to the target
+    if (jerk <= 0.0f || maxAcceleration <= 0.0f) {
+        speed = target;
+        acceleration = 0.0f;
+        stepAcceleration = fabsf(remaining) / dt;
+        return false;
+    }
+
+    // Acceleration a at the end of this step from which ramping down to zero, one jerk step per
+    // update, ends exactly at the target: (a0 + a)/2·dt + a²/(2·jerk) + a·dt/2 = |remaining|
+    const float direction = remaining < 0.0f ? -1.0f : 1.0f;
+    const float halfStep = 0.5f * dt;
+    const float distance = fmaxf(0.0f, fabsf(remaining) - direction * startAcceleration * halfStep);
+    float desired = jerk * (sqrtf(dt * dt + 2.0f * distance / jerk) - dt);
+    desired = direction * fminf(maxAcceleration, fmaxf(0.0f, desired));
+
+    // Move the acceleration towards it by at most one jerk step
+    if (desired > acceleration + maxJerkStep) {
+        acceleration += maxJerkStep;
+    } else if (desired < acceleration - maxJerkStep) {
+        acceleration -= maxJerkStep;
+    } else {
+        acceleration = desired;
+    }
+
+    // Trapezoidal integration - the acceleration changes linearly over the step
+    speed += 0.5f * (startAcceleration + acceleration) * dt;
+
+    // Reached or passed the target: settle if the acceleration is (nearly) ramped out, otherwise
+    // it was a target change against the motion and the ramp keeps turning around. Within half a
+    // step/s the step generator (whole steps/s) can't tell the difference - settle there as well
+    // instead of creeping towards the target for dozens of updates
+    const bool crossed = remaining >= 0.0f ? speed >= target : speed <= target;
+    if ((crossed || fabsf(target - speed) < 0.5f) && fabsf(acceleration) <= 2.0f * maxJerkStep) {
+        speed = target;
+        acceleration = 0.0f;
+    }
+    if (speed < 0.0f) {
+        speed = 0.0f;
+        acceleration = 0.0f;
+    }
+
+    stepAcceleration = fabsf(speed - startSpeed) / dt;
+    return !isSettled();
+}
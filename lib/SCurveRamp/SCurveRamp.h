@@ -0,0 +1,52 @@
+#ifndef S_CURVE_RAMP_H
+#define S_CURVE_RAMP_H
+
+/**
+ * @file SCurveRamp.h
+ * @brief Jerk-limited (S-curve) speed ramp generator
+ *
+ * FastAccelStepper ramps with a constant acceleration, so every speed change starts and
+ * ends with an acceleration step - a torque step the gearbox and roast feel as a knock.
+ * SCurveRamp tracks a target speed with the acceleration itself ramped at no more than
+ * the jerk limit: it accelerates towards min(maxAcceleration, sqrt(2·jerk·|Δv|)), the
+ * largest acceleration that can still be ramped back to zero exactly at the target.
+ *
+ * The owner advances it on a fixed interval and hands each step to the step generator as
+ * a short constant-acceleration segment (getSpeed() reached after getStepAcceleration()),
+ * so the generator follows the S-curve piecewise. Speeds are magnitudes in steps/s.
+ */
+
+#include <math.h>
+#include <stdint.h>
+
+class SCurveRamp {
+private:
+    float jerk;             // steps/s³
+    float maxAcceleration;  // steps/s²
+    float target;           // steps/s
+    float speed;            // Commanded speed at the end of the last step
+    float acceleration;     // Signed, at the end of the last step
+    float stepAcceleration; // |Δspeed| / dt of the last step
+
+public:
+    SCurveRamp();
+
+    void setJerk(float stepsPerSecond3) { jerk = stepsPerSecond3; }
+    void setMaxAcceleration(float stepsPerSecond2) { maxAcceleration = stepsPerSecond2; }
+    void setTarget(float stepsPerSecond) { target = stepsPerSecond > 0.0f ? stepsPerSecond : 0.0f; }
+
+    // Restart from a known speed at rest acceleration (motor start, stop, direction reversal)
+    void reset(float stepsPerSecond);
+
+    // Advance by dt seconds; returns false once the target is reached with zero acceleration
+    bool update(float dt);
+
+    bool isSettled() const { return speed == target && acceleration == 0.0f; }
+    float getSpeed() const { return speed; }
+    float getAcceleration() const { return acceleration; }
+    float getStepAcceleration() const { return stepAcceleration; }
+    float getTarget() const { return target; }
+    float getMaxAcceleration() const { return maxAcceleration; }
+};
+
+#endif // S_CURVE_RAMP_H
@@ -0,0 +1,159 @@
+#include "SettingsStore.h"
+
+SettingsStore::SettingsStore()
+    : Task("Settings_Task", 4096, 1, 0), // Task name, 4KB stack (NVS), priority 1, core 0 (off the stepper core)
+      preferencesOpen(false), pendingQueues(), stored(), saveRequests(0), flashWrites(0) {
+}
+
+void SettingsStore::getRecordKey(uint8_t record, char* key, size_t keySize) {
+    if (record == 0) {
+        snprintf(key, keySize, "%s", SETTINGS_RECORD_KEY);
+    } else {
+        snprintf(key, keySize, "%s%u", SETTINGS_RECORD_KEY, record);
+    }
+}
+
+bool SettingsStore::begin(uint8_t record, PersistentSettings& settings) {
+    if (record >= SETTINGS_MAX_RECORDS) return false;
+
+    pendingQueues[record] = xQueueCreate(1, sizeof(PersistentSettings));
+    if (pendingQueues[record] == nullptr) {
+        dbg_println("ERROR: Failed to create settings queue");
+        return false;
+    }
+
+    if (!preferencesOpen) {
+        preferencesOpen = preferences.begin(SETTINGS_NAMESPACE, false);
+    }
+    if (!preferencesOpen) {
+        dbg_println("Failed to open preferences, using defaults");
+        stored[record] = settings;
+        return false;
+    }
+
+    char key[16];
+    getRecordKey(record, key, sizeof(key));
+
+    const size_t recordLength = preferences.getBytesLength(key);
+    if (recordLength > 0 && recordLength <= sizeof(PersistentSettings)) {
+        // Older (shorter) records keep the defaults for the fields appended since
+        preferences.getBytes(key, &settings, recordLength);
+        stored[record] = settings;
+        dbg_printf("Settings record %s loaded (%u bytes)\n", key, recordLength);
+        if (recordLength < sizeof(PersistentSettings)) {
+            save(record, settings); // Extend the record with the new fields
+        }
+        return true;
+    }
+
+    // No usable record yet - the main axis migrates the per-key layout of earlier firmware
+    if (record == 0) {
+        loadLegacyKeys(settings);
+        dbg_println("Settings migrated from individual keys");
+    }
+    stored[record] = settings;
+    save(record, settings);
+    return true;
+}
+
+void SettingsStore::loadLegacyKeys(PersistentSettings& settings) {
+    settings.speedRPM = preferences.getFloat("speed", settings.speedRPM);
+    settings.clockwise = preferences.getBool("clockwise", settings.clockwise);
+    settings.runCurrent = preferences.getInt("current", settings.runCurrent);
+    settings.acceleration = preferences.getUInt("acceleration", settings.acceleration);
+    settings.stallGuardThreshold = preferences.getUInt("stallGuardThreshold", settings.stallGuardThreshold);
+    settings.stallGuardCalibrationMargin = preferences.getUInt("sgCalMargin", settings.stallGuardCalibrationMargin);
+}
+
+void SettingsStore::save(uint8_t record, const PersistentSettings& settings) {
+    if (record >= SETTINGS_MAX_RECORDS || pendingQueues[record] == nullptr) return;
+
+    saveRequests++;
+
+    // Replace whatever is still waiting - only the newest record matters
+    xQueueOverwrite(pendingQueues[record], &settings);
+    if (taskHandle != NULL) {
+        xTaskNotifyGive(taskHandle);
+    }
+}
+
+void SettingsStore::run() {
+    dbg_println("Settings Task started");
+
+    PersistentSettings pending[SETTINGS_MAX_RECORDS];
+    uint32_t pendingRecords = 0; // Bit per record with an unsaved change
+    TickType_t firstChange = 0;
+
+    while (true) {
+        // Pick up the newest record of every axis (also those queued before start())
+        const bool hadPending = pendingRecords != 0;
+        for (uint8_t i = 0; i < SETTINGS_MAX_RECORDS; i++) {
+            if (pendingQueues[i] != nullptr && xQueueReceive(pendingQueues[i], &pending[i], 0) == pdTRUE) {
+                pendingRecords |= 1u << i;
+            }
+        }
+        if (!hadPending && pendingRecords != 0) {
+            firstChange = xTaskGetTickCount();
+        }
+
+        TickType_t wait = portMAX_DELAY;
+        if (pendingRecords != 0) {
+            // Debounce, but never postpone a write beyond SETTINGS_MAX_WRITE_DELAY
+            const TickType_t age = xTaskGetTickCount() - firstChange;
+            const TickType_t maxDelay = pdMS_TO_TICKS(SETTINGS_MAX_WRITE_DELAY);
+            wait = age >= maxDelay ? 0 : min(pdMS_TO_TICKS(SETTINGS_WRITE_DELAY), maxDelay - age);
+        }
+
+        if (ulTaskNotifyTake(pdTRUE, wait) > 0) {
+            continue; // Restart the idle window
+        }
+
+        for (uint8_t i = 0; i < SETTINGS_MAX_RECORDS; i++) {
+            if (pendingRecords & (1u << i)) {
+                writeRecord(i, pending[i]);
+            }
+        }
+        pendingRecords = 0;
+    }
+}
+
+uint32_t SettingsStore::calculateDirtyFields(const PersistentSettings& stored, const PersistentSettings& pending) {
+    uint32_t dirty = 0;
+    if (stored.speedRPM != pending.speedRPM) dirty |= FIELD_SPEED;
+    if (stored.acceleration != pending.acceleration) dirty |= FIELD_ACCELERATION;
+    if (stored.runCurrent != pending.runCurrent) dirty |= FIELD_CURRENT;
+    if (stored.stallGuardThreshold != pending.stallGuardThreshold) dirty |= FIELD_STALLGUARD_THRESHOLD;
+    if (stored.stallGuardCalibrationMargin != pending.stallGuardCalibrationMargin) dirty |= FIELD_CALIBRATION_MARGIN;
+    if (stored.clockwise != pending.clockwise) dirty |= FIELD_DIRECTION;
+    if (stored.lifetimeMicroSteps != pending.lifetimeMicroSteps) dirty |= FIELD_ODOMETER;
+    if (stored.jerkLimit != pending.jerkLimit) dirty |= FIELD_JERK_LIMIT;
+    return dirty;
+}
+
+void SettingsStore::writeRecord(uint8_t record, const PersistentSettings& settings) {
+    char key[16];
+    getRecordKey(record, key, sizeof(key));
+
+    const uint32_t dirty = calculateDirtyFields(stored[record], settings);
+    const bool extendRecord = preferences.getBytesLength(key) != sizeof(PersistentSettings);
+
+    if (dirty == 0 && !extendRecord) {
+        dbg_println("Settings unchanged - flash write skipped");
+        return;
+    }
+
+    if (preferences.putBytes(key, &settings, sizeof(PersistentSettings)) != sizeof(PersistentSettings)) {
+        dbg_println("Failed to write settings record");
+        return;
+    }
+
+    stored[record] = settings;
+    flashWrites++;
+
+    dbg_printf("Settings %s saved to flash (fields 0x%02x, %u writes for %u save requests)\n",
+               key, dirty, flashWrites.load(), saveRequests.load());
+
+    SystemStatus& systemStatus = SystemStatus::getInstance();
+    systemStatus.publishStatusUpdate(StatusUpdateType::SETTINGS_FLASH_WRITES, flashWrites.load());
+    systemStatus.publishStatusUpdate(StatusUpdateType::SETTINGS_SAVE_REQUESTS, saveRequests.load());
+}
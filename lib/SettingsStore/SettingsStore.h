@@ -0,0 +1,99 @@
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+/**
+ * @file SettingsStore.h
+ * @brief Write-behind persistence of the user settings
+ *
+ * save() only overwrites a one-slot mailbox and never touches flash. The settings task
+ * writes the newest record once no further change arrived for SETTINGS_WRITE_DELAY
+ * (bounded by SETTINGS_MAX_WRITE_DELAY during continuous changes), and only if a field
+ * actually differs from what is already stored. All settings live in one packed NVS
+ * blob, so a write is a single NVS entry instead of one entry per key; NVS itself
+ * appends entries round-robin across its pages, which spreads the wear.
+ *
+ * Each stepper axis has its own record and mailbox; axis 0 keeps the original key.
+ */
+
+#include <Arduino.h>
+#include <atomic>
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include "Task.h"
+#include "SystemStatus.h"
+#include "dbg_print.h"
+
+#define SETTINGS_NAMESPACE "stepper"
+#define SETTINGS_RECORD_KEY "settings"   // Axis 0; further axes append their index ("settings1", ...)
+#define SETTINGS_MAX_RECORDS 4           // One record per stepper axis
+#define SETTINGS_WRITE_DELAY 2000      // Idle time after the last change before writing (ms)
+#define SETTINGS_MAX_WRITE_DELAY 10000 // Write at the latest this long after the first unsaved change (ms)
+
+// Persisted settings record. Fields may only be appended: a shorter record from an older
+// firmware is read into the defaults, leaving the new fields at their default values.
+struct __attribute__((packed)) PersistentSettings {
+    float speedRPM;
+    uint32_t acceleration;
+    uint8_t runCurrent;
+    uint8_t stallGuardThreshold;
+    uint8_t stallGuardCalibrationMargin;
+    bool clockwise;
+    uint64_t lifetimeMicroSteps; // Lifetime odometer (microsteps travelled in either direction)
+    uint32_t jerkLimit;          // S-curve jerk limit in steps/s³, 0 = constant acceleration
+};
+
+class SettingsStore : public Task {
+private:
+    // Dirty set: one bit per PersistentSettings field
+    enum SettingsField : uint32_t {
+        FIELD_SPEED                = 1 << 0,
+        FIELD_ACCELERATION         = 1 << 1,
+        FIELD_CURRENT              = 1 << 2,
+        FIELD_STALLGUARD_THRESHOLD = 1 << 3,
+        FIELD_CALIBRATION_MARGIN   = 1 << 4,
+        FIELD_DIRECTION            = 1 << 5,
+        FIELD_ODOMETER             = 1 << 6,
+        FIELD_JERK_LIMIT           = 1 << 7
+    };
+
+    Preferences preferences;
+    bool preferencesOpen;
+    QueueHandle_t pendingQueues[SETTINGS_MAX_RECORDS]; // One-slot mailboxes holding the newest unsaved records
+    PersistentSettings stored[SETTINGS_MAX_RECORDS];   // Records currently in flash (settings task only after start())
+
+    std::atomic<uint32_t> saveRequests;
+    std::atomic<uint32_t> flashWrites;
+
+    SettingsStore();
+    ~SettingsStore() {}
+    SettingsStore(const SettingsStore&) = delete;
+    SettingsStore& operator=(const SettingsStore&) = delete;
+
+    static uint32_t calculateDirtyFields(const PersistentSettings& stored, const PersistentSettings& pending);
+    static void getRecordKey(uint8_t record, char* key, size_t keySize);
+    void loadLegacyKeys(PersistentSettings& settings);
+    void writeRecord(uint8_t record, const PersistentSettings& settings);
+
+protected:
+    void run() override;
+
+public:
+    // Open storage and load one axis record into settings (which holds the defaults).
+    // Call for every axis before start().
+    bool begin(uint8_t record, PersistentSettings& settings);
+
+    // Queue a record for writing; never blocks and never touches flash. Safe from any task.
+    void save(uint8_t record, const PersistentSettings& settings);
+
+    // Statistics
+    uint32_t getSaveRequestCount() const { return saveRequests.load(); }
+    uint32_t getFlashWriteCount() const { return flashWrites.load(); }
+
+    static SettingsStore& getInstance() {
+        static SettingsStore instance;
+        return instance;
+    }
+};
+
+#endif // SETTINGS_STORE_H
@@ -0,0 +1,110 @@
+#include "RotisserieSimulation.h"
+
+RotisserieSimulation::RotisserieSimulation(const RotisserieParameters& parameters, double timeStep)
+    : parameters(parameters), timeStep(timeStep) {
+    this->parameters.microStepsPerMotorRevolution = STEPS_PER_REVOLUTION * MICRO_STEPS;
+    this->parameters.gearRatio = GEAR_RATIO;
+}
+
+// Same segment programming as StepperController::applySpeedRampStep()
+static void applySpeedRampStep(SCurveRamp& ramp, SimulatedStepperBackend& stepper) {
+    ramp.update(SPEED_RAMP_UPDATE_INTERVAL / 1000.0f);
+    const uint32_t segmentAcceleration = (uint32_t)ceilf(ramp.getStepAcceleration());
+    stepper.setAcceleration(max(segmentAcceleration, 1u));
+    stepper.setSpeedInHz(max((uint32_t)lroundf(ramp.getSpeed()), 1u));
+    stepper.applySpeedAcceleration();
+}
+
+RotisserieStats RotisserieSimulation::run(const SpeedProfileCase& profile, double duration) const {
+    RotisserieModel model(parameters);
+    SimulatedStepperBackend stepper(false);
+
+    uint32_t speedTable[SPEED_TABLE_SIZE];
+    float k, k0;
+    StepperController::calculateSpeedVariationK(profile.strength, k, k0);
+    StepperController::buildSpeedTable(speedTable, profile.setpointRPM, k, k0, profile.phase);
+
+    // Driver resolution: fixed, or the controller's speed band for the fastest table entry.
+    // The step generator runs in driver microsteps, the table and the load model in MICRO_STEPS.
+    uint32_t fastestEntry = 0;
+    for (uint16_t i = 0; i < SPEED_TABLE_SIZE; i++) {
+        fastestEntry = max(fastestEntry, speedTable[i]);
+    }
+    uint16_t microsteps = profile.microsteps;
+    if (microsteps == 0) {
+#if DYNAMIC_MICROSTEPPING
+        microsteps = StepperController::selectMicrosteps(fastestEntry * 60.0f / TOTAL_MICRO_STEPS_PER_REVOLUTION, MICRO_STEPS);
+#else
+        microsteps = MICRO_STEPS;
+#endif
+    }
+    const double pulsesPerStep = (double)microsteps / MICRO_STEPS;
+    for (uint16_t i = 0; i < SPEED_TABLE_SIZE; i++) {
+        speedTable[i] = (uint32_t)(speedTable[i] * pulsesPerStep);
+    }
+
+    SCurveRamp ramp;
+    ramp.setJerk((float)(profile.jerk * pulsesPerStep));
+    ramp.setMaxAcceleration((float)(profile.acceleration * pulsesPerStep));
+    ramp.setTarget((float)speedTable[0]);
+    const uint32_t rampInterval = max((uint32_t)lround(SPEED_RAMP_UPDATE_INTERVAL / 1000.0 / timeStep), 1u);
+    uint32_t ticksToRampUpdate = rampInterval;
+
+    // Same start as the controller: configured acceleration and speed (or the first S-curve
+    // segment from standstill), then run clockwise
+    if (profile.jerk > 0) {
+        applySpeedRampStep(ramp, stepper);
+    } else {
+        stepper.setAcceleration((uint32_t)(profile.acceleration * pulsesPerStep));
+        stepper.setSpeedInHz(speedTable[0]);
+    }
+    stepper.runForward();
+
+    uint16_t lastIndex = 0;
+    bool settled = false;
+    double settledPulses = 0.0;
+    float peakStepRate = 0.0f;
+    for (double time = 0.0; time < duration; time += timeStep) {
+        stepper.step(timeStep);
+
+        const double position = stepper.getPositionSteps() / pulsesPerStep;
+        const uint64_t positionInRevolution = (uint64_t)position % TOTAL_MICRO_STEPS_PER_REVOLUTION;
+        const uint16_t index = (uint16_t)((positionInRevolution * SPEED_TABLE_SIZE) / TOTAL_MICRO_STEPS_PER_REVOLUTION);
+
+        // Position-scheduled speed update when the shaft enters the next segment
+        if (index != lastIndex) {
+            lastIndex = index;
+            if (profile.jerk > 0) {
+                if (ramp.isSettled()) {
+                    ticksToRampUpdate = 1; // The controller wakes its ramp job immediately
+                }
+                ramp.setTarget((float)speedTable[index]);
+            } else {
+                stepper.setSpeedInHz(speedTable[index]);
+                stepper.applySpeedAcceleration();
+            }
+        }
+
+        if (profile.jerk > 0 && !ramp.isSettled() && --ticksToRampUpdate == 0) {
+            applySpeedRampStep(ramp, stepper);
+            ticksToRampUpdate = rampInterval;
+        }
+
+        if (!settled) {
+            settled = position >= TOTAL_MICRO_STEPS_PER_REVOLUTION;
+            settledPulses = stepper.getPositionSteps();
+            continue;
+        }
+        const double stepRate = stepper.getSpeedStepsPerSecond();
+        peakStepRate = fmaxf(peakStepRate, (float)fabs(stepRate));
+        model.addSample(position, stepRate / pulsesPerStep, stepper.getAccelerationStepsPerSecond2() / pulsesPerStep, timeStep);
+    }
+
+    RotisserieStats stats = model.getStats();
+    stats.microsteps = microsteps;
+    stats.peakStepRate = peakStepRate;
+    if (stats.simulatedTime > 0.0) {
+        stats.meanStepRate = (float)((stepper.getPositionSteps() - settledPulses) / stats.simulatedTime);
+    }
+    return stats;
+}
@@ -0,0 +1,52 @@
+#ifndef ROTISSERIE_SIMULATION_H
+#define ROTISSERIE_SIMULATION_H
+
+/**
+ * @file RotisserieSimulation.h
+ * @brief Offline replay of a speed variation profile against the spit load model
+ *
+ * Issues the same speed commands as StepperController's position-scheduled speed
+ * variation (same speed table, new target whenever the shaft enters the next table
+ * segment) to a SimulatedStepperBackend on a fixed time step, and feeds the resulting
+ * motion into a RotisserieModel. With a jerk limit the targets go through the same
+ * SCurveRamp stepping as the controller's speed ramp job. Nothing waits on a clock, so an 8-hour cook takes
+ * well under a second of host time.
+ */
+
+#include <Arduino.h>
+#include "RotisserieModel.h"
+#include "SCurveRamp.h"
+#include "SimulatedStepperBackend.h"
+#include "StepperController.h"
+
+#define ROTISSERIE_SIMULATION_TIME_STEP 0.001 // s, matches the controller's millisecond wakeups
+
+// One point of a benchmark grid
+struct SpeedProfileCase {
+    float setpointRPM;
+    float strength;          // 0-1, as SET_SPEED_VARIATION
+    float phase;             // rad, as SET_SPEED_VARIATION_PHASE
+    uint32_t acceleration;   // steps/s²
+    uint32_t jerk;           // steps/s³, 0 = constant-acceleration ramps (as SET_JERK_LIMIT)
+    uint16_t microsteps;     // Driver resolution, 0 = the controller's speed band for the profile
+
+    SpeedProfileCase(float setpointRPM = 1.0f, float strength = 0.0f, float phase = 0.0f, uint32_t acceleration = 0,
+                     uint32_t jerk = 0, uint16_t microsteps = 0)
+        : setpointRPM(setpointRPM), strength(strength), phase(phase), acceleration(acceleration), jerk(jerk),
+          microsteps(microsteps) {}
+};
+
+class RotisserieSimulation {
+private:
+    RotisserieParameters parameters; // Drive train fixed to the controller's constants
+    const double timeStep;
+
+public:
+    explicit RotisserieSimulation(const RotisserieParameters& parameters, double timeStep = ROTISSERIE_SIMULATION_TIME_STEP);
+
+    // Run one profile for the given simulated time. The start-up ramp and first revolution
+    // are excluded from the statistics so profiles compare in steady state.
+    RotisserieStats run(const SpeedProfileCase& profile, double duration) const;
+};
+
+#endif // ROTISSERIE_SIMULATION_H
@@ -0,0 +1,100 @@
+#include "SimulatedDriverBackend.h"
+#include <math.h>
+
+SimulatedDriverBackend::SimulatedDriverBackend(SimulatedStepperBackend& stepper, const RotisserieParameters& load)
+    : stepper(stepper), load(load),
+      stealthChop(false), automaticPwm(false), runCurrent(0), microsteps(0), enabled(false),
+      coolStepDurationThreshold(0), stallGuardThreshold(0), velocity(0),
+      appliedMicrosteps(0), appliedVelocity(0), shaftOrigin(0.0), pulseOrigin(0.0), velocityOriginUs(0),
+      noiseState(SIM_NOISE_SEED), diagnostics() {
+}
+
+bool SimulatedDriverBackend::begin() {
+    diagnostics.communicating = true;
+    return true;
+}
+
+void SimulatedDriverBackend::applyRegisters() {
+    if (microsteps != appliedMicrosteps || velocity != appliedVelocity) {
+        // MRES and VACTUAL take effect from the current shaft position on
+        shaftOrigin = getShaftPosition();
+        pulseOrigin = stepper.getPositionSteps();
+        velocityOriginUs = micros();
+        if (microsteps != appliedMicrosteps) {
+            diagnostics.appliedMicrosteps = microsteps; // Acknowledged at once - there is no bus
+            diagnostics.microstepsAppliedUs = velocityOriginUs;
+        }
+        appliedMicrosteps = microsteps;
+        appliedVelocity = velocity;
+        diagnostics.appliedVelocity = velocity;
+    }
+    diagnostics.registerWriteCount++;
+}
+
+double SimulatedDriverBackend::getModelStepsPerPulse() const {
+    if (appliedMicrosteps == 0) {
+        return 1.0; // Not configured yet - pulses count as model microsteps
+    }
+    return load.getParameters().microStepsPerMotorRevolution / (SIM_MOTOR_FULL_STEPS * (double)appliedMicrosteps);
+}
+
+double SimulatedDriverBackend::getShaftPosition() const {
+    if (appliedVelocity != 0) {
+        const double seconds = (uint32_t)(micros() - velocityOriginUs) / 1000000.0;
+        return shaftOrigin + appliedVelocity * (SIM_DRIVER_CLOCK_HZ / 16777216.0) * seconds * getModelStepsPerPulse();
+    }
+    return shaftOrigin + (stepper.getPositionSteps() - pulseOrigin) * getModelStepsPerPulse();
+}
+
+double SimulatedDriverBackend::getMicrostepRate() {
+    if (appliedVelocity != 0) {
+        return appliedVelocity * (SIM_DRIVER_CLOCK_HZ / 16777216.0); // VACTUAL is in microsteps per 2^24 clocks
+    }
+    return stepper.getSpeedStepsPerSecond();
+}
+
+double SimulatedDriverBackend::getMicrostepAcceleration() {
+    return appliedVelocity != 0 ? 0.0 : stepper.getAccelerationStepsPerSecond2();
+}
+
+int32_t SimulatedDriverBackend::nextNoise() {
+    // xorshift32 - fixed seed, same sequence every run
+    noiseState ^= noiseState << 13;
+    noiseState ^= noiseState >> 17;
+    noiseState ^= noiseState << 5;
+    return (int32_t)(noiseState % (2 * SIM_SG_NOISE + 1)) - SIM_SG_NOISE;
+}
+
+uint16_t SimulatedDriverBackend::sampleStallGuardResult() {
+    // No back-EMF reading at standstill or with the bridges off
+    const double speed = getMicrostepRate() * getModelStepsPerPulse();
+    if (!enabled || speed == 0.0) {
+        return 0;
+    }
+
+    const uint16_t result = load.calculateStallGuardResult(getShaftPosition(), speed,
+                                                           getMicrostepAcceleration() * getModelStepsPerPulse());
+    return (uint16_t)constrain((int32_t)result + nextNoise(), (int32_t)0, (int32_t)SIM_SG_MAX);
+}
+
+void SimulatedDriverBackend::requestStallGuardSample(uint8_t tag) {
+    // Completes immediately - there is no bus to wait for
+    diagnostics.sampleStallGuardResult = sampleStallGuardResult();
+    diagnostics.sampleTag = tag;
+    diagnostics.sampleSequence++;
+}
+
+const DriverDiagnostics& SimulatedDriverBackend::getDiagnostics() {
+    diagnostics.stallGuardResult = sampleStallGuardResult();
+    diagnostics.lastUpdateMs = millis();
+    return diagnostics;
+}
+
+bool SimulatedDriverBackend::isStallDetected() {
+    // DIAG is only driven while TSTEP (time per 1/256 microstep) is below TCOOLTHRS
+    const double stepRate = fabs(getMicrostepRate()) * (256.0 / (appliedMicrosteps ? appliedMicrosteps : 256));
+    if (!enabled || stepRate == 0.0 || SIM_DRIVER_CLOCK_HZ / stepRate >= coolStepDurationThreshold) {
+        return false;
+    }
+    return sampleStallGuardResult() <= 2 * stallGuardThreshold;
+}
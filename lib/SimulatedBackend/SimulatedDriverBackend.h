@@ -0,0 +1,93 @@
+#ifndef SIMULATED_DRIVER_BACKEND_H
+#define SIMULATED_DRIVER_BACKEND_H
+
+/**
+ * @file SimulatedDriverBackend.h
+ * @brief Software TMC2209 for host builds and tests
+ *
+ * Keeps the register values the controller sets and synthesizes SG_RESULT from the
+ * RotisserieModel of the spit, evaluated for the motion of the simulated stepper and the
+ * configured run current. The StallGuard comparison and DIAG output follow the
+ * TMC2209 rule (stall while SG_RESULT <= 2 * SGTHRS, DIAG only above the TCOOLTHRS
+ * velocity). Noise comes from a fixed-seed
+ * generator, so a run is reproducible.
+ *
+ * Step pulses are turned into shaft motion at the applied microstep resolution; a resolution
+ * change keeps the shaft where it is, like MRES changes on the real driver. A non-zero VACTUAL
+ * moves the shaft at that velocity (from micros()) and the step pulses are ignored meanwhile.
+ */
+
+#include <Arduino.h>
+#include "IDriverBackend.h"
+#include "SimulatedStepperBackend.h"
+#include "RotisserieModel.h"
+
+// SG_RESULT = stallGuardGain * |motor rad/s| * (1 - |torque| / pull-out torque) from the
+// RotisserieModel, plus noise, clamped to SIM_SG_MAX. Like the TMC2209's back-EMF based reading
+// it rises with velocity (20 per rad/s: ~100 at 5 RPM spit speed, saturated above ~25 RPM) and
+// drops towards 0 as the load nears stall; it is 0 at standstill.
+#define SIM_SG_NOISE 4              // Peak SG_RESULT noise (counts)
+#define SIM_SG_MAX 510
+#define SIM_DRIVER_CLOCK_HZ 12000000 // TSTEP time base
+#define SIM_NOISE_SEED 0x2545F491u
+#define SIM_MOTOR_FULL_STEPS 200     // 1.8° motor - converts step pulses to the load model's microsteps
+
+class SimulatedDriverBackend : public IDriverBackend {
+private:
+    SimulatedStepperBackend& stepper;
+    RotisserieModel load;
+
+    // Register values
+    bool stealthChop;
+    bool automaticPwm;
+    uint8_t runCurrent;
+    uint16_t microsteps;
+    bool enabled;
+    uint32_t coolStepDurationThreshold;
+    uint8_t stallGuardThreshold;
+    int32_t velocity;
+
+    // Shaft position in load model microsteps: origin plus the step pulses (or the VACTUAL motion)
+    // since the last MRES or VACTUAL change
+    uint16_t appliedMicrosteps;
+    int32_t appliedVelocity;
+    double shaftOrigin;
+    double pulseOrigin;
+    uint32_t velocityOriginUs;
+
+    uint32_t noiseState;
+    DriverDiagnostics diagnostics;
+
+    uint16_t sampleStallGuardResult(); // SG_RESULT for the current shaft angle and load
+    int32_t nextNoise();
+    double getModelStepsPerPulse() const;
+    double getShaftPosition() const;
+    double getMicrostepRate();         // Signed, at the applied resolution (step pulses or VACTUAL)
+    double getMicrostepAcceleration(); // 0 under VACTUAL (velocity steps between register writes)
+
+public:
+    SimulatedDriverBackend(SimulatedStepperBackend& stepper, const RotisserieParameters& load);
+
+    bool begin() override;
+
+    void setStealthChop(bool value) override { stealthChop = value; }
+    void setAutomaticPwm(bool value) override { automaticPwm = value; }
+    void setRunCurrent(uint8_t percent) override {
+        runCurrent = percent;
+        load.setRunCurrent(percent / 100.0f);
+    }
+    void setMicrostepsPerStep(uint16_t value) override { microsteps = value; }
+    void setEnabled(bool value) override { enabled = value; }
+    void setCoolStepDurationThreshold(uint32_t threshold) override { coolStepDurationThreshold = threshold; }
+    void setStallGuardThreshold(uint8_t threshold) override { stallGuardThreshold = threshold; }
+    void setVelocity(int32_t vactual) override { velocity = vactual; }
+    void markAllDirty() override {}
+    void applyRegisters() override;
+
+    void requestStallGuardSample(uint8_t tag) override;
+    const DriverDiagnostics& getDiagnostics() override;
+
+    bool isStallDetected() override;
+};
+
+#endif // SIMULATED_DRIVER_BACKEND_H
@@ -0,0 +1,133 @@
+#include "SimulatedStepperBackend.h"
+#include <math.h>
+
+SimulatedStepperBackend::SimulatedStepperBackend(bool followClock)
+    : position(0.0), speed(0.0), targetSpeed(0.0), speedHz(0), acceleration(0),
+      direction(0), running(false), followClock(followClock), lastUpdateUs(0) {
+}
+
+bool SimulatedStepperBackend::begin() {
+    lastUpdateUs = micros();
+    return true;
+}
+
+void SimulatedStepperBackend::integrate(double dt) {
+    if (dt <= 0.0 || !running) {
+        return;
+    }
+
+    const double delta = targetSpeed - speed;
+    if (acceleration == 0 || delta == 0.0) {
+        // No ramp configured (FastAccelStepper would refuse to move) or already at speed
+        if (acceleration == 0) {
+            speed = targetSpeed;
+        }
+        position += speed * dt;
+    } else {
+        // Constant acceleration until the target speed is reached, then constant speed
+        const double a = delta > 0.0 ? (double)acceleration : -(double)acceleration;
+        const double rampTime = delta / a;
+        const double t = rampTime < dt ? rampTime : dt;
+        position += speed * t + 0.5 * a * t * t;
+        speed += a * t;
+        if (t < dt) {
+            speed = targetSpeed;
+            position += speed * (dt - t);
+        }
+    }
+
+    if (direction == 0 && speed == 0.0) {
+        running = false;
+    }
+}
+
+void SimulatedStepperBackend::advance() {
+    if (!followClock) {
+        return;
+    }
+    const uint32_t now = micros();
+    const uint32_t elapsedUs = now - lastUpdateUs;
+    lastUpdateUs = now;
+    integrate(elapsedUs * 1e-6);
+}
+
+void SimulatedStepperBackend::setSpeedInHz(uint32_t stepsPerSecond) {
+    speedHz = stepsPerSecond;
+}
+
+void SimulatedStepperBackend::setAcceleration(uint32_t stepsPerSecond2) {
+    acceleration = stepsPerSecond2;
+}
+
+void SimulatedStepperBackend::applySpeedAcceleration() {
+    advance();
+    if (direction != 0) {
+        targetSpeed = direction * (double)speedHz;
+    }
+}
+
+void SimulatedStepperBackend::runForward() {
+    advance();
+    direction = 1;
+    targetSpeed = (double)speedHz;
+    running = true;
+}
+
+void SimulatedStepperBackend::runBackward() {
+    advance();
+    direction = -1;
+    targetSpeed = -(double)speedHz;
+    running = true;
+}
+
+void SimulatedStepperBackend::stopMove() {
+    advance();
+    direction = 0;
+    targetSpeed = 0.0;
+    if (speed == 0.0) {
+        running = false;
+    }
+}
+
+void SimulatedStepperBackend::forceStopAndNewPosition(int32_t newPosition) {
+    advance();
+    direction = 0;
+    targetSpeed = 0.0;
+    speed = 0.0;
+    running = false;
+    position = newPosition;
+}
+
+bool SimulatedStepperBackend::isRunning() {
+    advance();
+    return running;
+}
+
+int32_t SimulatedStepperBackend::getCurrentPosition() {
+    advance();
+    // Wrap like the 32-bit hardware position counter
+    return (int32_t)(uint32_t)(uint64_t)(int64_t)floor(position);
+}
+
+int32_t SimulatedStepperBackend::getCurrentSpeedInMilliHz() {
+    advance();
+    return (int32_t)lround(speed * 1000.0);
+}
+
+double SimulatedStepperBackend::getPositionSteps() {
+    advance();
+    return position;
+}
+
+double SimulatedStepperBackend::getSpeedStepsPerSecond() {
+    advance();
+    return speed;
+}
+
+double SimulatedStepperBackend::getAccelerationStepsPerSecond2() {
+    advance();
+    if (!running || acceleration == 0 || speed == targetSpeed) {
+        return 0.0;
+    }
+    return targetSpeed > speed ? (double)acceleration : -(double)acceleration;
+}
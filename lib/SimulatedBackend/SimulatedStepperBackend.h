@@ -0,0 +1,60 @@
+#ifndef SIMULATED_STEPPER_BACKEND_H
+#define SIMULATED_STEPPER_BACKEND_H
+
+/**
+ * @file SimulatedStepperBackend.h
+ * @brief Software step generator for host builds and tests
+ *
+ * Models a FastAccelStepper ramp generator: the speed approaches the target with the
+ * configured acceleration (constant acceleration, exact integration between calls) and
+ * the position is integrated from it. State is advanced lazily from micros() whenever
+ * it is queried, so the model is deterministic for a given call sequence and clock.
+ * Offline simulations construct it with followClock = false and advance time with step().
+ */
+
+#include <Arduino.h>
+#include "IStepperBackend.h"
+
+class SimulatedStepperBackend : public IStepperBackend {
+private:
+    double position;        // Microsteps, not wrapped
+    double speed;           // Signed steps/s
+    double targetSpeed;     // Signed steps/s the ramp is heading to
+    uint32_t speedHz;       // Configured speed (unsigned, steps/s)
+    uint32_t acceleration;  // Configured acceleration (steps/s²)
+    int8_t direction;       // +1 forward, -1 backward, 0 stopping/stopped
+    bool running;
+    const bool followClock; // Advance from micros() (false: only step() moves time)
+    uint32_t lastUpdateUs;
+
+    void advance();         // Integrate up to micros()
+    void integrate(double dt);
+
+public:
+    explicit SimulatedStepperBackend(bool followClock = true);
+
+    bool begin() override;
+
+    void setSpeedInHz(uint32_t stepsPerSecond) override;
+    void setAcceleration(uint32_t stepsPerSecond2) override;
+    void applySpeedAcceleration() override;
+
+    void runForward() override;
+    void runBackward() override;
+    void stopMove() override;
+    void forceStopAndNewPosition(int32_t newPosition) override;
+
+    bool isRunning() override;
+    int32_t getCurrentPosition() override;
+    int32_t getCurrentSpeedInMilliHz() override;
+
+    // Unwrapped position, speed and acceleration for the simulated driver and load model
+    double getPositionSteps();
+    double getSpeedStepsPerSecond();
+    double getAccelerationStepsPerSecond2(); // Signed, 0 at constant speed
+
+    // Advance an offline (followClock = false) simulation; the ramp is integrated exactly
+    void step(double seconds) { integrate(seconds); }
+};
+
+#endif // SIMULATED_STEPPER_BACKEND_H
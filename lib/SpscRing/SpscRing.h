@@ -0,0 +1,122 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+/**
+ * @file SpscRing.h
+ * @brief Lock-free single-producer/single-consumer ring buffer with task notification wakeup
+ *
+ * head (next slot to read, written by the consumer) and tail (next slot to write, written by the
+ * producer) are free-running counters on separate cache lines, next to the other side's index as
+ * last seen. A push or pop only reads the shared index of the other side when its cached copy
+ * says the ring is full or empty, so the two tasks do not bounce one line back and forth on every
+ * item. No side ever takes a lock or enters a critical section; the same std::atomic code runs on
+ * the target and in the host build.
+ *
+ * A consumer that wants to sleep registers its task with setConsumerTask(); every push then gives
+ * it a task notification (xTaskNotifyGive). Notifications count, so a push that happens between
+ * an empty pop and ulTaskNotifyTake() is never lost. Without a registered task the consumer
+ * polls. Capacity must be a power of two.
+ */
+
+#include <atomic>
+#include <stdint.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#ifndef SPSC_RING_CACHE_LINE
+#if defined(ESP_PLATFORM)
+#define SPSC_RING_CACHE_LINE 32 // ESP32-S3 data cache line (PSRAM; internal SRAM is not cached)
+#else
+#define SPSC_RING_CACHE_LINE 64
+#endif
+#endif
+
+template <typename T, uint32_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+private:
+    static const uint32_t INDEX_MASK = Capacity - 1;
+
+    // Consumer-owned line
+    alignas(SPSC_RING_CACHE_LINE) std::atomic<uint32_t> head;
+    uint32_t cachedTail;                     // Consumer's last view of tail
+
+    // Producer-owned line (consumerTask is written once and then only read by the producer)
+    alignas(SPSC_RING_CACHE_LINE) std::atomic<uint32_t> tail;
+    uint32_t cachedHead;                     // Producer's last view of head
+    std::atomic<TaskHandle_t> consumerTask;
+
+    alignas(SPSC_RING_CACHE_LINE) T slots[Capacity];
+
+public:
+    SpscRing() : head(0), cachedTail(0), tail(0), cachedHead(0), consumerTask(nullptr), slots() {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer side: false if the ring is full (the value is not stored)
+    bool push(const T& value) {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == Capacity) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == Capacity) {
+                return false;
+            }
+        }
+        slots[t & INDEX_MASK] = value;
+        tail.store(t + 1, std::memory_order_release);
+        wakeConsumer();
+        return true;
+    }
+
+    // Consumer side: false if the ring is empty
+    bool pop(T& value) {
+        const uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) {
+                return false;
+            }
+        }
+        value = slots[h & INDEX_MASK];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: wait up to timeout for an item (needs the calling task registered as consumer)
+    bool pop(T& value, TickType_t timeout) {
+        const TickType_t start = xTaskGetTickCount();
+        while (!pop(value)) {
+            const TickType_t elapsed = xTaskGetTickCount() - start;
+            if (timeout != portMAX_DELAY && elapsed >= timeout) {
+                return false;
+            }
+            ulTaskNotifyTake(pdTRUE, timeout == portMAX_DELAY ? portMAX_DELAY : timeout - elapsed);
+        }
+        return true;
+    }
+
+    // Task notified on every push (nullptr = polling consumer)
+    void setConsumerTask(TaskHandle_t task) { consumerTask.store(task, std::memory_order_release); }
+    TaskHandle_t getConsumerTask() const { return consumerTask.load(std::memory_order_acquire); }
+
+    // Wake the registered consumer, e.g. for an item that arrived on another path
+    void wakeConsumer() {
+        TaskHandle_t task = consumerTask.load(std::memory_order_acquire);
+        if (task != nullptr) {
+            xTaskNotifyGive(task);
+        }
+    }
+
+    // Items waiting (a snapshot while the other side keeps running)
+    uint32_t size() const {
+        const uint32_t h = head.load(std::memory_order_acquire); // Before tail, so tail - h never wraps
+        return tail.load(std::memory_order_acquire) - h;
+    }
+
+    bool empty() const { return size() == 0; }
+    static constexpr uint32_t capacity() { return Capacity; }
+};
+
+#endif // SPSC_RING_H
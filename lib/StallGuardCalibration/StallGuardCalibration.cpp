@@ -0,0 +1,67 @@
+#include "StallGuardCalibration.h"
+
+StallGuardCalibration::StallGuardCalibration() {
+    reset();
+}
+
+void StallGuardCalibration::reset() {
+    memset(histogram, 0, sizeof(histogram));
+    sampleCount = 0;
+    sampleSum = 0;
+    minValue = UINT16_MAX;
+    maxValue = 0;
+}
+
+void StallGuardCalibration::addSample(uint16_t stallGuardResult) {
+    const uint16_t bin = min<uint16_t>(stallGuardResult / SG_CALIBRATION_BIN_WIDTH, SG_CALIBRATION_HISTOGRAM_BINS - 1);
+    if (histogram[bin] < UINT16_MAX) {
+        histogram[bin]++;
+    }
+
+    sampleCount++;
+    sampleSum += stallGuardResult;
+    minValue = min(minValue, stallGuardResult);
+    maxValue = max(maxValue, stallGuardResult);
+}
+
+uint16_t StallGuardCalibration::getMean() const {
+    if (sampleCount == 0) return 0;
+    return static_cast<uint16_t>((sampleSum + sampleCount / 2) / sampleCount);
+}
+
+uint16_t StallGuardCalibration::getPercentile(uint8_t percent) const {
+    if (sampleCount == 0) return 0;
+
+    // Smallest bin whose cumulative count reaches the requested rank
+    const uint32_t rank = max<uint32_t>(1, (sampleCount * percent + 99) / 100);
+    uint32_t cumulative = 0;
+
+    for (uint16_t bin = 0; bin < SG_CALIBRATION_HISTOGRAM_BINS; bin++) {
+        cumulative += histogram[bin];
+        if (cumulative >= rank) {
+            // Report the bin centre, clamped to the exact extremes
+            const uint16_t centre = bin * SG_CALIBRATION_BIN_WIDTH + SG_CALIBRATION_BIN_WIDTH / 2;
+            return constrain(centre, minValue, maxValue);
+        }
+    }
+
+    return maxValue;
+}
+
+uint32_t StallGuardCalibration::getReportBucket(uint8_t bucket) const {
+    const uint8_t binsPerBucket = SG_CALIBRATION_HISTOGRAM_BINS / SG_CALIBRATION_REPORT_BUCKETS;
+    uint32_t count = 0;
+
+    for (uint8_t i = 0; i < binsPerBucket; i++) {
+        count += histogram[bucket * binsPerBucket + i];
+    }
+    return count;
+}
+
+uint8_t StallGuardCalibration::calculateThreshold(uint8_t marginPercent) const {
+    if (sampleCount == 0) return 0;
+
+    // Stall when SG_RESULT <= 2 * SGTHRS: trip at (100 - margin)% of the lowest load-free reading
+    const uint32_t tripLevel = static_cast<uint32_t>(getMin()) * (100 - min<uint8_t>(marginPercent, 100)) / 100;
+    return static_cast<uint8_t>(min<uint32_t>(tripLevel / 2, 255));
+}
@@ -0,0 +1,44 @@
+#ifndef STALLGUARD_CALIBRATION_H
+#define STALLGUARD_CALIBRATION_H
+
+/**
+ * @file StallGuardCalibration.h
+ * @brief SG_RESULT statistics and SGTHRS derivation for the threshold calibration run
+ *
+ * Samples are collected into a fixed histogram (no heap, constant time per sample).
+ * The TMC2209 signals a stall when SG_RESULT <= 2 * SGTHRS, so the threshold is placed
+ * a configurable margin below the lowest SG_RESULT seen during normal running.
+ */
+
+#include <Arduino.h>
+
+#define SG_CALIBRATION_HISTOGRAM_BINS 128 // SG_RESULT 0-511 in steps of 4
+#define SG_CALIBRATION_BIN_WIDTH 4
+#define SG_CALIBRATION_REPORT_BUCKETS 16   // Coarse histogram in the report (32 SG units per bucket)
+
+class StallGuardCalibration {
+private:
+    uint16_t histogram[SG_CALIBRATION_HISTOGRAM_BINS];
+    uint32_t sampleCount;
+    uint32_t sampleSum;
+    uint16_t minValue;
+    uint16_t maxValue;
+
+public:
+    StallGuardCalibration();
+
+    void reset();
+    void addSample(uint16_t stallGuardResult);
+
+    uint32_t getSampleCount() const { return sampleCount; }
+    uint16_t getMin() const { return sampleCount ? minValue : 0; }
+    uint16_t getMax() const { return maxValue; }
+    uint16_t getMean() const;
+    uint16_t getPercentile(uint8_t percent) const;            // Resolution SG_CALIBRATION_BIN_WIDTH
+    uint32_t getReportBucket(uint8_t bucket) const;           // Samples in 1 of SG_CALIBRATION_REPORT_BUCKETS
+
+    // SGTHRS that trips marginPercent below the lowest observed SG_RESULT
+    uint8_t calculateThreshold(uint8_t marginPercent) const;
+};
+
+#endif // STALLGUARD_CALIBRATION_H
@@ -13,7 +13,13 @@ void StepperController::applyStepperSetpointSpeed(float rpm)
 
     setpointRPM = rpm;
 
-    systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_SETPOINT_CHANGED, rpm);
+    // Setpoint is baked into the speed table
+    updateSpeedVariationParameters();
+
+    // SG_RESULT scales with speed - samples from before the change would read as load ripple
+    resetLoadMap();
+
+    publishStatus(StatusUpdateType::SPEED_SETPOINT_CHANGED, rpm);
 }
 
 void StepperController::applyStepperAcceleration(uint32_t accelerationStepsPerSec2)
@@ -27,7 +33,7 @@ void StepperController::applyStepperAcceleration(uint32_t accelerationStepsPerSe
 
     setpointAcceleration = accelerationStepsPerSec2;
 
-    systemStatus.publishStatusUpdate(StatusUpdateType::ACCELERATION_CHANGED, accelerationStepsPerSec2);
+    publishStatus(StatusUpdateType::ACCELERATION_CHANGED, accelerationStepsPerSec2);
 }
 
 void StepperController::applyRunClockwise()
@@ -51,16 +57,23 @@ void StepperController::applyRunClockwise()
 
     if (!motorEnabled)
     {
-        publishTMC2209Communication();
-        stepperDriver.enable();
+        driver.setEnabled(true);
+        applyDriverRegisters();
         motorEnabled = true;
-        systemStatus.publishStatusUpdate(StatusUpdateType::ENABLED_CHANGED, true);
+        publishStatus(StatusUpdateType::ENABLED_CHANGED, true);
+    }
+
+    if (!clockwise)
+    {
+        resetLoadMap(); // Gravity helps and resists on opposite sides when reversing
     }
 
+    prepareSpeedRamp(!clockwise);
     stepper->runForward(); // In FastAccelStepper, backward means clockwise
+    wakeStepperBackend();
     clockwise = true;
 
-    systemStatus.publishStatusUpdate(StatusUpdateType::DIRECTION_CHANGED, clockwise);
+    publishStatus(StatusUpdateType::DIRECTION_CHANGED, clockwise);
 }
 
 void StepperController::applyRunCounterClockwise()
@@ -84,16 +97,23 @@ void StepperController::applyRunCounterClockwise()
 
     if (!motorEnabled)
     {
-        stepperDriver.enable();
-        publishTMC2209Communication();
+        driver.setEnabled(true);
+        applyDriverRegisters();
         motorEnabled = true;
-        systemStatus.publishStatusUpdate(StatusUpdateType::ENABLED_CHANGED, true);
+        publishStatus(StatusUpdateType::ENABLED_CHANGED, true);
+    }
+
+    if (clockwise)
+    {
+        resetLoadMap(); // Gravity helps and resists on opposite sides when reversing
     }
 
+    prepareSpeedRamp(clockwise);
     stepper->runBackward(); // In FastAccelStepper, backward means counter-clockwise
+    wakeStepperBackend();
     clockwise = false;
 
-    systemStatus.publishStatusUpdate(StatusUpdateType::DIRECTION_CHANGED, clockwise);
+    publishStatus(StatusUpdateType::DIRECTION_CHANGED, clockwise);
 }
 
 void StepperController::applyStop()
@@ -104,11 +124,20 @@ void StepperController::applyStop()
         return;
     }
 
+    if (jerkLimit > 0)
+    {
+        // The S-curve leaves small segment accelerations behind - stop with the full setpoint
+        setEngineAcceleration(static_cast<uint32_t>(speedRamp.getMaxAcceleration()));
+        speedRamp.reset(0.0f);
+    }
     stepper->stopMove();
+    wakeStepperBackend();
     motorEnabled = false;
-    publishTMC2209Communication();
 
-    systemStatus.publishStatusUpdate(StatusUpdateType::ENABLED_CHANGED, false);
+    // Persist the odometer whenever the motor stops (write-behind, coalesced by the settings task)
+    saveOdometer();
+
+    publishStatus(StatusUpdateType::ENABLED_CHANGED, false);
 }
 
 void StepperController::applyCurrent(uint8_t current)
@@ -119,7 +148,6 @@ void StepperController::applyCurrent(uint8_t current)
         return;
     }
 
-    publishTMC2209Communication();
     if (!tmc2209Initialized)
     {
         dbg_println("ERROR: TMC2209 driver not initialized - cannot set current");
@@ -127,28 +155,67 @@ void StepperController::applyCurrent(uint8_t current)
     }
 
     runCurrent = current;
-    stepperDriver.setRunCurrent(current);
+    driver.setRunCurrent(current);
+    applyDriverRegisters();
 
-    systemStatus.publishStatusUpdate(StatusUpdateType::CURRENT_CHANGED, current);
+    publishStatus(StatusUpdateType::CURRENT_CHANGED, current);
 }
 
-void StepperController::publishTMC2209Communication()
+void StepperController::notify(NotificationType type, const String &message)
 {
-    bool isCommunicating = stepperDriver.isSetupAndCommunicating();
+    if (processingCommand)
+    {
+        if (type == NotificationType::ERROR)
+        {
+            commandResult = CommandResult::REJECTED;
+        }
+        else if (commandResult == CommandResult::OK)
+        {
+            commandResult = CommandResult::ADJUSTED;
+        }
+    }
 
-    if (!isCommunicating)
+    if (axis == 0)
     {
-        tmc2209Initialized = false;
-        systemStatus.publishStatusUpdate(StatusUpdateType::TMC2209_STATUS_UPDATE, false);
-        systemStatus.sendNotification(NotificationType::ERROR, "TMC2209 driver not initialized or not communicating");
+        systemStatus.sendNotification(type, message);
+        return;
     }
-    else
+
+    // Tell the user which skewer the message is about
+    char prefixed[sizeof(NotificationData::message)];
+    snprintf(prefixed, sizeof(prefixed), "%s: %s", config.name, message.c_str());
+    systemStatus.sendNotification(type, String(prefixed));
+}
+
+void StepperController::applyDriverRegisters()
+{
+    // The write itself happens in the driver backend; communication failures show up in its next snapshot
+    driver.applyRegisters();
+}
+
+void StepperController::refreshDriverDiagnostics()
+{
+    const bool isCommunicating = driver.getDiagnostics().communicating;
+
+    // Only report transitions here - periodic status comes from publishTMC2209Communication()
+    if (isCommunicating != tmc2209Initialized)
     {
-        tmc2209Initialized = true;
-        systemStatus.publishStatusUpdate(StatusUpdateType::TMC2209_STATUS_UPDATE, true);
+        tmc2209Initialized = isCommunicating;
+        publishStatus(StatusUpdateType::TMC2209_STATUS_UPDATE, tmc2209Initialized);
+        if (!tmc2209Initialized)
+        {
+            notify(NotificationType::ERROR, "TMC2209 driver not initialized or not communicating");
+        }
     }
 }
 
+void StepperController::publishTMC2209Communication()
+{
+    // Communication is checked by the driver I/O task - this only reads its snapshot
+    refreshDriverDiagnostics();
+    publishStatus(StatusUpdateType::TMC2209_STATUS_UPDATE, tmc2209Initialized);
+}
+
 void StepperController::publishTMC2209Temperature()
 {
     if (!tmc2209Initialized)
@@ -157,8 +224,8 @@ void StepperController::publishTMC2209Temperature()
         return;
     }
 
-    // Read TMC2209 status which includes temperature information
-    TMC2209::Status status = stepperDriver.getStatus();
+    // TMC2209 status (read by the driver backend) includes temperature information
+    const DriverStatus status = driver.getDiagnostics().status;
 
     // Determine temperature status based on warning flags
     // Temperature ranges: normal < 120°C < warning < 143°C < critical < 150°C < shutdown < 157°C
@@ -182,18 +249,15 @@ void StepperController::publishTMC2209Temperature()
     }
 
     // Publish temperature status update
-    systemStatus.publishStatusUpdate(StatusUpdateType::TMC2209_TEMPERATURE_UPDATE, temperatureStatus);
+    publishStatus(StatusUpdateType::TMC2209_TEMPERATURE_UPDATE, temperatureStatus);
 
-    // Track last temperature status to avoid duplicate notifications
-    static int lastTemperatureStatus = -1;
-    static bool lastOverTemperatureShutdown = false;
-    
+    // lastTemperatureStatus/lastOverTemperatureShutdown avoid duplicate notifications
     // Handle over-temperature shutdown notifications (separate from temperature warnings)
     if (status.over_temperature_shutdown && !lastOverTemperatureShutdown)
     {
         // New shutdown condition detected
         lastOverTemperatureShutdown = true;
-        systemStatus.sendNotification(NotificationType::ERROR, "TMC2209 over-temperature shutdown! Driver disabled for safety.");
+        notify(NotificationType::ERROR, "TMC2209 over-temperature shutdown! Driver disabled for safety.");
     }
     else if (!status.over_temperature_shutdown && lastOverTemperatureShutdown)
     {
@@ -211,15 +275,15 @@ void StepperController::publishTMC2209Temperature()
         {
             if (temperatureStatus == 4)
             {
-                systemStatus.sendNotification(NotificationType::ERROR, "TMC2209 critical temperature (>157°C)! Reduce current or improve cooling.");
+                notify(NotificationType::ERROR, "TMC2209 critical temperature (>157°C)! Reduce current or improve cooling.");
             }
             else if (temperatureStatus == 3)
             {
-                systemStatus.sendNotification(NotificationType::WARNING, "TMC2209 high temperature (>150°C). Consider reducing current.");
+                notify(NotificationType::WARNING, "TMC2209 high temperature (>150°C). Consider reducing current.");
             }
             else if (temperatureStatus == 2)
             {
-                systemStatus.sendNotification(NotificationType::WARNING, "TMC2209 elevated temperature (>143°C). Monitor thermal conditions.");
+                notify(NotificationType::WARNING, "TMC2209 elevated temperature (>143°C). Monitor thermal conditions.");
             }
         }
     }
@@ -236,8 +300,7 @@ void StepperController::publishTMC2209Temperature()
 
 void StepperController::publishStallDetection()
 {
-    publishTMC2209Communication();
-
+    // Communication state is tracked by the register cache - no UART probe needed here
     if (!tmc2209Initialized)
     {
         dbg_println("WARNING: Cannot check stall detection - TMC2209 not initialized");
@@ -245,7 +308,7 @@ void StepperController::publishStallDetection()
     }
 
     // Update stall detection state efficiently
-    const bool diagPinHigh = digitalRead(DIAG_PIN);
+    const bool diagPinHigh = driver.isStallDetected();
 
     if (motorEnabled)
     {
@@ -254,11 +317,10 @@ void StepperController::publishStallDetection()
             // New stall detected
             stallDetected = true;
             stallCount++;
-            static uint32_t lastStallTime = millis();
-            if (millis() - lastStallTime > 1000)
+            if (millis() - lastStallNotificationTime > 1000)
             { // Only notify once per second
-                lastStallTime = millis();
-                systemStatus.sendNotification(NotificationType::WARNING, "Stall detected! Check motor load or settings.");
+                lastStallNotificationTime = millis();
+                notify(NotificationType::WARNING, "Stall detected! Check motor load or settings.");
             }
             dbg_printf("STALL DETECTED! Count: %d, Time: %lu\n", stallCount, millis());
             dbg_println("Consider: reducing speed, increasing current, or checking load");
@@ -278,24 +340,21 @@ void StepperController::publishStallDetection()
     }
 
     // Publish stall status update
-    systemStatus.publishStatusUpdate(StatusUpdateType::STALL_DETECTED_UPDATE, stallDetected);
-    systemStatus.publishStatusUpdate(StatusUpdateType::STALL_COUNT_UPDATE, static_cast<int>(stallCount));
+    publishStatus(StatusUpdateType::STALL_DETECTED_UPDATE, stallDetected);
+    publishStatus(StatusUpdateType::STALL_COUNT_UPDATE, static_cast<int>(stallCount));
 }
 
-void StepperController::publishCurrentRPM()
+float StepperController::calculateCurrentRPM() const
 {
     if (!stepper)
     {
-        systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_UPDATE, 0.0f);
-        return;
+        return 0.0f;
     }
 
-    float currentStepsPerSecond = static_cast<float>(abs(stepper->getCurrentSpeedInMilliHz() / 1000));
-
-    float rpm = (currentStepsPerSecond * 60.0f) /
-                (static_cast<float>(GEAR_RATIO) * static_cast<float>(STEPS_PER_REVOLUTION) * static_cast<float>(MICRO_STEPS));
+    float currentStepsPerSecond = static_cast<float>(abs(getCurrentSpeedInMilliHz() / 1000));
 
-    systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_UPDATE, rpm);
+    return (currentStepsPerSecond * 60.0f) /
+           (static_cast<float>(GEAR_RATIO) * static_cast<float>(STEPS_PER_REVOLUTION) * static_cast<float>(MICRO_STEPS));
 }
 
 // Centralized stepper hardware control methods
@@ -306,11 +365,37 @@ void StepperController::stepperSetSpeed(float rpm)
         dbg_println("WARNING: Cannot apply speed - stepper not initialized");
         return;
     }
-    const uint32_t stepsPerSecond = rpmToStepsPerSecond(rpm);
+    stepperSetSpeedInHz(rpmToStepsPerSecond(rpm));
+}
+
+void StepperController::stepperSetSpeedInHz(uint32_t stepsPerSecond)
+{
+    if (!stepper)
+    {
+        dbg_println("WARNING: Cannot apply speed - stepper not initialized");
+        return;
+    }
+
+    const bool rampWasSettled = speedRamp.isSettled();
+    speedRamp.setTarget(static_cast<float>(stepsPerSecond));
+
+    if (jerkLimit > 0 && motorEnabled)
+    {
+        // The ramp job approaches the new target along the S-curve
+        if (rampWasSettled)
+        {
+            scheduler.rescheduleIn(speedRampJobId, 0); // Parked while settled
+        }
+        return;
+    }
+    if (isMicrostepSwitchInProgress())
+    {
+        return; // Programmed once the step rate jump is done
+    }
 
     // Set the actual speed on the hardware
-    stepper->setSpeedInHz(stepsPerSecond);
-    stepper->applySpeedAcceleration();
+    setEngineSpeed(stepsPerSecond);
+    applyEngineSpeedAcceleration();
 }
 
 void StepperController::stepperSetAcceleration(uint32_t accelerationStepsPerSec2)
@@ -321,96 +406,208 @@ void StepperController::stepperSetAcceleration(uint32_t accelerationStepsPerSec2
         return;
     }
 
-    stepper->setAcceleration(accelerationStepsPerSec2);
-    stepper->applySpeedAcceleration();
+    // Also the S-curve's acceleration limit; while it runs it programs its own segment accelerations
+    speedRamp.setMaxAcceleration(static_cast<float>(accelerationStepsPerSec2));
+    if ((jerkLimit > 0 && motorEnabled) || isMicrostepSwitchInProgress())
+    {
+        return;
+    }
+
+    setEngineAcceleration(accelerationStepsPerSec2);
+    applyEngineSpeedAcceleration();
 }
 
-StepperController::StepperController()
-    : Task("Stepper_Task", 4096, 1, 1), // Task name, 4KB stack, priority 1, core 1
-      isInitializing(true),             // Start in initialization mode
-      stepper(nullptr), serialStream(Serial2), setpointRPM(1.0f),
-      runCurrent(30), motorEnabled(false), clockwise(true),
-      startTime(0), totalMicroSteps(0), isFirstStart(true), tmc2209Initialized(false), powerDeliveryReady(false),
-      stallDetected(false), stallCount(0),
-      stallGuardThreshold(128), // Initialize StallGuard with default threshold (middle of 0-255 range)
-      setpointAcceleration(0), // Will be set during initialization
-      speedVariationEnabled(false), speedVariationStrength(0.0f), speedVariationPhase(0.0f), speedVariationStartPosition(0),
-      speedVariationK(0.0f), speedVariationK0(1.0f), // Initialize with default values
-      systemStatus(SystemStatus::getInstance()), systemCommand(SystemCommand::getInstance())
+uint32_t StepperController::toEngineSteps(uint32_t steps) const
 {
-    setpointAcceleration = rpmToStepsPerSecond(MAX_SPEED_RPM) / 5;
+    return static_cast<uint32_t>(static_cast<uint64_t>(steps) * engineMicrosteps / MICRO_STEPS);
 }
 
-StepperController::~StepperController()
+int32_t StepperController::getCurrentSpeedInMilliHz() const
 {
-    // No cleanup needed for SystemCommand (singleton manages itself)
+    return static_cast<int32_t>(static_cast<int64_t>(stepper->getCurrentSpeedInMilliHz()) * MICRO_STEPS / engineMicrosteps);
 }
 
-bool StepperController::begin()
+void StepperController::setEngineSpeed(uint32_t stepsPerSecond)
 {
-    dbg_println("Initializing FastAccelStepper with TMC2209...");
+    stepper->setSpeedInHz(max(toEngineSteps(stepsPerSecond), 1u));
+}
 
-    // Initialize preferences storage
-    initPreferences();
+void StepperController::setEngineAcceleration(uint32_t accelerationStepsPerSec2)
+{
+    stepper->setAcceleration(max(toEngineSteps(accelerationStepsPerSec2), 1u));
+}
 
-    // Configure pins
-    pinMode(TMC_EN_PIN, OUTPUT);
-    pinMode(MS1_PIN, OUTPUT);
-    pinMode(MS2_PIN, OUTPUT);
-    pinMode(DIAG_PIN, INPUT);
+void StepperController::applyEngineSpeedAcceleration()
+{
+    stepper->applySpeedAcceleration();
+    wakeStepperBackend();
+}
 
-    // Set serial address pins
-    digitalWrite(MS1_PIN, LOW);
-    digitalWrite(MS2_PIN, LOW);
+void StepperController::wakeStepperBackend()
+{
+    // Only backends that generate motion in update() have the job (FastAccelStepper runs on its own)
+    if (stepperBackendJobId != DEADLINE_SCHEDULER_INVALID_JOB)
+    {
+        scheduler.rescheduleIn(stepperBackendJobId, 0);
+    }
+}
 
-    // Initialize TMC2209
-    stepperDriver.setup(serialStream, 115200, TMC2209::SERIAL_ADDRESS_0, TMC_RX_PIN, TMC_TX_PIN);
+void StepperController::reprogramStepper()
+{
+    if (jerkLimit > 0 && motorEnabled)
+    {
+        // Finish the current S-curve segment; the ramp job continues from there
+        setEngineAcceleration(max(static_cast<uint32_t>(ceilf(speedRamp.getStepAcceleration())), 1u));
+        setEngineSpeed(static_cast<uint32_t>(lroundf(speedRamp.getSpeed())));
+    }
+    else
+    {
+        setEngineAcceleration(static_cast<uint32_t>(speedRamp.getMaxAcceleration()));
+        setEngineSpeed(static_cast<uint32_t>(speedRamp.getTarget()));
+    }
+    applyEngineSpeedAcceleration();
+}
 
-    // Load saved settings
-    loadSettings();
+void StepperController::prepareSpeedRamp(bool reversing)
+{
+    if (jerkLimit == 0)
+    {
+        return;
+    }
 
-    // Configure driver with loaded settings
-    configureDriver();
+    if (stepper->isRunning())
+    {
+        if (reversing)
+        {
+            // FastAccelStepper turns around through standstill with a constant acceleration ramp;
+            // the S-curve takes over again with the next speed change
+            speedRamp.reset(speedRamp.getTarget());
+            setEngineAcceleration(static_cast<uint32_t>(speedRamp.getMaxAcceleration()));
+            setEngineSpeed(static_cast<uint32_t>(speedRamp.getTarget()));
+        }
+        else if (speedRamp.getSpeed() == 0.0f)
+        {
+            // Restarted while still decelerating from a stop - continue from the actual speed
+            speedRamp.reset(abs(getCurrentSpeedInMilliHz()) / 1000.0f);
+            scheduler.rescheduleIn(speedRampJobId, 0);
+        }
+        return;
+    }
 
-    // Check TMC2209 initialization status after configuration
-    tmc2209Initialized = stepperDriver.isSetupAndCommunicating();
+    // From standstill: program the first segment, run*() starts it
+    speedRamp.reset(0.0f);
+    applySpeedRampStep();
+    scheduler.rescheduleIn(speedRampJobId, SPEED_RAMP_UPDATE_INTERVAL);
+}
 
-    if (tmc2209Initialized)
+void StepperController::applySpeedRampStep()
+{
+    speedRamp.update(SPEED_RAMP_UPDATE_INTERVAL / 1000.0f);
+
+    // Reach the ramp speed at the end of the interval with a constant segment acceleration
+    const uint32_t segmentAcceleration = static_cast<uint32_t>(ceilf(speedRamp.getStepAcceleration()));
+    setEngineAcceleration(max(segmentAcceleration, 1u));
+    setEngineSpeed(static_cast<uint32_t>(lroundf(speedRamp.getSpeed())));
+    applyEngineSpeedAcceleration();
+}
+
+uint32_t StepperController::updateSpeedRamp()
+{
+    // Nothing to step: parked until a speed change, start or jerk limit change wakes the job
+    if (!stepper || jerkLimit == 0 || !motorEnabled)
     {
-        dbg_println("TMC2209 driver initialized and communicating successfully");
+        return DEADLINE_SCHEDULER_PARKED;
     }
-    else
+
+    if (isMicrostepSwitchInProgress())
     {
-        dbg_println("WARNING: TMC2209 driver initialization failed or not responding");
+        return MICROSTEP_SWITCH_TIME; // Leave the step generator to the resolution change
     }
 
-    // Initialize FastAccelStepper engine
-    engine.init();
+    if (speedRamp.isSettled())
+    {
+        return DEADLINE_SCHEDULER_PARKED;
+    }
 
-    // Connect stepper to pin
-    stepper = engine.stepperConnectToPin(STEP_PIN);
+    applySpeedRampStep();
+    return SPEED_RAMP_UPDATE_INTERVAL;
+}
 
-    if (!stepper)
+StepperController::StepperController(uint8_t axis, IStepperBackend &stepperBackend, IDriverBackend &driver)
+    : axis(axis), config(STEPPER_AXES[axis]),
+      isInitializing(true),             // Start in initialization mode
+      stepper(nullptr), stepperBackend(stepperBackend), driver(driver),
+      settingsStore(SettingsStore::getInstance()), setpointRPM(1.0f),
+      runCurrent(30), motorEnabled(false), clockwise(true),
+      startTime(0), isFirstStart(true), tmc2209Initialized(false),
+      stallDetected(false), stallCount(0), lastStallNotificationTime(0),
+      lastTemperatureStatus(-1), lastOverTemperatureShutdown(false),
+      sgCalibrationActive(false), sgCalibrationStartedMotor(false), sgCalibrationCollecting(false),
+      sgCalibrationRevolutions(0), sgCalibrationMargin(SG_CALIBRATION_DEFAULT_MARGIN),
+      sgCalibrationStartOdometer(0), sgCalibrationStartTime(0),
+      stallGuardThreshold(128), // Initialize StallGuard with default threshold (middle of 0-255 range)
+      setpointAcceleration(0), // Will be set during initialization
+      jerkLimit(0), engineMicrosteps(MICRO_STEPS), microstepSwitchSettling(false),
+      pendingMicrosteps(0), microstepRequestMs(0), microstepRequestUs(0), microstepRequestPosition(0),
+      speedVariationEnabled(false), speedVariationStrength(0.0f), speedVariationPhase(0.0f),
+      speedVariationK(0.0f), speedVariationK0(1.0f), speedTable(), speedTableMax(0), // Initialize with default values
+      speedVariationAutoTune(false), autoTuneSteps(0),
+      speedScheduleLastIndex(0), speedScheduleSegmentsTraversed(0), speedScheduleWakeups(0), speedScheduleRevolutionStart(0),
+      positionTracker(TOTAL_MICRO_STEPS_PER_REVOLUTION), counterResetOdometer(0), lifetimeOdometerBase(0), lastSavedLifetimeMicroSteps(0),
+      loadMapLastBin(LOAD_MAP_BINS), loadMapLastSequence(0),
+      motorSpeedJobId(DEADLINE_SCHEDULER_INVALID_JOB), loadMapJobId(DEADLINE_SCHEDULER_INVALID_JOB),
+      speedRampJobId(DEADLINE_SCHEDULER_INVALID_JOB), microstepJobId(DEADLINE_SCHEDULER_INVALID_JOB),
+      stepperBackendJobId(DEADLINE_SCHEDULER_INVALID_JOB),
+      systemStatus(SystemStatus::getInstance()), transactionActive(false), processingCommand(false),
+      commandResult(CommandResult::OK)
+{
+    setpointAcceleration = rpmToStepsPerSecond(MAX_SPEED_RPM) / 5;
+}
+
+bool StepperController::begin()
+{
+    dbg_printf("Initializing axis %u (%s) with TMC2209 at address %d...\n", axis, config.name, config.serialAddress);
+
+    if (!driver.begin())
     {
-        dbg_println("Failed to initialize FastAccelStepper");
+        dbg_println("Failed to initialize stepper driver backend");
         return false;
     }
 
-    // Configure FastAccelStepper
-    stepper->setDirectionPin(DIR_PIN);
-    stepper->setEnablePin(TMC_EN_PIN);
-    stepper->setAutoEnable(true);
+    // Load saved settings
+    loadSettings();
+
+    // Build the speed table for the loaded setpoint
+    updateSpeedVariationParameters();
+
+#if DYNAMIC_MICROSTEPPING
+    // Start in the band of the loaded setpoint (the motor is still at rest, so this is free)
+    engineMicrosteps = selectMicrosteps(setpointRPM, MICRO_STEPS);
+#endif
+
+    // Configure driver with loaded settings
+    configureDriver();
+
+    // Connect the step generator (pins, auto-enable and enable delays are set up by the backend)
+    if (!stepperBackend.begin())
+    {
+        dbg_println("Failed to initialize stepper backend");
+        return false;
+    }
+    stepper = &stepperBackend;
 
-    // Set delays for enable/disable
-    stepper->setDelayToEnable(50);
-    stepper->setDelayToDisable(1000);
+    // Start unwrapping the stepper position from here (counted in MICRO_STEPS units)
+    positionTracker.setRawScale(engineMicrosteps, MICRO_STEPS);
+    positionTracker.begin(stepper->getCurrentPosition());
 
+    speedRamp.setJerk(static_cast<float>(jerkLimit));
 
     stepperSetAcceleration(setpointAcceleration);
     stepperSetSpeed(setpointRPM);
 
     // Initially disabled
-    stepperDriver.disable();
+    driver.setEnabled(false);
+    applyDriverRegisters();
 
     // Initialization complete
     isInitializing = false;
@@ -418,114 +615,49 @@ bool StepperController::begin()
     return true;
 }
 
-bool StepperController::initPreferences()
-{
-    // Try to open the namespace with write permissions to ensure it exists
-    if (preferences.begin("stepper", false))
-    {
-        // Check if this is a fresh namespace by looking for a key
-        if (!preferences.isKey("speed"))
-        {
-            // Fresh namespace - write default values
-            dbg_println("Fresh preferences namespace, writing defaults");
-            preferences.putFloat("speed", setpointRPM);
-            preferences.putInt("microsteps", MICRO_STEPS);
-            preferences.putInt("current", runCurrent);
-            preferences.putInt("stallGuardThreshold", stallGuardThreshold);
-            preferences.putUInt("acceleration", setpointAcceleration);
-        }
-        preferences.end();
-        dbg_println("Preferences namespace initialized");
-        return true;
-    }
-    else
-    {
-        dbg_println("Failed to initialize preferences namespace");
-        return false;
-    }
-}
-
 void StepperController::configureDriver()
 {
-    stepperDriver.setRunCurrent(runCurrent);
-    stepperDriver.setMicrostepsPerStep(MICRO_STEPS);
-    stepperDriver.enableAutomaticCurrentScaling();
-    stepperDriver.enableAutomaticGradientAdaptation();
-    stepperDriver.enableStealthChop();                // stealth chop needs to be enabled for stall detect
-    stepperDriver.setCoolStepDurationThreshold(5000); // TCOOLTHRS (DIAG only enabled when TSTEP smaller than this)
+    driver.setRunCurrent(runCurrent);
+    driver.setMicrostepsPerStep(engineMicrosteps);
+    driver.setAutomaticPwm(true);                // Automatic current scaling + gradient adaptation
+    driver.setStealthChop(true);                 // stealth chop needs to be enabled for stall detect
+    driver.setCoolStepDurationThreshold(5000);   // TCOOLTHRS (DIAG only enabled when TSTEP smaller than this)
 
     // Configure StallGuard
-    stepperDriver.setStallGuardThreshold(stallGuardThreshold);
+    driver.setStallGuardThreshold(stallGuardThreshold);
 
     // Configure CoolStep
     // stepperDriver.enableCoolStep();
 
-    // Update communication status after configuration
-    bool newTmc2209Status = stepperDriver.isSetupAndCommunicating();
+    // The driver backend writes the full register set in one batch on startup (the driver I/O task
+    // probes the driver first); when it is already running (reconfiguration) this just flushes
+    driver.markAllDirty();
+    applyDriverRegisters();
+}
 
-    // Publish TMC2209 status update if communication status changed
-    if (newTmc2209Status != tmc2209Initialized)
+void StepperController::confirmDriverCommunication(unsigned long waitStart)
+{
+    // Wait for the first diagnostics snapshot of this driver so the initial communication status is known
+    while (driver.getDiagnostics().lastUpdateMs == 0 && millis() - waitStart < DRIVER_IO_STARTUP_TIMEOUT)
     {
-        systemStatus.publishStatusUpdate(StatusUpdateType::TMC2209_STATUS_UPDATE, newTmc2209Status);
+        vTaskDelay(pdMS_TO_TICKS(10));
     }
-    tmc2209Initialized = newTmc2209Status;
+    refreshDriverDiagnostics();
 
     // Check if driver is communicating properly
     if (tmc2209Initialized)
     {
-        dbg_printf("TMC2209 configured: %d microsteps, %d%% current, StallGuard threshold: %d\n",
-                   MICRO_STEPS, runCurrent, stallGuardThreshold);
+        dbg_printf("TMC2209 configured (%s): %d microsteps, %d%% current, StallGuard threshold: %d\n",
+                   config.name, engineMicrosteps, runCurrent, stallGuardThreshold);
         dbg_println("Note: StallGuard may require disabling StealthChop for optimal detection");
     }
     else
     {
-        dbg_println("WARNING: TMC2209 driver not responding during configuration");
-    }
-}
-
-bool StepperController::checkPowerDeliveryReady()
-{
-    PowerDeliveryTask &pdTask = PowerDeliveryTask::getInstance();
-
-    // Check if power delivery is ready (successful negotiation AND power good)
-    if (pdTask.isNegotiationComplete() && pdTask.isPowerGood())
-    {
-        if (!powerDeliveryReady)
-        {
-            powerDeliveryReady = true;
-            dbg_printf("StepperController: Power delivery ready - %dV negotiated, %0.1fV measured\n",
-                       pdTask.getNegotiatedVoltage(), pdTask.getCurrentVoltage());
-        }
-        return true;
-    }
-
-    // If negotiation is complete but failed, check if it's because no PD adapter is connected
-    if (pdTask.isNegotiationComplete() && !pdTask.isPowerGood())
-    {
-        PDNegotiationState state = pdTask.getNegotiationState();
-
-        // If negotiation timed out or failed, assume no PD adapter and allow operation
-        if (state == PDNegotiationState::FAILED)
-        {
-            if (!powerDeliveryReady)
-            {
-                powerDeliveryReady = true;
-                dbg_println("StepperController: No PD adapter detected, allowing operation without PD safety");
-            }
-            return true;
-        }
-    }
-
-    // If we get here, either negotiation is still in progress or power was lost
-    if (powerDeliveryReady)
-    {
-        powerDeliveryReady = false;
-        dbg_println("StepperController: Power delivery lost or negotiation in progress");
+        dbg_printf("WARNING: TMC2209 driver (%s) not responding during configuration\n", config.name);
     }
-    return false;
 }
 
-uint32_t StepperController::rpmToStepsPerSecond(float rpm) const
+uint32_t StepperController::rpmToStepsPerSecond(float rpm)
 {
     // Optimized calculation
     // Formula: (rpm * GEAR_RATIO * STEPS_PER_REVOLUTION * MICRO_STEPS) / 60.0f
@@ -537,165 +669,112 @@ uint32_t StepperController::rpmToStepsPerSecond(float rpm) const
     return static_cast<uint32_t>(motorStepsPerSecond);
 }
 
-void StepperController::run()
+void StepperController::startJobs()
 {
-    dbg_println("Stepper Task started");
-
-    // Wait for power delivery negotiation with timeout
-    dbg_println("Waiting for power delivery negotiation...");
-    unsigned long pdWaitStart = millis();
-    const unsigned long PD_WAIT_TIMEOUT = 10000; // 10 second timeout
-    bool pdTimedOut = false;
-
-    while (!checkPowerDeliveryReady() && !pdTimedOut)
-    {
-        if (millis() - pdWaitStart >= PD_WAIT_TIMEOUT)
-        {
-            pdTimedOut = true;
-            dbg_println("StepperController: Power delivery negotiation timed out");
-            dbg_println("StepperController: Proceeding with stepper initialization (no PD adapter or negotiation failed)");
-            dbg_println("StepperController: Motor control will be available but without PD safety features");
-        }
-        else
-        {
-            vTaskDelay(pdMS_TO_TICKS(500)); // Check every 500ms
-        }
-    }
-
-    if (!pdTimedOut)
-    {
-        dbg_println("StepperController: Power delivery negotiation successful, proceeding with full safety features");
-    }
-
-    // Initialize stepper controller
-    if (!begin())
+    // Register periodic jobs, each with its lateness and execution time histograms
+    scheduler.enableHistograms();
+    motorSpeedJobId = scheduler.addJob("motor_speed", MOTOR_SPEED_UPDATE_INTERVAL, motorSpeedJob, this, MOTOR_SPEED_UPDATE_INTERVAL);
+    scheduler.addJob("fast_status", FAST_UPDATE_INTERVAL, fastStatusJob, this, FAST_UPDATE_INTERVAL);
+    scheduler.addJob("stall_status", STALL_UPDATE_INTERVAL, stallStatusJob, this, STALL_UPDATE_INTERVAL);
+    scheduler.addJob("tmc_status", TMC_UPDATE_INTERVAL, tmcStatusJob, this, TMC_UPDATE_INTERVAL);
+    loadMapJobId = scheduler.addJob("load_map", LOAD_MAP_IDLE_INTERVAL, loadMapJob, this, LOAD_MAP_IDLE_INTERVAL);
+    scheduler.addJob("load_map_pub", LOAD_MAP_PUBLISH_INTERVAL, loadMapPublishJob, this, LOAD_MAP_PUBLISH_INTERVAL);
+    scheduler.addJob("odometer", ODOMETER_SAVE_INTERVAL, odometerJob, this, ODOMETER_SAVE_INTERVAL);
+    speedRampJobId = scheduler.addJob("speed_ramp", SPEED_RAMP_UPDATE_INTERVAL, speedRampJob, this);
+    scheduler.rescheduleIn(speedRampJobId, DEADLINE_SCHEDULER_PARKED);
+#if DYNAMIC_MICROSTEPPING
+    microstepJobId = scheduler.addJob("microsteps", MICROSTEP_UPDATE_INTERVAL, microstepJob, this, MICROSTEP_UPDATE_INTERVAL);
+#endif
+    if (stepperBackend.needsUpdate())
     {
-        dbg_println("Failed to initialize stepper controller!");
-        return;
+        stepperBackendJobId = scheduler.addJob("stepper_backend", STEPPER_BACKEND_IDLE_UPDATE, stepperBackendJob, this, 0);
     }
+}
 
-    dbg_println("Stepper Controller initialized successfully!");
-
-    // Initialize timing variables with cached millis() value
-    StepperCommandData cmd;
-    uint32_t currentTime = millis();
-    unsigned long nextMotorSpeedUpdate = currentTime + MOTOR_SPEED_UPDATE_INTERVAL; // 10ms
-    unsigned long nextFastStatusUpdate = currentTime + FAST_UPDATE_INTERVAL;        // 100ms
-    unsigned long nextStallUpdate = currentTime + 1000;                             // 1s
-    unsigned long nextTMCUpdate = currentTime + 2000;                               // 2s
-
-    while (true)
-    {
-
-        // Find the next event to wait for
-        unsigned long nextEvent = min(nextMotorSpeedUpdate, min(nextFastStatusUpdate, min(nextStallUpdate, nextTMCUpdate)));
-        TickType_t timeout = calculateQueueTimeout(nextEvent);
-
-        if (systemCommand.getCommand(cmd, timeout))
-        {
-            processCommand(cmd);
-        }
-
-        // Motor speed updates (every 10ms for smooth variation)
-        if (isUpdateDue(nextMotorSpeedUpdate))
-        {
-            updateMotorSpeed();
-            nextMotorSpeedUpdate = currentTime + MOTOR_SPEED_UPDATE_INTERVAL;
-        }
+void StepperController::motorSpeedJob(void *context)
+{
+    StepperController *self = static_cast<StepperController *>(context);
 
-        // Fast status updates (every 100ms)
-        if (isUpdateDue(nextFastStatusUpdate))
-        {
-            publishFastStatusUpdates();
-            nextFastStatusUpdate = currentTime + FAST_UPDATE_INTERVAL;
-        }
+    // Every 10ms, or at the next speed table segment when position scheduled
+    self->scheduler.rescheduleIn(self->motorSpeedJobId, self->updateMotorSpeed());
+}
 
-        // Stall status updates (every 1s)
-        if (isUpdateDue(nextStallUpdate))
-        {
-            publishStallStatusUpdates();
+void StepperController::fastStatusJob(void *context)
+{
+    static_cast<StepperController *>(context)->publishFastStatusUpdates();
+}
 
-            nextStallUpdate = currentTime + STALL_UPDATE_INTERVAL;
-        }
+void StepperController::stallStatusJob(void *context)
+{
+    static_cast<StepperController *>(context)->publishStallStatusUpdates();
+}
 
-        // TMC2209 status/temperature updates (every 2s)
-        if (isUpdateDue(nextTMCUpdate))
-        {
-            publishTMCStatusUpdates();
-            nextTMCUpdate = currentTime + TMC_UPDATE_INTERVAL;
-        }
-    }
+void StepperController::tmcStatusJob(void *context)
+{
+    static_cast<StepperController *>(context)->publishTMCStatusUpdates();
 }
 
-TickType_t StepperController::calculateQueueTimeout(unsigned long nextUpdate)
+void StepperController::loadMapJob(void *context)
 {
-    const unsigned long currentTime = millis();
+    StepperController *self = static_cast<StepperController *>(context);
+
+    // Wakes at every load map bin boundary while the motor turns
+    self->scheduler.rescheduleIn(self->loadMapJobId, self->updateLoadMap());
 
-    // Handle millis() overflow gracefully
-    if (nextUpdate < currentTime)
+    if (self->speedVariationAutoTune)
     {
-        return 0; // Update overdue
+        self->updateAutoTune();
     }
 
-    unsigned long timeUntilUpdate = nextUpdate - currentTime;
-
-    // Clamp timeout to reasonable bounds (max 100ms for responsiveness)
-    timeUntilUpdate = min(timeUntilUpdate, 100UL);
-
-    return timeUntilUpdate > 0 ? pdMS_TO_TICKS(timeUntilUpdate) : 0;
+    if (self->sgCalibrationActive)
+    {
+        self->updateStallGuardCalibration();
+    }
 }
 
-bool StepperController::isUpdateDue(unsigned long nextUpdate)
+void StepperController::loadMapPublishJob(void *context)
 {
-    const unsigned long currentTime = millis();
+    StepperController *self = static_cast<StepperController *>(context);
 
-    // Handle millis() overflow case
-    if (nextUpdate > currentTime && (nextUpdate - currentTime) > 0x80000000UL)
+    // Only publish while the map is being filled
+    if (self->motorEnabled && self->loadMap.getTotalSamples() > 0)
     {
-        return true; // Overflow detected
+        self->publishLoadMap();
     }
-
-    return currentTime >= nextUpdate;
 }
 
-void StepperController::publishTotalRevolutions()
+void StepperController::odometerJob(void *context)
 {
-    if (!stepper)
-    {
-        dbg_println("WARNING: Cannot check total revolutions - stepper not initialized");
-        return;
-    }
-
-    static int32_t lastPosition = 0;
-
-    const int32_t currentPosition = stepper->getCurrentPosition();
-    int32_t diffMicrosteps = abs(currentPosition - lastPosition);
-    lastPosition = currentPosition;
+    static_cast<StepperController *>(context)->saveOdometer();
+}
 
-    totalMicroSteps += diffMicrosteps;
+void StepperController::speedRampJob(void *context)
+{
+    StepperController *self = static_cast<StepperController *>(context);
+    self->scheduler.rescheduleIn(self->speedRampJobId, self->updateSpeedRamp());
+}
 
-    float totalRevolutions = static_cast<float>(totalMicroSteps) / TOTAL_MICRO_STEPS_PER_REVOLUTION;
-    systemStatus.publishStatusUpdate(StatusUpdateType::TOTAL_REVOLUTIONS_UPDATE, totalRevolutions);
+void StepperController::microstepJob(void *context)
+{
+    StepperController *self = static_cast<StepperController *>(context);
+    self->scheduler.rescheduleIn(self->microstepJobId, self->updateMicrostepResolution());
 }
 
-void StepperController::publishRuntime()
+void StepperController::stepperBackendJob(void *context)
 {
-    if (!stepper)
-    {
-        dbg_println("WARNING: Cannot check runtime - stepper not initialized");
-        return;
-    }
+    StepperController *self = static_cast<StepperController *>(context);
 
-    // Calculate runtime only if the motor has been started at least once
-    if (isFirstStart || startTime == 0)
-    {
-        return; // No runtime to report yet
-    }
+    // Backends that ramp in software (VACTUAL) ask for their next update; step generators idle
+    self->scheduler.rescheduleIn(self->stepperBackendJobId, self->stepper->update());
+}
 
-    const unsigned long currentTime = millis();
-    unsigned long runtime = currentTime - startTime; // Keep in milliseconds
+float StepperController::calculateTotalRevolutions()
+{
+    // Distance since the last counter reset, from the 64-bit odometer (exact for any run length)
+    trackPosition();
+    const uint64_t totalMicroSteps = positionTracker.getOdometer() - counterResetOdometer;
 
-    systemStatus.publishStatusUpdate(StatusUpdateType::RUNTIME_UPDATE, runtime);
+    return static_cast<float>(static_cast<double>(totalMicroSteps) / TOTAL_MICRO_STEPS_PER_REVOLUTION);
 }
 
 void StepperController::publishPeriodicStatusUpdates()
@@ -712,10 +791,24 @@ void StepperController::publishFastStatusUpdates()
 {
     if (!stepper)
         return;
-    publishCurrentRPM();
-    publishTotalRevolutions();
-    publishRuntime();
-    publishStallGuardResult();
+
+    // One snapshot per axis instead of four queued updates - the BLE task picks up the newest one
+    StepperTelemetry telemetry;
+    telemetry.currentSpeed = calculateCurrentRPM();
+    telemetry.totalRevolutions = calculateTotalRevolutions();
+
+    // Runtime only once the motor has been started at least once
+    telemetry.runtimeValid = !isFirstStart && startTime != 0;
+    telemetry.runtime = telemetry.runtimeValid ? millis() - startTime : 0; // Keep in milliseconds
+
+    // StallGuard result from TMC2209 (0-510 per datasheet), read by the driver I/O task
+    telemetry.stallGuardResult = tmc2209Initialized ? static_cast<int16_t>(driver.getDiagnostics().stallGuardResult) : -1;
+
+    // Step generator load at the current driver resolution
+    telemetry.stepRate = static_cast<uint32_t>(abs(stepper->getCurrentSpeedInMilliHz()) / 1000);
+    telemetry.microsteps = engineMicrosteps;
+
+    systemStatus.publishTelemetry(axis, telemetry);
 }
 
 void StepperController::publishStallStatusUpdates()
@@ -733,6 +826,9 @@ void StepperController::processCommand(const StepperCommandData &cmd)
 {
     dbg_printf("StepperController: Processing command type %d\n", (int)cmd.command);
 
+    processingCommand = true;
+    commandResult = CommandResult::OK;
+
     switch (cmd.command)
     {
     case StepperCommand::SET_SPEED:
@@ -763,6 +859,10 @@ void StepperController::processCommand(const StepperCommandData &cmd)
         setAccelerationInternal(cmd.intValue);
         break;
 
+    case StepperCommand::SET_JERK_LIMIT:
+        setJerkLimitInternal(cmd.uint32Value);
+        break;
+
     case StepperCommand::RESET_COUNTERS:
         resetCountersInternal();
         break;
@@ -787,19 +887,110 @@ void StepperController::processCommand(const StepperCommandData &cmd)
         disableSpeedVariationInternal();
         break;
 
+    case StepperCommand::SET_SPEED_VARIATION_AUTO_TUNE:
+        setSpeedVariationAutoTuneInternal(cmd.boolValue);
+        break;
+
     case StepperCommand::SET_STALLGUARD_THRESHOLD:
         setStallGuardThresholdInternal(cmd.intValue);
         break;
 
+    case StepperCommand::CALIBRATE_STALLGUARD:
+        startStallGuardCalibrationInternal(cmd.intValue);
+        break;
+
+    case StepperCommand::SET_STALLGUARD_CALIBRATION_MARGIN:
+        setStallGuardCalibrationMarginInternal(cmd.intValue);
+        break;
+
     case StepperCommand::REQUEST_ALL_STATUS:
         requestAllStatusInternal();
         break;
-    }
-}
 
-void StepperController::resetCountersInternal()
+    case StepperCommand::REQUEST_LATENCY_HISTOGRAMS:
+    case StepperCommand::RESET_LATENCY_HISTOGRAMS:
+        break; // Handled by StepperTask for every scheduler at once
+
+    case StepperCommand::APPLY_TRANSACTION:
+        applyTransactionInternal(cmd.transaction, cmd.trace.id);
+        break;
+    }
+
+    processingCommand = false;
+    acknowledgeCommand(cmd);
+
+    // Commands may change speed, direction or enable state - re-evaluate the speed schedule now
+    scheduler.rescheduleIn(motorSpeedJobId, 0);
+}
+
+void StepperController::acknowledgeCommand(const StepperCommandData &cmd)
 {
-    totalMicroSteps = 0;
+    const uint16_t seq = cmd.trace.seq;
+    if (seq == 0)
+    {
+        return;
+    }
+
+    // The value in effect after the command, so the client sees clamped or limited values at once
+    switch (cmd.command)
+    {
+    case StepperCommand::SET_SPEED:
+    case StepperCommand::APPLY_TRANSACTION:
+        systemStatus.publishCommandAck(seq, axis, commandResult, setpointRPM);
+        break;
+    case StepperCommand::SET_DIRECTION:
+        systemStatus.publishCommandAck(seq, axis, commandResult, clockwise ? 1.0f : 0.0f);
+        break;
+    case StepperCommand::ENABLE:
+    case StepperCommand::DISABLE:
+    case StepperCommand::EMERGENCY_STOP:
+        systemStatus.publishCommandAck(seq, axis, commandResult, motorEnabled ? 1.0f : 0.0f);
+        break;
+    case StepperCommand::SET_CURRENT:
+        systemStatus.publishCommandAck(seq, axis, commandResult, static_cast<float>(runCurrent));
+        break;
+    case StepperCommand::SET_ACCELERATION:
+        systemStatus.publishCommandAck(seq, axis, commandResult, static_cast<float>(setpointAcceleration));
+        break;
+    case StepperCommand::SET_JERK_LIMIT:
+        systemStatus.publishCommandAck(seq, axis, commandResult, static_cast<float>(jerkLimit));
+        break;
+    case StepperCommand::SET_SPEED_VARIATION:
+        systemStatus.publishCommandAck(seq, axis, commandResult, speedVariationStrength);
+        break;
+    case StepperCommand::SET_SPEED_VARIATION_PHASE:
+        systemStatus.publishCommandAck(seq, axis, commandResult, speedVariationPhase);
+        break;
+    case StepperCommand::ENABLE_SPEED_VARIATION:
+    case StepperCommand::DISABLE_SPEED_VARIATION:
+        systemStatus.publishCommandAck(seq, axis, commandResult, speedVariationEnabled ? 1.0f : 0.0f);
+        break;
+    case StepperCommand::SET_SPEED_VARIATION_AUTO_TUNE:
+        systemStatus.publishCommandAck(seq, axis, commandResult, speedVariationAutoTune ? 1.0f : 0.0f);
+        break;
+    case StepperCommand::SET_STALLGUARD_THRESHOLD:
+        systemStatus.publishCommandAck(seq, axis, commandResult, static_cast<float>(stallGuardThreshold));
+        break;
+    case StepperCommand::CALIBRATE_STALLGUARD:
+        systemStatus.publishCommandAck(seq, axis, commandResult, sgCalibrationActive ? 1.0f : 0.0f);
+        break;
+    case StepperCommand::SET_STALLGUARD_CALIBRATION_MARGIN:
+        systemStatus.publishCommandAck(seq, axis, commandResult, static_cast<float>(sgCalibrationMargin));
+        break;
+    case StepperCommand::RESET_COUNTERS:
+    case StepperCommand::RESET_STALL_COUNT:
+    case StepperCommand::REQUEST_ALL_STATUS:
+    case StepperCommand::REQUEST_LATENCY_HISTOGRAMS:
+    case StepperCommand::RESET_LATENCY_HISTOGRAMS:
+        systemStatus.publishCommandAck(seq, axis, commandResult);
+        break;
+    }
+}
+
+void StepperController::resetCountersInternal()
+{
+    trackPosition();
+    counterResetOdometer = positionTracker.getOdometer();
     startTime = millis();
     isFirstStart = false;
 
@@ -813,7 +1004,7 @@ void StepperController::resetStallCountInternal()
     stallDetected = false;
 
     dbg_println("Stall count reset");
-    systemStatus.publishStatusUpdate(StatusUpdateType::STALL_COUNT_UPDATE, stallCount);
+    publishStatus(StatusUpdateType::STALL_COUNT_UPDATE, stallCount);
     // Success is indicated by the status update - no notification needed
 }
 
@@ -825,8 +1016,8 @@ void StepperController::setSpeedInternal(float rpm)
 
     if (!stepper)
     {
-        systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_SETPOINT_CHANGED, setpointRPM);
-        systemStatus.sendNotification(NotificationType::ERROR, "Stepper not initialized");
+        publishStatus(StatusUpdateType::SPEED_SETPOINT_CHANGED, setpointRPM);
+        notify(NotificationType::ERROR, "Stepper not initialized");
         return;
     }
 
@@ -906,7 +1097,7 @@ void StepperController::setSpeedInternal(float rpm)
                      "Speed auto-adjusted from %.2f to %.2f RPM (allowed range: %.1f-%.1f RPM)",
                      originalRequestedSpeed, rpm, MIN_SPEED_RPM, MAX_SPEED_RPM);
         }
-        systemStatus.sendNotification(NotificationType::WARNING, String(warningMsg));
+        notify(NotificationType::WARNING, String(warningMsg));
     }
     // Success is indicated by the status update - no notification needed for normal success
 }
@@ -915,8 +1106,8 @@ void StepperController::setDirectionInternal(bool clockwise)
 {
     if (!stepper)
     {
-        systemStatus.publishStatusUpdate(StatusUpdateType::DIRECTION_CHANGED, clockwise);
-        systemStatus.sendNotification(NotificationType::ERROR, "Stepper not initialized");
+        publishStatus(StatusUpdateType::DIRECTION_CHANGED, clockwise);
+        notify(NotificationType::ERROR, "Stepper not initialized");
         return;
     }
 
@@ -939,8 +1130,8 @@ void StepperController::enableInternal()
 {
     if (!stepper)
     {
-        systemStatus.publishStatusUpdate(StatusUpdateType::ENABLED_CHANGED, motorEnabled);
-        systemStatus.sendNotification(NotificationType::ERROR, "Stepper not initialized");
+        publishStatus(StatusUpdateType::ENABLED_CHANGED, motorEnabled);
+        notify(NotificationType::ERROR, "Stepper not initialized");
         return;
     }
 
@@ -959,6 +1150,9 @@ void StepperController::enableInternal()
         isFirstStart = false;
     }
 
+    // Don't count the time spent disabled towards the wakeup comparison
+    resetSpeedScheduleTracking();
+
     dbg_println("Motor enabled and started");
 }
 
@@ -971,19 +1165,21 @@ void StepperController::emergencyStopInternal()
 {
     if (!stepper)
     {
-        systemStatus.publishStatusUpdate(StatusUpdateType::ENABLED_CHANGED, false);
-        systemStatus.sendNotification(NotificationType::ERROR, "Stepper not initialized");
+        publishStatus(StatusUpdateType::ENABLED_CHANGED, false);
+        notify(NotificationType::ERROR, "Stepper not initialized");
         return;
     }
 
     stepper->forceStopAndNewPosition(stepper->getCurrentPosition());
+    wakeStepperBackend();
 
-    stepperDriver.disable();
+    driver.setEnabled(false);
+    applyDriverRegisters();
     motorEnabled = false;
 
     dbg_println("EMERGENCY STOP executed");
 
-    systemStatus.publishStatusUpdate(StatusUpdateType::ENABLED_CHANGED, false);
+    publishStatus(StatusUpdateType::ENABLED_CHANGED, false);
 }
 
 void StepperController::setRunCurrentInternal(int current)
@@ -991,8 +1187,8 @@ void StepperController::setRunCurrentInternal(int current)
     // Validate current (10-100%)
     if (current < 10 || current > 100)
     {
-        systemStatus.publishStatusUpdate(StatusUpdateType::CURRENT_CHANGED, runCurrent);
-        systemStatus.sendNotification(NotificationType::ERROR, "Current out of range (10-100%)");
+        publishStatus(StatusUpdateType::CURRENT_CHANGED, runCurrent);
+        notify(NotificationType::ERROR, "Current out of range (10-100%)");
         return;
     }
 
@@ -1014,8 +1210,8 @@ void StepperController::setAccelerationInternal(uint32_t accelerationStepsPerSec
 
     if (!stepper)
     {
-        systemStatus.publishStatusUpdate(StatusUpdateType::ACCELERATION_CHANGED, setpointAcceleration);
-        systemStatus.sendNotification(NotificationType::ERROR, "Stepper not initialized");
+        publishStatus(StatusUpdateType::ACCELERATION_CHANGED, setpointAcceleration);
+        notify(NotificationType::ERROR, "Stepper not initialized");
         return;
     }
 
@@ -1054,7 +1250,7 @@ void StepperController::setAccelerationInternal(uint32_t accelerationStepsPerSec
     }
 
     // Publish status update for acceleration change
-    systemStatus.publishStatusUpdate(StatusUpdateType::ACCELERATION_CHANGED, accelerationStepsPerSec2);
+    publishStatus(StatusUpdateType::ACCELERATION_CHANGED, accelerationStepsPerSec2);
 
     // Report warning if acceleration was adjusted (use efficient string building)
     if (accelWasAdjusted && !isInitializing)
@@ -1085,38 +1281,93 @@ void StepperController::setAccelerationInternal(uint32_t accelerationStepsPerSec
                      "Acceleration auto-adjusted from %u to %u steps/s² (allowed range: 100-100000)",
                      originalRequestedAccel, accelerationStepsPerSec2);
         }
-        systemStatus.sendNotification(NotificationType::WARNING, String(warningMsg));
+        notify(NotificationType::WARNING, String(warningMsg));
     }
     // Success is indicated by the status update - no notification needed for normal success
 }
 
-void StepperController::saveSettings()
+void StepperController::setJerkLimitInternal(uint32_t jerkStepsPerSec3)
 {
-    if (preferences.begin("stepper", false))
+    if (!stepper)
     {
-        preferences.putFloat("speed", setpointRPM);
-        preferences.putBool("clockwise", clockwise);
-        preferences.putInt("current", runCurrent);
-        preferences.putUInt("acceleration", setpointAcceleration);
-        preferences.putUInt("stallGuardThreshold", stallGuardThreshold);
-        preferences.end();
-        dbg_println("Settings saved to flash");
+        publishStatus(StatusUpdateType::JERK_LIMIT_CHANGED, jerkLimit);
+        notify(NotificationType::ERROR, "Stepper not initialized");
+        return;
     }
-    else
+
+    if (jerkStepsPerSec3 > MAX_JERK_LIMIT)
     {
-        dbg_println("Failed to open preferences for saving");
+        publishStatus(StatusUpdateType::JERK_LIMIT_CHANGED, jerkLimit);
+        notify(NotificationType::ERROR, "Jerk limit out of range (0-10000000 steps/s³)");
+        return;
     }
+
+    const bool wasLimited = jerkLimit > 0;
+    jerkLimit = jerkStepsPerSec3;
+    speedRamp.setJerk(static_cast<float>(jerkLimit));
+
+    if (motorEnabled && stepper->isRunning())
+    {
+        if (jerkLimit > 0 && !wasLimited)
+        {
+            // Take over from the constant-acceleration ramp at the current speed
+            speedRamp.reset(abs(getCurrentSpeedInMilliHz()) / 1000.0f);
+            scheduler.rescheduleIn(speedRampJobId, 0);
+        }
+        else if (jerkLimit == 0 && wasLimited)
+        {
+            // Hand the remaining change back to FastAccelStepper
+            setEngineAcceleration(static_cast<uint32_t>(speedRamp.getMaxAcceleration()));
+            setEngineSpeed(static_cast<uint32_t>(speedRamp.getTarget()));
+            applyEngineSpeedAcceleration();
+        }
+    }
+
+    if (!isInitializing)
+    {
+        saveSettings();
+    }
+
+    dbg_printf("Jerk limit set to %u steps/s³%s\n", jerkLimit, jerkLimit == 0 ? " (constant acceleration)" : "");
+    publishStatus(StatusUpdateType::JERK_LIMIT_CHANGED, jerkLimit);
+}
+
+PersistentSettings StepperController::collectSettings() const
+{
+    PersistentSettings settings;
+    settings.speedRPM = setpointRPM;
+    settings.acceleration = setpointAcceleration;
+    settings.runCurrent = static_cast<uint8_t>(runCurrent);
+    settings.stallGuardThreshold = stallGuardThreshold;
+    settings.stallGuardCalibrationMargin = sgCalibrationMargin;
+    settings.clockwise = clockwise;
+    settings.lifetimeMicroSteps = getLifetimeMicroSteps();
+    settings.jerkLimit = jerkLimit;
+    return settings;
+}
+
+void StepperController::saveSettings()
+{
+    // Write-behind: the settings task coalesces bursts (e.g. slider drags) into one flash write
+    settingsStore.save(axis, collectSettings());
 }
 
 void StepperController::loadSettings()
 {
-    if (preferences.begin("stepper", true))
-    {
-        setpointRPM = preferences.getFloat("speed", setpointRPM);
-        clockwise = preferences.getBool("clockwise", clockwise);
-        runCurrent = preferences.getInt("current", runCurrent);
-        setpointAcceleration = preferences.getUInt("acceleration", setpointAcceleration);
-        preferences.end();
+    // Current member values are the defaults for anything not stored yet
+    PersistentSettings settings = collectSettings();
+
+    if (settingsStore.begin(axis, settings))
+    {
+        setpointRPM = settings.speedRPM;
+        clockwise = settings.clockwise;
+        runCurrent = settings.runCurrent;
+        setpointAcceleration = settings.acceleration;
+        stallGuardThreshold = settings.stallGuardThreshold;
+        sgCalibrationMargin = settings.stallGuardCalibrationMargin;
+        lifetimeOdometerBase = settings.lifetimeMicroSteps;
+        jerkLimit = settings.jerkLimit;
+        lastSavedLifetimeMicroSteps = lifetimeOdometerBase;
         dbg_printf("Settings loaded from flash: %.2f RPM, %s, %d microsteps, %d%% current, %u accel\n",
                    setpointRPM, clockwise ? "CW" : "CCW", MICRO_STEPS, runCurrent, setpointAcceleration);
     }
@@ -1135,19 +1386,25 @@ void StepperController::setSpeedVariationInternal(float strength)
     // Validate strength (0.0 to 1.0)
     if (strength < 0.0f || strength > 1.0f)
     {
-        systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_VARIATION_STRENGTH_CHANGED, speedVariationStrength);
-        systemStatus.sendNotification(NotificationType::ERROR,
+        publishStatus(StatusUpdateType::SPEED_VARIATION_STRENGTH_CHANGED, speedVariationStrength);
+        notify(NotificationType::ERROR,
                                       "Speed variation strength out of range (0.0-1.0)");
         return;
     }
 
     if (!stepper)
     {
-        systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_VARIATION_STRENGTH_CHANGED, speedVariationStrength);
-        systemStatus.sendNotification(NotificationType::ERROR, "Stepper not initialized");
+        publishStatus(StatusUpdateType::SPEED_VARIATION_STRENGTH_CHANGED, speedVariationStrength);
+        notify(NotificationType::ERROR, "Stepper not initialized");
         return;
     }
 
+    // A manual setting overrides the auto-tune
+    if (speedVariationAutoTune)
+    {
+        setSpeedVariationAutoTuneInternal(false);
+    }
+
     speedVariationStrength = strength;
 
     // Update k and k0 parameters for new strength first
@@ -1166,20 +1423,29 @@ void StepperController::setSpeedVariationInternal(float strength)
                calculateMaxAllowedBaseSpeed(), setpointRPM);
 
     // Publish status update for speed variation strength change
-    systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_VARIATION_STRENGTH_CHANGED, strength);
+    publishStatus(StatusUpdateType::SPEED_VARIATION_STRENGTH_CHANGED, strength);
     // Success is indicated by the status update - no notification needed
 }
 
 void StepperController::setSpeedVariationPhaseInternal(float phase)
 {
+    // A manual setting overrides the auto-tune
+    if (speedVariationAutoTune)
+    {
+        setSpeedVariationAutoTuneInternal(false);
+    }
+
     // Optimize phase normalization using fmod
     speedVariationPhase = fmodf(phase + (phase < 0.0f ? 6.28318530718f : 0.0f), 6.28318530718f);
 
+    // Phase is baked into the speed table
+    updateSpeedVariationParameters();
+
     dbg_printf("Speed variation phase set to %.2f radians (%.0f degrees)\n",
                speedVariationPhase, speedVariationPhase * 180.0f / PI);
 
     // Publish status update for speed variation phase change
-    systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_VARIATION_PHASE_CHANGED, speedVariationPhase);
+    publishStatus(StatusUpdateType::SPEED_VARIATION_PHASE_CHANGED, speedVariationPhase);
     // Success is indicated by the status update - no notification needed
 }
 
@@ -1187,8 +1453,8 @@ void StepperController::enableSpeedVariationInternal()
 {
     if (!stepper)
     {
-        systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_VARIATION_ENABLED_CHANGED, speedVariationEnabled);
-        systemStatus.sendNotification(NotificationType::ERROR, "Stepper not initialized");
+        publishStatus(StatusUpdateType::SPEED_VARIATION_ENABLED_CHANGED, speedVariationEnabled);
+        notify(NotificationType::ERROR, "Stepper not initialized");
         return;
     }
 
@@ -1196,25 +1462,29 @@ void StepperController::enableSpeedVariationInternal()
     updateSpeedForVariableSpeed();
 
     // Set current position as the reference point for variation
-    speedVariationStartPosition = stepper->getCurrentPosition();
+    trackPosition();
+    positionTracker.setRevolutionOrigin();
     speedVariationEnabled = true;
+    resetLoadMap(); // The load map shares this angle reference
 
     // Reset phase offset to 0 when re-enabling variable speed
     speedVariationPhase = 0.0f;
+    updateSpeedVariationParameters();
+    resetSpeedScheduleTracking();
 
     // Dynamically calculate and apply required acceleration for variable speed
     updateAccelerationForVariableSpeed();
 
-    dbg_printf("Speed variation enabled at position %d (strength: %.0f%%, phase: 0°)\n",
-               static_cast<int>(speedVariationStartPosition), speedVariationStrength * 100.0f);
+    dbg_printf("Speed variation enabled at position %lld (strength: %.0f%%, phase: 0°)\n",
+               static_cast<long long>(positionTracker.getPosition()), speedVariationStrength * 100.0f);
     dbg_printf("Max allowed base speed: %.2f RPM (setpoint: %.2f RPM)\n",
                calculateMaxAllowedBaseSpeed(), setpointRPM);
     dbg_println("Current position will be the fastest point in the cycle (new algorithm)");
 
     // Publish status update for speed variation enabled change
-    systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_VARIATION_ENABLED_CHANGED, true);
-    systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_VARIATION_PHASE_CHANGED, speedVariationPhase);
-    systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_VARIATION_STRENGTH_CHANGED, speedVariationStrength);
+    publishStatus(StatusUpdateType::SPEED_VARIATION_ENABLED_CHANGED, true);
+    publishStatus(StatusUpdateType::SPEED_VARIATION_PHASE_CHANGED, speedVariationPhase);
+    publishStatus(StatusUpdateType::SPEED_VARIATION_STRENGTH_CHANGED, speedVariationStrength);
     // Success is indicated by the status updates - no notification needed
 }
 
@@ -1222,12 +1492,16 @@ void StepperController::disableSpeedVariationInternal()
 {
     if (!stepper)
     {
-        systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_VARIATION_ENABLED_CHANGED, speedVariationEnabled);
-        systemStatus.sendNotification(NotificationType::ERROR, "Stepper not initialized");
+        publishStatus(StatusUpdateType::SPEED_VARIATION_ENABLED_CHANGED, speedVariationEnabled);
+        notify(NotificationType::ERROR, "Stepper not initialized");
         return;
     }
 
     speedVariationEnabled = false;
+    if (speedVariationAutoTune)
+    {
+        setSpeedVariationAutoTuneInternal(false);
+    }
 
     // Always reset to base speed when disabling variation, regardless of motor state
     // The stepper library will handle the case when motor is disabled
@@ -1237,7 +1511,7 @@ void StepperController::disableSpeedVariationInternal()
     dbg_println("Note: Acceleration remains at current setting for normal operation");
 
     // Publish status update for speed variation enabled change
-    systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_VARIATION_ENABLED_CHANGED, false);
+    publishStatus(StatusUpdateType::SPEED_VARIATION_ENABLED_CHANGED, false);
     // Success is indicated by the status update - no notification needed
 }
 
@@ -1246,88 +1520,346 @@ void StepperController::requestAllStatusInternal()
     dbg_println("Publishing all current status values...");
 
     // Publish all current status values through the status update queue
-    systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_SETPOINT_CHANGED, setpointRPM);
-    systemStatus.publishStatusUpdate(StatusUpdateType::DIRECTION_CHANGED, clockwise);
-    systemStatus.publishStatusUpdate(StatusUpdateType::ENABLED_CHANGED, motorEnabled);
-    systemStatus.publishStatusUpdate(StatusUpdateType::CURRENT_CHANGED, runCurrent);
-    systemStatus.publishStatusUpdate(StatusUpdateType::ACCELERATION_CHANGED, setpointAcceleration);
+    publishStatus(StatusUpdateType::SPEED_SETPOINT_CHANGED, setpointRPM);
+    publishStatus(StatusUpdateType::DIRECTION_CHANGED, clockwise);
+    publishStatus(StatusUpdateType::ENABLED_CHANGED, motorEnabled);
+    publishStatus(StatusUpdateType::CURRENT_CHANGED, runCurrent);
+    publishStatus(StatusUpdateType::ACCELERATION_CHANGED, setpointAcceleration);
+    publishStatus(StatusUpdateType::JERK_LIMIT_CHANGED, jerkLimit);
+    publishStatus(StatusUpdateType::MICROSTEPS_CHANGED, static_cast<int>(engineMicrosteps));
 
     // Speed variation status
-    systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_VARIATION_ENABLED_CHANGED, speedVariationEnabled);
-    systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_VARIATION_STRENGTH_CHANGED, speedVariationStrength);
-    systemStatus.publishStatusUpdate(StatusUpdateType::SPEED_VARIATION_PHASE_CHANGED, speedVariationPhase);
+    publishStatus(StatusUpdateType::SPEED_VARIATION_ENABLED_CHANGED, speedVariationEnabled);
+    publishStatus(StatusUpdateType::SPEED_VARIATION_STRENGTH_CHANGED, speedVariationStrength);
+    publishStatus(StatusUpdateType::SPEED_VARIATION_PHASE_CHANGED, speedVariationPhase);
+    publishStatus(StatusUpdateType::SPEED_VARIATION_AUTO_TUNE_CHANGED, speedVariationAutoTune);
 
     // StallGuard status
-    systemStatus.publishStatusUpdate(StatusUpdateType::STALLGUARD_THRESHOLD_CHANGED, static_cast<int>(stallGuardThreshold));
-    publishStallGuardResult(); // Publish current StallGuard result
+    publishStatus(StatusUpdateType::STALLGUARD_THRESHOLD_CHANGED, static_cast<int>(stallGuardThreshold));
+    publishStatus(StatusUpdateType::STALLGUARD_CALIBRATION_MARGIN_CHANGED, static_cast<int>(sgCalibrationMargin));
+    publishStatus(StatusUpdateType::STALLGUARD_CALIBRATION_ACTIVE, sgCalibrationActive);
 
-    publishTotalRevolutions();
-    publishRuntime();
+    publishFastStatusUpdates(); // Speed, revolutions, runtime and StallGuard result
+    publishLifetimeRevolutions();
     publishTMC2209Communication();
     publishTMC2209Temperature(); // Add temperature status to full status request
     publishStallDetection();
-    publishStallGuardResult();
+    publishLoadMap();
+
+    // Dump loop timing statistics alongside the full status
+    scheduler.logStats();
 }
 
-void StepperController::publishStallGuardResult()
+const char *StepperController::validateTransaction(const StepperTransaction &transaction) const
 {
-    if (!tmc2209Initialized)
+    if (!stepper)
+    {
+        return "Stepper not initialized";
+    }
+    if ((transaction.fields & TRANSACTION_SPEED) &&
+        !(transaction.speed >= MIN_SPEED_RPM && transaction.speed <= MAX_SPEED_RPM))
+    {
+        return "Transaction rejected: speed out of range (0.1-30 RPM)";
+    }
+    if ((transaction.fields & TRANSACTION_ACCELERATION) &&
+        (transaction.acceleration < 100 || transaction.acceleration > 100000))
+    {
+        return "Transaction rejected: acceleration out of range (100-100000 steps/s²)";
+    }
+    if ((transaction.fields & TRANSACTION_VARIATION_STRENGTH) &&
+        !(transaction.variationStrength >= 0.0f && transaction.variationStrength <= 1.0f))
+    {
+        return "Transaction rejected: speed variation strength out of range (0.0-1.0)";
+    }
+    if ((transaction.fields & TRANSACTION_VARIATION_PHASE) && !isfinite(transaction.variationPhase))
+    {
+        return "Transaction rejected: invalid speed variation phase";
+    }
+    return nullptr;
+}
+
+void StepperController::applyTransactionInternal(const StepperTransaction &transaction, uint32_t id)
+{
+    // All values are checked before anything changes - the transaction is applied completely or not at all
+    const char *error = validateTransaction(transaction);
+    if (error)
+    {
+        notify(NotificationType::ERROR, error);
+        publishTransaction(id, false);
+        return;
+    }
+
+    const uint8_t fields = transaction.fields;
+    transactionActive = true;
+
+    // A manual strength or phase overrides the auto-tune, like the single commands
+    const bool variationDisabled = (fields & TRANSACTION_VARIATION_ENABLE) && !transaction.variationEnable;
+    if (speedVariationAutoTune &&
+        ((fields & (TRANSACTION_VARIATION_STRENGTH | TRANSACTION_VARIATION_PHASE)) || variationDisabled))
+    {
+        setSpeedVariationAutoTuneInternal(false);
+    }
+
+    if (fields & TRANSACTION_VARIATION_STRENGTH)
+    {
+        speedVariationStrength = transaction.variationStrength;
+    }
+    if ((fields & TRANSACTION_VARIATION_ENABLE) && transaction.variationEnable && !speedVariationEnabled)
+    {
+        // Same angle reference as ENABLE_SPEED_VARIATION: the current position, phase 0 unless given
+        trackPosition();
+        positionTracker.setRevolutionOrigin();
+        resetLoadMap();
+        resetSpeedScheduleTracking();
+        speedVariationPhase = 0.0f;
+    }
+    if (fields & TRANSACTION_VARIATION_ENABLE)
+    {
+        speedVariationEnabled = transaction.variationEnable;
+    }
+    if (fields & TRANSACTION_VARIATION_PHASE)
     {
-        return; // Skip silently if TMC2209 not initialized
+        const float phase = transaction.variationPhase;
+        speedVariationPhase = fmodf(phase + (phase < 0.0f ? 6.28318530718f : 0.0f), 6.28318530718f);
     }
 
-    // Read StallGuard result from TMC2209 (0-510 per datasheet)
-    uint16_t sgResult = stepperDriver.getStallGuardResult();
+    // The final strength limits the base speed, and base speed and strength set the minimum
+    // acceleration - resolved once for the end state instead of after every single change
+    calculateSpeedVariationK(speedVariationStrength, speedVariationK, speedVariationK0);
 
-    // Publish StallGuard result update directly (no need to cache)
-    systemStatus.publishStatusUpdate(StatusUpdateType::STALLGUARD_RESULT_UPDATE, static_cast<int>(sgResult));
+    float rpm = (fields & TRANSACTION_SPEED) ? transaction.speed : setpointRPM;
+    bool speedWasAdjusted = false;
+    if ((speedVariationEnabled || (fields & TRANSACTION_VARIATION_STRENGTH)) && rpm > calculateMaxAllowedBaseSpeed())
+    {
+        rpm = calculateMaxAllowedBaseSpeed();
+        speedWasAdjusted = (fields & TRANSACTION_SPEED) != 0;
+    }
+    setpointRPM = rpm;
+    rebuildSpeedTable();
+    stepperSetSpeed(rpm); // With speed variation on, the motor speed job takes over from the table
+    resetLoadMap();       // Samples taken under the old speed or profile would read as load ripple
+
+    uint32_t acceleration = (fields & TRANSACTION_ACCELERATION) ? transaction.acceleration : setpointAcceleration;
+    bool accelWasAdjusted = false;
+    const uint32_t minRequiredAcceleration = calculateRequiredAccelerationForVariableSpeed();
+    if (minRequiredAcceleration > acceleration)
+    {
+        acceleration = minRequiredAcceleration;
+        accelWasAdjusted = (fields & TRANSACTION_ACCELERATION) != 0;
+    }
+    stepperSetAcceleration(acceleration);
+    setpointAcceleration = acceleration;
+
+    // Start or stop last, so the motor ramps with the new parameters
+    if (fields & TRANSACTION_ENABLE)
+    {
+        if (transaction.enable)
+        {
+            enableInternal();
+        }
+        else
+        {
+            disableInternal();
+        }
+    }
+
+    transactionActive = false;
+
+    if (!isInitializing)
+    {
+        saveSettings();
+    }
+
+    dbg_printf("Transaction %u applied: %.2f RPM, %u steps/s², variation %s %.2f at %.2f rad, motor %s\n",
+               id, setpointRPM, setpointAcceleration, speedVariationEnabled ? "on" : "off",
+               speedVariationStrength, speedVariationPhase, motorEnabled ? "on" : "off");
+
+    if (speedWasAdjusted || accelWasAdjusted)
+    {
+        char warningMsg[150];
+        snprintf(warningMsg, sizeof(warningMsg),
+                 "Transaction auto-adjusted to %.2f RPM and %u steps/s² due to variable speed modulation limits",
+                 setpointRPM, setpointAcceleration);
+        notify(NotificationType::WARNING, String(warningMsg));
+    }
+
+    publishTransaction(id, true);
+}
+
+void StepperController::publishTransaction(uint32_t id, bool applied)
+{
+    // Single updates as a fallback while the block queue is full (e.g. during a latency dump)
+    if (systemStatus.getStatusBlockSpaces() == 0)
+    {
+        publishStatus(StatusUpdateType::SPEED_SETPOINT_CHANGED, setpointRPM);
+        publishStatus(StatusUpdateType::ACCELERATION_CHANGED, setpointAcceleration);
+        publishStatus(StatusUpdateType::SPEED_VARIATION_STRENGTH_CHANGED, speedVariationStrength);
+        publishStatus(StatusUpdateType::SPEED_VARIATION_PHASE_CHANGED, speedVariationPhase);
+        publishStatus(StatusUpdateType::SPEED_VARIATION_ENABLED_CHANGED, speedVariationEnabled);
+        publishStatus(StatusUpdateType::SPEED_VARIATION_AUTO_TUNE_CHANGED, speedVariationAutoTune);
+        publishStatus(StatusUpdateType::ENABLED_CHANGED, motorEnabled);
+        publishStatus(StatusUpdateType::DIRECTION_CHANGED, clockwise);
+        return;
+    }
+
+    // Layout documented with StatusBlockType::TRANSACTION
+    StatusBlockData block(StatusBlockType::TRANSACTION);
+    block.info = id;
+    block.addValue(applied ? 1 : 0);
+    block.addValue(static_cast<int32_t>(lroundf(setpointRPM * 1000.0f)));
+    block.addValue(static_cast<int32_t>(setpointAcceleration));
+    block.addValue(static_cast<int32_t>(lroundf(speedVariationStrength * 1000.0f)));
+    block.addValue(static_cast<int32_t>(lroundf(speedVariationPhase * 1000.0f)));
+    block.addValue(speedVariationEnabled ? 1 : 0);
+    block.addValue(speedVariationAutoTune ? 1 : 0);
+    block.addValue(motorEnabled ? 1 : 0);
+    block.addValue(clockwise ? 1 : 0);
+
+    block.axis = axis;
+    systemStatus.publishStatusBlock(block);
 }
 
 // Speed variation helper methods
 // Pattern: calculate*() methods perform calculations, update*() methods apply changes only when necessary
-// - calculateVariableSpeed(): Calculate current variable speed based on position
+// - calculateVariableSpeed(): Calculate variable speed at a given angle (used to build the speed table)
+// - rebuildSpeedTable(): Precompute steps/s for every table angle so the 10ms update is a single load
 // - calculateMaxAllowedBaseSpeed(): Calculate maximum base speed for current variation
 // - calculateRequiredAccelerationForVariableSpeed(): Calculate required acceleration
 // - updateSpeedForVariableSpeed(): Update speed only if constraints require reduction
 // - updateAccelerationForVariableSpeed(): Update acceleration only if it differs from current setting
-// - updateSpeedVariationParameters(): Update internal k and k0 parameters
+// - updateSpeedVariationParameters(): Update internal k and k0 parameters and rebuild the speed table
 // Note: Both update methods only apply changes when actually needed for optimal performance
 
-float StepperController::calculateVariableSpeed() const
+void StepperController::calculateSpeedVariationK(float strength, float &k, float &k0)
 {
-    if (!speedVariationEnabled || speedVariationStrength == 0.0f)
+    // Scale external strength (0-1) to internal k parameter
+    // External strength of 1.0 maps to internal k = 3/5 = 0.6
+    k = strength * SPEED_VARIATION_MAX_K;
+
+    // Calculate compensation factor k0 = sqrt(1 - k²)
+    // This ensures the average speed remains w0
+    k0 = sqrtf(1.0f - k * k);
+}
+
+float StepperController::calculateVariableSpeed(float setpointRPM, float k, float k0, float phase, float angle)
+{
+    if (k == 0.0f)
     {
         return setpointRPM;
     }
 
-    // Calculate current angle in the rotation cycle
-    const float angle = getPositionAngle() + speedVariationPhase;
-
-    // Normalize angle to 0-2π (optimized - single modulo operation)
+    // Apply phase offset and normalize angle to 0-2π (single modulo operation)
+    angle += phase;
     const float normalizedAngle = fmodf(angle + (angle < 0.0f ? 6.28318530718f : 0.0f), 6.28318530718f);
 
-    // Use precomputed k and k0 values for efficiency
     // Apply the formula: w(a) = w0 * k0 * 1/(1 + k*cos(a))
-    const float denominator = 1.0f + speedVariationK * cosf(normalizedAngle);
-    const float variableSpeed = setpointRPM * speedVariationK0 / denominator;
+    const float denominator = 1.0f + k * cosf(normalizedAngle);
+    const float variableSpeed = setpointRPM * k0 / denominator;
 
     // Ensure we don't go below minimum or above maximum speed
     return constrain(variableSpeed, MIN_SPEED_RPM, MAX_SPEED_RPM);
 }
 
-float StepperController::getPositionAngle() const
+void StepperController::buildSpeedTable(uint32_t *table, float setpointRPM, float k, float k0, float phase)
+{
+    // Sample each entry at the centre of its angular bin so the quantization error is symmetric
+    const float binAngle = 6.28318530718f / static_cast<float>(SPEED_TABLE_SIZE);
+
+    for (uint16_t i = 0; i < SPEED_TABLE_SIZE; i++)
+    {
+        const float angle = (static_cast<float>(i) + 0.5f) * binAngle;
+        table[i] = rpmToStepsPerSecond(calculateVariableSpeed(setpointRPM, k, k0, phase, angle));
+    }
+}
+
+void StepperController::rebuildSpeedTable()
+{
+    // Use precomputed k and k0 values for efficiency
+    buildSpeedTable(speedTable, setpointRPM, speedVariationK, speedVariationK0, speedVariationPhase);
+
+    speedTableMax = 0;
+    for (uint16_t i = 0; i < SPEED_TABLE_SIZE; i++)
+    {
+        speedTableMax = max(speedTableMax, speedTable[i]);
+    }
+}
+
+uint32_t StepperController::getSpeedVariationPosition()
 {
     if (!stepper)
-        return 0.0f;
+        return 0;
 
-    // Calculate position relative to where speed variation was enabled
-    const int32_t relativePosition = stepper->getCurrentPosition() - speedVariationStartPosition;
+    // Integer position within the revolution that started where variation was enabled;
+    // maintained from the unwrapped 64-bit position so it stays exact on arbitrarily long runs
+    trackPosition();
+    return positionTracker.getRevolutionPosition();
+}
+
+void StepperController::trackPosition()
+{
+    if (stepper)
+    {
+        positionTracker.update(stepper->getCurrentPosition());
+    }
+}
+
+uint64_t StepperController::getLifetimeMicroSteps() const
+{
+    return lifetimeOdometerBase + positionTracker.getOdometer();
+}
+
+void StepperController::saveOdometer()
+{
+    trackPosition();
+    if (getLifetimeMicroSteps() == lastSavedLifetimeMicroSteps)
+    {
+        return;
+    }
+
+    lastSavedLifetimeMicroSteps = getLifetimeMicroSteps();
+    saveSettings();
+    publishLifetimeRevolutions();
+}
+
+void StepperController::publishLifetimeRevolutions()
+{
+    const float lifetimeRevolutions = static_cast<float>(static_cast<double>(getLifetimeMicroSteps()) / TOTAL_MICRO_STEPS_PER_REVOLUTION);
+    publishStatus(StatusUpdateType::LIFETIME_REVOLUTIONS_UPDATE, lifetimeRevolutions);
+}
+
+uint16_t StepperController::getSpeedTableIndex(uint32_t positionInRevolution) const
+{
+    return static_cast<uint16_t>((positionInRevolution * SPEED_TABLE_SIZE) / TOTAL_MICRO_STEPS_PER_REVOLUTION);
+}
+
+uint32_t StepperController::calculateMsToNextSegment(uint32_t positionInRevolution, uint16_t index, uint16_t segmentsPerRevolution) const
+{
+    const int32_t speedMilliHz = getCurrentSpeedInMilliHz();
+    const uint32_t speedHz = static_cast<uint32_t>(abs(speedMilliHz)) / 1000;
+
+    if (speedHz == 0)
+    {
+        // Still ramping up from standstill - fall back to polling
+        return MOTOR_SPEED_UPDATE_INTERVAL;
+    }
+
+    // Microsteps until the shaft leaves the current segment in the direction of travel
+    uint32_t stepsToBoundary;
+    if (speedMilliHz > 0)
+    {
+        const uint32_t nextSegmentStart = ((index + 1UL) * TOTAL_MICRO_STEPS_PER_REVOLUTION + segmentsPerRevolution - 1) / segmentsPerRevolution;
+        stepsToBoundary = nextSegmentStart - positionInRevolution;
+    }
+    else
+    {
+        const uint32_t segmentStart = (static_cast<uint32_t>(index) * TOTAL_MICRO_STEPS_PER_REVOLUTION + segmentsPerRevolution - 1) / segmentsPerRevolution;
+        stepsToBoundary = positionInRevolution - segmentStart + 1;
+    }
 
-    // Convert position to angle using optimized calculation
-    // (2π * relativePosition) / (STEPS_PER_REVOLUTION * MICRO_STEPS * GEAR_RATIO)
-    float stepsPerOutputRev = static_cast<float>(STEPS_PER_REVOLUTION * MICRO_STEPS * GEAR_RATIO);
+    // Round up so we wake just after the boundary rather than just before it
+    const uint32_t msToBoundary = (stepsToBoundary * 1000UL + speedHz - 1) / speedHz;
 
-    return (6.28318530718f * static_cast<float>(relativePosition)) / stepsPerOutputRev;
+    return constrain(msToBoundary, 1UL, static_cast<uint32_t>(MOTOR_SPEED_MAX_UPDATE_INTERVAL));
 }
 
 uint32_t StepperController::calculateRequiredAccelerationForVariableSpeed() const
@@ -1338,36 +1870,36 @@ uint32_t StepperController::calculateRequiredAccelerationForVariableSpeed() cons
     }
 
     // Use precomputed k and k0 values for efficiency
+    const uint32_t requiredAcceleration = calculateRequiredAccelerationForVariableSpeed(speedVariationK, speedVariationK0);
+
+    dbg_printf("Variable speed acceleration calculation (optimized):\n");
+    dbg_printf("  External strength: %.2f (%.0f%%), Internal k: %.3f, k0: %.3f\n",
+               speedVariationStrength, speedVariationStrength * 100.0f, speedVariationK, speedVariationK0);
+    dbg_printf("  Base RPM: %.2f, Speed range: %.2f - %.2f RPM\n",
+               setpointRPM, setpointRPM * speedVariationK0 / (1.0f + speedVariationK),
+               setpointRPM * speedVariationK0 / (1.0f - speedVariationK));
+    dbg_printf("  Required acceleration: %u steps/s² (with 50%% safety margin)\n", requiredAcceleration);
+
+    return requiredAcceleration;
+}
+
+uint32_t StepperController::calculateRequiredAccelerationForVariableSpeed(float k, float k0) const
+{
     // Calculate the minimum and maximum speeds using the new formula
     // w(a) = w0 * k0 * 1/(1 + k*cos(a))
     // Minimum speed occurs when cos(a) = 1: w_min = w0 * k0 / (1 + k)
     // Maximum speed occurs when cos(a) = -1: w_max = w0 * k0 / (1 - k)
-    const float k0_over_1_plus_k = speedVariationK0 / (1.0f + speedVariationK);
-    const float k0_over_1_minus_k = speedVariationK0 / (1.0f - speedVariationK);
-
-    const float minSpeed = constrain(setpointRPM * k0_over_1_plus_k, MIN_SPEED_RPM, MAX_SPEED_RPM);
-    const float maxSpeed = constrain(setpointRPM * k0_over_1_minus_k, MIN_SPEED_RPM, MAX_SPEED_RPM);
+    const float minSpeed = constrain(setpointRPM * k0 / (1.0f + k), MIN_SPEED_RPM, MAX_SPEED_RPM);
+    const float maxSpeed = constrain(setpointRPM * k0 / (1.0f - k), MIN_SPEED_RPM, MAX_SPEED_RPM);
 
     // Calculate the maximum speed change and required acceleration
-    const float maxSpeedChange = maxSpeed - minSpeed;
-    const uint32_t maxSpeedChangeSteps = rpmToStepsPerSecond(maxSpeedChange);
+    const uint32_t maxSpeedChangeSteps = rpmToStepsPerSecond(maxSpeed - minSpeed);
 
     // Calculate time for half a rotation at current RPM: 30/setpointRPM seconds
     const float halfRotationTime = 30.0f / setpointRPM;
 
     // The maximum speed change occurs over half a rotation with 50% safety margin
-    const uint32_t requiredAcceleration = static_cast<uint32_t>((maxSpeedChangeSteps / halfRotationTime) * 1.5f);
-
-    dbg_printf("Variable speed acceleration calculation (optimized):\n");
-    dbg_printf("  External strength: %.2f (%.0f%%), Internal k: %.3f, k0: %.3f\n",
-               speedVariationStrength, speedVariationStrength * 100.0f, speedVariationK, speedVariationK0);
-    dbg_printf("  Base RPM: %.2f, Speed range: %.2f - %.2f RPM (Δ%.2f RPM)\n",
-               setpointRPM, minSpeed, maxSpeed, maxSpeedChange);
-    dbg_printf("  Half rotation time: %.3f seconds\n", halfRotationTime);
-    dbg_printf("  Max speed change: %u steps/s over %.3fs\n", maxSpeedChangeSteps, halfRotationTime);
-    dbg_printf("  Required acceleration: %u steps/s² (with 50%% safety margin)\n", requiredAcceleration);
-
-    return requiredAcceleration;
+    return static_cast<uint32_t>((maxSpeedChangeSteps / halfRotationTime) * 1.5f);
 }
 
 void StepperController::updateAccelerationForVariableSpeed()
@@ -1393,17 +1925,251 @@ void StepperController::updateAccelerationForVariableSpeed()
     }
 }
 
-void StepperController::updateMotorSpeed()
+uint32_t StepperController::updateMotorSpeed()
 {
     if (!stepper || !motorEnabled || !speedVariationEnabled)
+    {
+        return MOTOR_SPEED_UPDATE_INTERVAL;
+    }
+
+    const uint32_t positionInRevolution = getSpeedVariationPosition();
+    const uint16_t index = getSpeedTableIndex(positionInRevolution);
+
+    // Look up the precomputed speed for the current shaft angle
+    stepperSetSpeedInHz(speedTable[index]);
+
+#if SPEED_VARIATION_POSITION_SCHEDULED
+    // The table is piecewise constant in angle, so the next change is due exactly when the
+    // shaft crosses into the next segment - sleep until then instead of polling
+    trackSpeedScheduleWakeup(index);
+    return calculateMsToNextSegment(positionInRevolution, index, SPEED_TABLE_SIZE);
+#else
+    return MOTOR_SPEED_UPDATE_INTERVAL;
+#endif
+}
+
+void StepperController::resetSpeedScheduleTracking()
+{
+    speedScheduleLastIndex = getSpeedTableIndex(getSpeedVariationPosition());
+    speedScheduleSegmentsTraversed = 0;
+    speedScheduleWakeups = 0;
+    speedScheduleRevolutionStart = millis();
+}
+
+void StepperController::trackSpeedScheduleWakeup(uint16_t index)
+{
+    speedScheduleWakeups++;
+
+    // Count segments passed in either direction (shortest distance around the table)
+    const uint16_t forward = (index + SPEED_TABLE_SIZE - speedScheduleLastIndex) % SPEED_TABLE_SIZE;
+    const uint16_t backward = (speedScheduleLastIndex + SPEED_TABLE_SIZE - index) % SPEED_TABLE_SIZE;
+    speedScheduleSegmentsTraversed += min(forward, backward);
+    speedScheduleLastIndex = index;
+
+    if (speedScheduleSegmentsTraversed < SPEED_TABLE_SIZE)
     {
         return;
     }
 
-    // Calculate current variable speed
-    float currentVariableSpeed = calculateVariableSpeed();
+    // One full revolution done - compare against what fixed-interval polling would have cost
+    const unsigned long revolutionTime = millis() - speedScheduleRevolutionStart;
+    const int polledWakeups = static_cast<int>(revolutionTime / MOTOR_SPEED_UPDATE_INTERVAL);
+    const int wakeupsSaved = polledWakeups - static_cast<int>(speedScheduleWakeups);
+
+    dbg_printf("Speed schedule: %u wakeups this revolution vs %d polled (%d saved)\n",
+               speedScheduleWakeups, polledWakeups, wakeupsSaved);
+    publishStatus(StatusUpdateType::SPEED_SCHEDULE_WAKEUPS_SAVED, wakeupsSaved);
+
+    speedScheduleSegmentsTraversed = 0;
+    speedScheduleWakeups = 0;
+    speedScheduleRevolutionStart = millis();
+}
+
+uint8_t StepperController::getLoadMapBin(uint32_t positionInRevolution) const
+{
+    return static_cast<uint8_t>((positionInRevolution * LOAD_MAP_BINS) / TOTAL_MICRO_STEPS_PER_REVOLUTION);
+}
+
+uint32_t StepperController::updateLoadMap()
+{
+    // Consume the sample the driver I/O task took for the previous request (tagged with its bin)
+    const DriverDiagnostics &diagnostics = driver.getDiagnostics();
+    if (diagnostics.sampleSequence != loadMapLastSequence)
+    {
+        loadMapLastSequence = diagnostics.sampleSequence;
+        loadMap.addSample(diagnostics.sampleTag, diagnostics.sampleStallGuardResult);
+
+        if (sgCalibrationCollecting)
+        {
+            sgCalibration.addSample(diagnostics.sampleStallGuardResult);
+        }
+    }
+
+    // SG_RESULT only reflects the load while the motor is turning
+    if (!stepper || !motorEnabled || !tmc2209Initialized || !stepper->isRunning())
+    {
+        loadMapLastBin = LOAD_MAP_BINS;
+        return LOAD_MAP_IDLE_INTERVAL;
+    }
 
-    stepperSetSpeed(currentVariableSpeed);
+    // One sample per bin, taken as the shaft enters it (same angle frame as the speed table)
+    const uint32_t positionInRevolution = getSpeedVariationPosition();
+    const uint8_t bin = getLoadMapBin(positionInRevolution);
+    if (bin != loadMapLastBin)
+    {
+        loadMapLastBin = bin;
+        driver.requestStallGuardSample(bin);
+    }
+
+    return calculateMsToNextSegment(positionInRevolution, bin, LOAD_MAP_BINS);
+}
+
+void StepperController::resetLoadMap()
+{
+    loadMap.reset();
+    loadMapLastBin = LOAD_MAP_BINS;
+}
+
+void StepperController::publishLoadMap()
+{
+    StatusBlockData block(StatusBlockType::LOAD_MAP);
+    block.info = loadMap.getTotalSamples();
+    for (uint8_t bin = 0; bin < LOAD_MAP_BINS; bin++)
+    {
+        block.addValue(loadMap.hasSamples(bin) ? static_cast<int32_t>(loadMap.getValue(bin)) : -1);
+    }
+
+    block.axis = axis;
+    systemStatus.publishStatusBlock(block);
+}
+
+void StepperController::setSpeedVariationAutoTuneInternal(bool enabled)
+{
+    if (!stepper)
+    {
+        publishStatus(StatusUpdateType::SPEED_VARIATION_AUTO_TUNE_CHANGED, speedVariationAutoTune);
+        notify(NotificationType::ERROR, "Stepper not initialized");
+        return;
+    }
+
+    speedVariationAutoTune = enabled;
+    autoTuneSteps = 0;
+
+    if (enabled)
+    {
+        // The tune acts through the speed variation profile, so it has to be running
+        if (!speedVariationEnabled)
+        {
+            enableSpeedVariationInternal();
+        }
+        resetLoadMap();
+        dbg_println("Speed variation auto-tune enabled");
+    }
+    else
+    {
+        dbg_printf("Speed variation auto-tune disabled (strength: %.2f, phase: %.2f rad)\n",
+                   speedVariationStrength, speedVariationPhase);
+    }
+
+    publishStatus(StatusUpdateType::SPEED_VARIATION_AUTO_TUNE_CHANGED, enabled);
+}
+
+void StepperController::updateAutoTune()
+{
+    // Wait until every bin was refreshed under the current parameters
+    if (loadMap.getMinSampleCount() < AUTO_TUNE_MIN_BIN_SAMPLES)
+    {
+        return;
+    }
+
+    float meanSg, rippleSg, peakAngle;
+    if (!loadMap.fitFirstHarmonic(meanSg, rippleSg, peakAngle) || meanSg < AUTO_TUNE_MIN_MEAN_SG)
+    {
+        resetLoadMap();
+        return;
+    }
+
+    const float relativeRipple = rippleSg / meanSg;
+    publishStatus(StatusUpdateType::LOAD_RIPPLE_UPDATE, relativeRipple);
+
+    if (relativeRipple < AUTO_TUNE_RIPPLE_TOLERANCE)
+    {
+        // Flat enough - keep the parameters but keep watching (the load shifts as the roast cooks)
+        resetLoadMap();
+        return;
+    }
+
+    // SG_RESULT (StallGuard4 back-EMF) is roughly proportional to speed and falls with load. A profile with
+    // internal k adds a relative SG ripple of about k with its trough at the slowest point (angle = -phase);
+    // the load adds one with its trough on the heavy side. The remaining ripple peaks where SG is too high,
+    // so move the slowest point towards that angle: represent the profile as the vector k * e^(-i*phase)
+    // and add the ripple vector to it. A full step (relative ripple -> k) cancels the first harmonic;
+    // AUTO_TUNE_GAIN takes part of it, so a load whose SG responds more steeply than linear still settles.
+    const float currentSlowAngle = -speedVariationPhase;
+    const float step = AUTO_TUNE_GAIN * relativeRipple / SPEED_VARIATION_MAX_K; // k -> strength units
+    float x = speedVariationStrength * cosf(currentSlowAngle) + step * cosf(peakAngle);
+    float y = speedVariationStrength * sinf(currentSlowAngle) + step * sinf(peakAngle);
+
+    const float strength = min(sqrtf(x * x + y * y), calculateMaxAutoTuneStrength());
+    const float phase = -atan2f(y, x);
+
+    if (fabsf(strength - speedVariationStrength) < AUTO_TUNE_MIN_CHANGE &&
+        fabsf(remainderf(phase - speedVariationPhase, 6.28318530718f)) < AUTO_TUNE_MIN_CHANGE)
+    {
+        // Held at the strength limit with the slowest point where it is - nothing new to apply or publish
+        resetLoadMap();
+        return;
+    }
+
+    autoTuneSteps++;
+    dbg_printf("Auto-tune step %u: SG mean %.1f, ripple %.1f%% peaking at %.0f° -> strength %.2f, phase %.0f°\n",
+               autoTuneSteps, meanSg, relativeRipple * 100.0f, peakAngle * 180.0f / PI,
+               strength, phase * 180.0f / PI);
+
+    applyAutoTuneParameters(strength, phase);
+
+    // Measure the effect of the new profile from scratch
+    resetLoadMap();
+}
+
+float StepperController::calculateMaxAutoTuneStrength() const
+{
+    // Both limits tighten monotonically with k - bisect for the largest strength that satisfies them
+    // without lowering the user's setpoint
+    float low = 0.0f;
+    float high = 1.0f;
+
+    for (uint8_t i = 0; i < 12; i++)
+    {
+        const float strength = (low + high) * 0.5f;
+        float k, k0;
+        calculateSpeedVariationK(strength, k, k0);
+
+        if (calculateMaxAllowedBaseSpeed(k, k0) >= setpointRPM &&
+            calculateRequiredAccelerationForVariableSpeed(k, k0) <= AUTO_TUNE_MAX_ACCELERATION)
+        {
+            low = strength;
+        }
+        else
+        {
+            high = strength;
+        }
+    }
+
+    return low;
+}
+
+void StepperController::applyAutoTuneParameters(float strength, float phase)
+{
+    speedVariationStrength = constrain(strength, 0.0f, 1.0f);
+    speedVariationPhase = fmodf(phase + (phase < 0.0f ? 6.28318530718f : 0.0f), 6.28318530718f);
+    updateSpeedVariationParameters();
+
+    // The strength is already capped to the acceleration limit - raise the setting if the new profile needs it
+    updateAccelerationForVariableSpeed();
+
+    publishStatus(StatusUpdateType::SPEED_VARIATION_STRENGTH_CHANGED, speedVariationStrength);
+    publishStatus(StatusUpdateType::SPEED_VARIATION_PHASE_CHANGED, speedVariationPhase);
 }
 
 void StepperController::updateSpeedForVariableSpeed()
@@ -1433,13 +2199,10 @@ void StepperController::updateSpeedForVariableSpeed()
 
 void StepperController::updateSpeedVariationParameters()
 {
-    // Scale external strength (0-1) to internal k parameter
-    // External strength of 1.0 maps to internal k = 3/5 = 0.6
-    speedVariationK = speedVariationStrength * 0.6f;
+    calculateSpeedVariationK(speedVariationStrength, speedVariationK, speedVariationK0);
 
-    // Calculate compensation factor k0 = sqrt(1 - k²)
-    // This ensures the average speed remains w0
-    speedVariationK0 = sqrtf(1.0f - speedVariationK * speedVariationK);
+    // Strength, phase and setpoint all feed into the table, so rebuild it here only
+    rebuildSpeedTable();
 }
 
 float StepperController::calculateMaxAllowedBaseSpeed() const
@@ -1449,12 +2212,17 @@ float StepperController::calculateMaxAllowedBaseSpeed() const
         return MAX_SPEED_RPM; // No modulation, full speed allowed
     }
 
+    return calculateMaxAllowedBaseSpeed(speedVariationK, speedVariationK0);
+}
+
+float StepperController::calculateMaxAllowedBaseSpeed(float k, float k0) const
+{
     // Calculate max allowed base speed so that the peak modulated speed doesn't exceed MAX_SPEED_RPM
     // Maximum speed occurs when cos(a) = -1: w_max = w0 * k0 / (1 - k)
     // Solving for w0: w0 = w_max * (1 - k) / k0
     // Where w_max should not exceed MAX_SPEED_RPM
 
-    float maxAllowedBaseSpeed = MAX_SPEED_RPM * (1.0f - speedVariationK) / speedVariationK0;
+    float maxAllowedBaseSpeed = MAX_SPEED_RPM * (1.0f - k) / k0;
 
     // Ensure it's at least the minimum speed
     maxAllowedBaseSpeed = max(maxAllowedBaseSpeed, MIN_SPEED_RPM);
@@ -1469,16 +2237,321 @@ void StepperController::setStallGuardThresholdInternal(uint8_t threshold)
     
     if (!tmc2209Initialized)
     {
-        systemStatus.publishStatusUpdate(StatusUpdateType::STALLGUARD_THRESHOLD_CHANGED, stallGuardThreshold);
-        systemStatus.sendNotification(NotificationType::ERROR, "TMC2209 not initialized - cannot set StallGuard threshold");
+        publishStatus(StatusUpdateType::STALLGUARD_THRESHOLD_CHANGED, stallGuardThreshold);
+        notify(NotificationType::ERROR, "TMC2209 not initialized - cannot set StallGuard threshold");
         return;
     }
 
     stallGuardThreshold = threshold;
-    stepperDriver.setStallGuardThreshold(threshold);
+    driver.setStallGuardThreshold(threshold);
+    applyDriverRegisters();
 
     info_printf("StallGuard threshold set to %d (0=least sensitive, 255=most sensitive)\n", threshold);
 
     // Publish status update for StallGuard threshold change
-    systemStatus.publishStatusUpdate(StatusUpdateType::STALLGUARD_THRESHOLD_CHANGED, threshold);
+    publishStatus(StatusUpdateType::STALLGUARD_THRESHOLD_CHANGED, threshold);
+}
+
+void StepperController::startStallGuardCalibrationInternal(int revolutions)
+{
+    if (revolutions < 1 || revolutions > SG_CALIBRATION_MAX_REVOLUTIONS)
+    {
+        notify(NotificationType::ERROR, "Calibration revolutions out of range (1-20)");
+        return;
+    }
+
+    if (!stepper || !tmc2209Initialized)
+    {
+        publishStatus(StatusUpdateType::STALLGUARD_CALIBRATION_ACTIVE, false);
+        notify(NotificationType::ERROR, "TMC2209 not initialized - cannot calibrate StallGuard");
+        return;
+    }
+
+    // Run at the current setpoint; start the motor if needed and stop it again afterwards
+    sgCalibrationStartedMotor = sgCalibrationActive ? sgCalibrationStartedMotor : !motorEnabled;
+    if (!motorEnabled)
+    {
+        enableInternal();
+    }
+
+    sgCalibration.reset();
+    sgCalibrationActive = true;
+    sgCalibrationCollecting = false;
+    sgCalibrationRevolutions = static_cast<uint8_t>(revolutions);
+    sgCalibrationStartTime = millis();
+
+    dbg_printf("StallGuard calibration started: %d revolutions at %.2f RPM, margin %u%%\n",
+               revolutions, setpointRPM, sgCalibrationMargin);
+    publishStatus(StatusUpdateType::STALLGUARD_CALIBRATION_ACTIVE, true);
+}
+
+void StepperController::setStallGuardCalibrationMarginInternal(int marginPercent)
+{
+    if (marginPercent < 0 || marginPercent > 90)
+    {
+        publishStatus(StatusUpdateType::STALLGUARD_CALIBRATION_MARGIN_CHANGED, static_cast<int>(sgCalibrationMargin));
+        notify(NotificationType::ERROR, "Calibration margin out of range (0-90%)");
+        return;
+    }
+
+    sgCalibrationMargin = static_cast<uint8_t>(marginPercent);
+    saveSettings();
+
+    publishStatus(StatusUpdateType::STALLGUARD_CALIBRATION_MARGIN_CHANGED, marginPercent);
+}
+
+void StepperController::updateStallGuardCalibration()
+{
+    if (!motorEnabled)
+    {
+        // Stopped by the user or an emergency stop
+        notify(NotificationType::WARNING, "StallGuard calibration cancelled - motor stopped");
+        finishStallGuardCalibration(false);
+        return;
+    }
+
+    const unsigned long elapsed = millis() - sgCalibrationStartTime;
+
+    if (!sgCalibrationCollecting)
+    {
+        // Let the motor reach the setpoint before trusting SG_RESULT
+        if (elapsed >= SG_CALIBRATION_SETTLE_TIME)
+        {
+            sgCalibrationCollecting = true;
+            trackPosition();
+            sgCalibrationStartOdometer = positionTracker.getOdometer();
+        }
+        return;
+    }
+
+    trackPosition();
+    const uint64_t travelled = positionTracker.getOdometer() - sgCalibrationStartOdometer;
+
+    if (travelled < static_cast<uint64_t>(sgCalibrationRevolutions) * TOTAL_MICRO_STEPS_PER_REVOLUTION &&
+        elapsed < SG_CALIBRATION_MAX_DURATION)
+    {
+        return;
+    }
+
+    if (sgCalibration.getSampleCount() < SG_CALIBRATION_MIN_SAMPLES)
+    {
+        notify(NotificationType::WARNING, "StallGuard calibration collected too few samples - threshold unchanged");
+        finishStallGuardCalibration(false);
+        return;
+    }
+
+    finishStallGuardCalibration(true);
+}
+
+void StepperController::finishStallGuardCalibration(bool success)
+{
+    sgCalibrationActive = false;
+    sgCalibrationCollecting = false;
+
+    if (sgCalibrationStartedMotor)
+    {
+        sgCalibrationStartedMotor = false;
+        applyStop();
+    }
+
+    if (success)
+    {
+        const uint8_t threshold = sgCalibration.calculateThreshold(sgCalibrationMargin);
+
+        dbg_printf("StallGuard calibration: %u samples, min %u, mean %u, p50 %u, max %u -> threshold %u\n",
+                   sgCalibration.getSampleCount(), sgCalibration.getMin(), sgCalibration.getMean(),
+                   sgCalibration.getPercentile(50), sgCalibration.getMax(), threshold);
+
+        setStallGuardThresholdInternal(threshold);
+        saveSettings();
+        publishStallGuardCalibration(threshold);
+    }
+
+    publishStatus(StatusUpdateType::STALLGUARD_CALIBRATION_ACTIVE, false);
+}
+
+void StepperController::publishStallGuardCalibration(uint8_t threshold)
+{
+    StatusBlockData block(StatusBlockType::STALLGUARD_CALIBRATION);
+    block.info = sgCalibration.getSampleCount();
+
+    // Layout documented with StatusBlockType::STALLGUARD_CALIBRATION
+    block.addValue(sgCalibration.getMin());
+    block.addValue(sgCalibration.getMean());
+    block.addValue(sgCalibration.getPercentile(5));
+    block.addValue(sgCalibration.getPercentile(50));
+    block.addValue(sgCalibration.getPercentile(95));
+    block.addValue(sgCalibration.getMax());
+    block.addValue(threshold);
+    block.addValue(sgCalibrationMargin);
+    for (uint8_t bucket = 0; bucket < SG_CALIBRATION_REPORT_BUCKETS; bucket++)
+    {
+        block.addValue(static_cast<int32_t>(sgCalibration.getReportBucket(bucket)));
+    }
+
+    block.axis = axis;
+    systemStatus.publishStatusBlock(block);
+}
+
+uint16_t StepperController::selectMicrosteps(float rpm, uint16_t currentMicrosteps)
+{
+    size_t band = 0;
+    while (band < MICROSTEP_BAND_COUNT - 1 && rpm > MICROSTEP_BANDS[band].maxRPM)
+    {
+        band++;
+    }
+
+    // Only drop into a finer band once clearly inside it, so a speed near a band edge does not toggle
+    if (MICROSTEP_BANDS[band].microsteps > currentMicrosteps && band < MICROSTEP_BAND_COUNT - 1 &&
+        rpm > MICROSTEP_BANDS[band].maxRPM * MICROSTEP_BAND_HYSTERESIS)
+    {
+        band++;
+    }
+    return MICROSTEP_BANDS[band].microsteps;
+}
+
+float StepperController::calculateMaxCommandedRPM() const
+{
+    // The commanded target: the fastest table entry while the speed varies over a revolution
+    uint32_t targetStepsPerSecond = rpmToStepsPerSecond(setpointRPM);
+    if (speedVariationEnabled)
+    {
+        targetStepsPerSecond = max(targetStepsPerSecond, speedTableMax);
+    }
+
+    // While slowing down, the actual speed is still higher - stay coarse until it has come down
+    const uint32_t currentStepsPerSecond = motorEnabled || stepper->isRunning() ? static_cast<uint32_t>(abs(getCurrentSpeedInMilliHz()) / 1000) : 0;
+
+    const float stepsPerOutputRevolution = static_cast<float>(TOTAL_MICRO_STEPS_PER_REVOLUTION);
+    return max(targetStepsPerSecond, currentStepsPerSecond) * 60.0f / stepsPerOutputRevolution;
+}
+
+uint32_t StepperController::updateMicrostepResolution()
+{
+    if (!stepper)
+    {
+        return MICROSTEP_UPDATE_INTERVAL;
+    }
+
+    if (pendingMicrosteps != 0)
+    {
+        return confirmMicrostepResolution();
+    }
+
+    if (microstepSwitchSettling)
+    {
+        // The step rate has been re-expressed at the new resolution - back to the normal ramp
+        microstepSwitchSettling = false;
+        reprogramStepper();
+    }
+
+    // A stop ramp has no speed target to rescale against - switch once at standstill
+    if (!motorEnabled && stepper->isRunning())
+    {
+        return MICROSTEP_UPDATE_INTERVAL;
+    }
+
+    const uint16_t microsteps = selectMicrosteps(calculateMaxCommandedRPM(), engineMicrosteps);
+    if (microsteps == engineMicrosteps)
+    {
+        return MICROSTEP_UPDATE_INTERVAL;
+    }
+
+    if (!motorEnabled)
+    {
+        // Output stage off and no pulses: nothing moves at either resolution, and CHOPCONF reaches
+        // the driver before the TOFF write that enables it again
+        driver.setMicrostepsPerStep(microsteps);
+        applyDriverRegisters();
+        trackPosition();
+        applyMicrostepResolution(microsteps, stepper->getCurrentPosition());
+        return MICROSTEP_UPDATE_INTERVAL;
+    }
+
+    requestMicrostepResolution(microsteps);
+    return MICROSTEP_CONFIRM_POLL;
+}
+
+void StepperController::requestMicrostepResolution(uint16_t microsteps)
+{
+    // The driver I/O task writes MRES some time later. Until it has acknowledged the write, the step
+    // generator keeps its rate and the position tracker its scale; nothing reprograms the engine.
+    trackPosition();
+    pendingMicrosteps = microsteps;
+    microstepRequestMs = millis();
+    microstepRequestUs = micros();
+    microstepRequestPosition = stepper->getCurrentPosition();
+
+    driver.setMicrostepsPerStep(microsteps);
+    applyDriverRegisters();
+}
+
+uint32_t StepperController::confirmMicrostepResolution()
+{
+    const DriverDiagnostics &diagnostics = driver.getDiagnostics();
+    const bool acknowledged = diagnostics.appliedMicrosteps == pendingMicrosteps &&
+                              static_cast<int32_t>(diagnostics.microstepsAppliedUs - microstepRequestUs) >= 0;
+
+    if (acknowledged)
+    {
+        // Pulses since the write already moved the shaft at the new resolution: estimate where the
+        // driver switched from the current rate, bounded by the movement since the request
+        trackPosition();
+        const int32_t position = stepper->getCurrentPosition();
+        const int32_t sinceWriteUs = static_cast<int32_t>(micros() - diagnostics.microstepsAppliedUs);
+        const int32_t sinceRequest = position - microstepRequestPosition;
+        int32_t sinceSwitch = static_cast<int32_t>(static_cast<int64_t>(stepper->getCurrentSpeedInMilliHz()) * sinceWriteUs / 1000000000LL);
+        sinceSwitch = sinceRequest >= 0 ? constrain(sinceSwitch, 0, sinceRequest) : constrain(sinceSwitch, sinceRequest, 0);
+
+        const uint16_t microsteps = pendingMicrosteps;
+        pendingMicrosteps = 0;
+        applyMicrostepResolution(microsteps, position - sinceSwitch);
+        return microstepSwitchSettling ? MICROSTEP_SWITCH_TIME : MICROSTEP_UPDATE_INTERVAL;
+    }
+
+    if (millis() - microstepRequestMs < MICROSTEP_CONFIRM_TIMEOUT)
+    {
+        return MICROSTEP_CONFIRM_POLL;
+    }
+
+    dbg_printf("WARNING: Driver did not acknowledge %u microsteps - staying at %u\n", pendingMicrosteps, engineMicrosteps);
+    pendingMicrosteps = 0;
+    driver.setMicrostepsPerStep(engineMicrosteps);
+    applyDriverRegisters();
+    reprogramStepper();
+    return MICROSTEP_UPDATE_INTERVAL;
+}
+
+void StepperController::applyMicrostepResolution(uint16_t microsteps, int32_t rawSwitchPosition)
+{
+    // Count everything moved so far at the old resolution
+    trackPosition();
+    const uint32_t speedHz = static_cast<uint32_t>(abs(getCurrentSpeedInMilliHz()) / 1000);
+    const uint16_t previousMicrosteps = engineMicrosteps;
+
+    // The driver changes MRES in place (its 1/256 sequencer position is kept), so the shaft does not
+    // move; the position tracker keeps the fraction of a MICRO_STEPS unit across the change
+    engineMicrosteps = microsteps;
+    positionTracker.setRawScaleAt(rawSwitchPosition, engineMicrosteps, MICRO_STEPS);
+
+    if (motorEnabled && stepper->isRunning())
+    {
+        // Same shaft speed at the new resolution: jump the step rate within MICROSTEP_SWITCH_TIME,
+        // then the microstep job restores the configured ramp
+        const uint32_t previousRate = static_cast<uint32_t>(static_cast<uint64_t>(speedHz) * previousMicrosteps / MICRO_STEPS);
+        const uint32_t rate = toEngineSteps(speedHz);
+        const uint32_t rateChange = rate > previousRate ? rate - previousRate : previousRate - rate;
+        stepper->setAcceleration(max(rateChange * (1000 / MICROSTEP_SWITCH_TIME), 1u));
+        stepper->setSpeedInHz(max(rate, 1u));
+        applyEngineSpeedAcceleration();
+        microstepSwitchSettling = true;
+        scheduler.rescheduleIn(speedRampJobId, MICROSTEP_SWITCH_TIME);
+    }
+    else
+    {
+        reprogramStepper(); // At rest - the next run*() starts at the new resolution
+    }
+
+    dbg_printf("Microstep resolution %u -> %u (%.2f RPM)\n", previousMicrosteps, microsteps, calculateCurrentRPM());
+    publishStatus(StatusUpdateType::MICROSTEPS_CHANGED, static_cast<int>(microsteps));
 }
@@ -1,12 +1,16 @@
 #ifndef STEPPER_CONTROLLER_H
 #define STEPPER_CONTROLLER_H
 
-#include "FastAccelStepper.h"
-#include <TMC2209.h>
-#include <Preferences.h>
+#include "IStepperBackend.h"
+#include "IDriverBackend.h"
+#include "SettingsStore.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
-#include "Task.h"
+#include "DeadlineScheduler.h"
+#include "LoadMap.h"
+#include "PositionTracker.h"
+#include "SCurveRamp.h"
+#include "StallGuardCalibration.h"
 #include "SystemStatus.h"
 #include "SystemCommand.h"
 #include "PowerDeliveryTask.h"
@@ -25,10 +29,33 @@ class PowerDeliveryTask;
 #define TMC_RX_PIN 18
 #define DIAG_PIN 16
 
+// Axis table - every axis shares the step engine and the TMC2209 UART bus. Axis 0 is the
+// on-board driver (main spit); side skewers use external TMC2209 boards strapped to
+// serial addresses 1-3 (pins below are the expansion header wiring, adjust to the build).
+#define STEPPER_AXIS_COUNT 1  // Fitted axes (1-STEPPER_MAX_AXES)
+#define STEPPER_PIN_NONE 0xFF // No DIAG line wired (no stall detection on that axis)
+
+struct StepperAxisConfig
+{
+    const char *name; // Used in notifications and logs
+    uint8_t stepPin;
+    uint8_t dirPin;
+    uint8_t enablePin;
+    uint8_t diagPin;
+    uint8_t serialAddress; // TMC2209 UART address (MS1/MS2 straps)
+};
+
+static const StepperAxisConfig STEPPER_AXES[STEPPER_MAX_AXES] = {
+    {"spit", STEP_PIN, DIR_PIN, TMC_EN_PIN, DIAG_PIN, 0},
+    {"skewer 1", 8, 9, 10, 11, 1},
+    {"skewer 2", 12, 13, 14, 39, 2},
+    {"skewer 3", 40, 41, 42, STEPPER_PIN_NONE, 3},
+};
+
 // Motor specifications
 #define STEPS_PER_REVOLUTION 200                                                           // NEMA 17
 #define GEAR_RATIO 10                                                                      // 1:10 reduction
-#define MICRO_STEPS 16                                                                     // Fixed at 16 microsteps
+#define MICRO_STEPS 16                                                                     // Reference resolution: positions, speeds and the odometer are counted in 1/16 steps
 #define TOTAL_MICRO_STEPS_PER_REVOLUTION (STEPS_PER_REVOLUTION * GEAR_RATIO * MICRO_STEPS) // Total microsteps per output revolution
 
 // Speed settings (in RPM)
@@ -40,19 +67,81 @@ class PowerDeliveryTask;
 #define STALL_UPDATE_INTERVAL 1000     // Status update every 500ms
 #define TMC_UPDATE_INTERVAL 2000       // Status update every 500ms
 #define MOTOR_SPEED_UPDATE_INTERVAL 10 // Speed update every 50ms for smooth variation
+#define LOAD_MAP_IDLE_INTERVAL 100       // Load map job poll interval while the motor is not turning
+#define LOAD_MAP_PUBLISH_INTERVAL 5000   // Load map block published every 5s while sampling
+#define ODOMETER_SAVE_INTERVAL 600000   // Lifetime odometer persisted every 10 minutes while moving (and on stop)
+#define DRIVER_IO_STARTUP_TIMEOUT 500  // Max wait for the first driver diagnostics snapshot during begin()
+
+// Speed variation auto-tune
+#define SPEED_VARIATION_MAX_K 0.6f          // Internal k at strength 1.0
+#define AUTO_TUNE_MIN_BIN_SAMPLES 2         // Samples in every load map bin before a tuning step (~2 revolutions)
+#define AUTO_TUNE_GAIN 0.7f                 // Share of the estimated full correction applied per tuning step
+#define AUTO_TUNE_RIPPLE_TOLERANCE 0.03f    // Relative SG ripple regarded as flat - no further adjustment
+#define AUTO_TUNE_MIN_CHANGE 0.005f         // Smaller strength (and phase, rad) changes are not applied
+#define AUTO_TUNE_MIN_MEAN_SG 20.0f         // Mean SG_RESULT below this is too close to stall to act on
+#define AUTO_TUNE_MAX_ACCELERATION 100000   // Same upper bound as SET_ACCELERATION
+
+// StallGuard threshold calibration
+#define SG_CALIBRATION_DEFAULT_MARGIN 30     // Percent below the lowest SG_RESULT seen while running
+#define SG_CALIBRATION_MAX_REVOLUTIONS 20
+#define SG_CALIBRATION_SETTLE_TIME 1000      // Ignore samples while the motor ramps up (ms)
+#define SG_CALIBRATION_MAX_DURATION 55000    // Finish early after this long, even if fewer revolutions were done (ms)
+#define SG_CALIBRATION_MIN_SAMPLES 32        // Fewer samples than this is not a usable calibration
+
+// Speed variation lookup table
+#define SPEED_TABLE_SIZE 256 // Entries per output revolution (~1.4° per entry)
+
+// Speed variation scheduling: 1 = wake exactly when the shaft crosses into the next table segment,
+// 0 = poll the position every MOTOR_SPEED_UPDATE_INTERVAL
+#define SPEED_VARIATION_POSITION_SCHEDULED 1
+#define MOTOR_SPEED_MAX_UPDATE_INTERVAL 1000 // Upper bound for a scheduled segment wait (ms)
+
+// Jerk-limited (S-curve) speed ramps - 0 keeps FastAccelStepper's constant-acceleration ramps
+#define SPEED_RAMP_UPDATE_INTERVAL 5     // S-curve step while a speed change is in progress (ms); parked while settled
+#define MAX_JERK_LIMIT 10000000          // steps/s³
+
+// Dynamic microstepping: the driver resolution follows the speed (fine and smooth when slow, fewer
+// step interrupts when fast). The controller keeps counting in MICRO_STEPS units; only the step
+// generator runs at the driver resolution. 0 = the driver always runs at MICRO_STEPS.
+#define DYNAMIC_MICROSTEPPING 1
+#define MICROSTEP_UPDATE_INTERVAL 100    // Speed band check (ms)
+#define MICROSTEP_BAND_HYSTERESIS 0.9f   // Back to a finer band only below 90% of its upper speed
+#define MICROSTEP_SWITCH_TIME 2          // The step rate is re-expressed at the new resolution within this time (ms)
+#define MICROSTEP_CONFIRM_POLL 1         // Poll for the driver's MRES acknowledgement while running (ms)
+#define MICROSTEP_CONFIRM_TIMEOUT 100    // Keep the old resolution if the driver has not acknowledged by then (ms)
 
-class StepperController : public Task
+struct MicrostepBand
+{
+    float maxRPM; // Upper output speed of the band
+    uint16_t microsteps;
+};
+
+// Step rate stays below ~4.3 kHz up to 8 RPM and 8 kHz at MAX_SPEED_RPM (16 µsteps: 16 kHz)
+static const MicrostepBand MICROSTEP_BANDS[] = {
+    {2.0f, 64},
+    {4.0f, 32},
+    {8.0f, 16},
+    {MAX_SPEED_RPM, 8},
+};
+#define MICROSTEP_BAND_COUNT (sizeof(MICROSTEP_BANDS) / sizeof(MICROSTEP_BANDS[0]))
+
+// One motor axis. All axes run on the stepper task (see StepperTask), which owns the backends:
+// step generation and the driver are reached only through IStepperBackend / IDriverBackend, so the
+// same controller runs on FastAccelStepper + TMC2209 hardware or on the simulated backends of a host build.
+class StepperController
 {
 private:
+    const uint8_t axis;               // Index into STEPPER_AXES, also the driver I/O channel and settings record
+    const StepperAxisConfig &config;
     bool isInitializing; // True during construction/initialization, false otherwise
-    // FastAccelStepper engine and stepper
-    FastAccelStepperEngine engine;
-    FastAccelStepper *stepper;
+    // Step generation - nullptr until the backend has been started in begin()
+    IStepperBackend *stepper;
+    IStepperBackend &stepperBackend;
 
-    // TMC2209 stepper driver
-    TMC2209 stepperDriver;
-    HardwareSerial &serialStream;
-    Preferences preferences;
+    // TMC2209 stepper driver - this task only sets desired register values and reads the
+    // diagnostics snapshot; the backend decides how (and on which task) the driver is reached
+    IDriverBackend &driver;
+    SettingsStore &settingsStore;
 
     // Speed settings (in RPM)
     float setpointRPM; // Target RPM set by user/command
@@ -62,14 +151,27 @@ private:
     bool motorEnabled;
     bool clockwise;
     unsigned long startTime;
-    unsigned long totalMicroSteps;
     bool isFirstStart;
     bool tmc2209Initialized; // Track TMC2209 driver initialization status
-    bool powerDeliveryReady; // Track if power delivery negotiation is complete
 
     // Stall detection
     bool stallDetected;
     uint16_t stallCount;
+    uint32_t lastStallNotificationTime;
+
+    // Temperature notifications (only sent on changes)
+    int lastTemperatureStatus;
+    bool lastOverTemperatureShutdown;
+
+    // StallGuard threshold calibration run
+    StallGuardCalibration sgCalibration;
+    bool sgCalibrationActive;
+    bool sgCalibrationStartedMotor;         // Motor was enabled by the calibration and is stopped afterwards
+    bool sgCalibrationCollecting;           // Past the settle time
+    uint8_t sgCalibrationRevolutions;       // Requested revolutions
+    uint8_t sgCalibrationMargin;            // Percent, persisted
+    uint64_t sgCalibrationStartOdometer;
+    unsigned long sgCalibrationStartTime;
 
     // StallGuard settings
     uint8_t stallGuardThreshold; // StallGuard threshold (0-255, 0=least sensitive, 255=most sensitive)
@@ -77,31 +179,71 @@ private:
     // Acceleration tracking
     uint32_t setpointAcceleration; // Target acceleration in steps/s²
 
+    // Jerk-limited speed ramps (commanded speed/acceleration as fed to the step generator)
+    uint32_t jerkLimit; // steps/s³, 0 = constant-acceleration ramps
+    SCurveRamp speedRamp;
+
+    // Driver/step generator resolution (dynamic microstepping)
+    uint16_t engineMicrosteps;
+    bool microstepSwitchSettling; // Step rate jump after a resolution change still in progress
+    uint16_t pendingMicrosteps;   // Written to the driver, not acknowledged yet (0 = none)
+    uint32_t microstepRequestMs;
+    uint32_t microstepRequestUs;
+    int32_t microstepRequestPosition; // Raw step generator position when the write was requested
+
     // Speed variation settings
     bool speedVariationEnabled;
     float speedVariationStrength;        // 0.0 to 1.0 (0% to 100% variation)
     float speedVariationPhase;           // Phase offset in radians (0 to 2*PI)
-    int32_t speedVariationStartPosition; // Position where variation was enabled
     float speedVariationK;               // Internal k parameter (derived from strength)
     float speedVariationK0;              // Compensation factor k0 = sqrt(1 - k²)
+    uint32_t speedTable[SPEED_TABLE_SIZE]; // Precomputed variable speed in steps/s, indexed by output angle
+    uint32_t speedTableMax;              // Fastest entry (microstep band selection)
+    bool speedVariationAutoTune;         // Phase/strength follow the load map
+    uint16_t autoTuneSteps;              // Tuning steps since auto-tune was enabled
+
+    // Speed schedule wakeup accounting (per output revolution)
+    uint16_t speedScheduleLastIndex;             // Table index seen at the previous wakeup
+    uint16_t speedScheduleSegmentsTraversed;     // Segments passed in the current revolution
+    uint32_t speedScheduleWakeups;               // Speed update wakeups in the current revolution
+    unsigned long speedScheduleRevolutionStart;  // millis() when the current revolution started
+
+    // 64-bit position/odometer tracking (revolution origin = where speed variation was enabled)
+    PositionTracker positionTracker;
+    uint64_t counterResetOdometer;        // Odometer at the last counter reset (session revolutions)
+    uint64_t lifetimeOdometerBase;        // Persisted lifetime microsteps at boot
+    uint64_t lastSavedLifetimeMicroSteps;
+
+    // Angle-resolved StallGuard load map (same angle frame as the speed table)
+    LoadMap loadMap;
+    uint8_t loadMapLastBin;          // Bin of the last sample request
+    uint32_t loadMapLastSequence;    // Driver I/O sample sequence already consumed
+
+    // Periodic job scheduling for run()
+    DeadlineScheduler scheduler;
+    int8_t motorSpeedJobId;
+    int8_t loadMapJobId;
+    int8_t speedRampJobId;
+    int8_t microstepJobId;
+    int8_t stepperBackendJobId;
 
     // Cached references to system singletons
     SystemStatus &systemStatus;
-    SystemCommand &systemCommand;
 
-    StepperController();
-    ~StepperController();
-    StepperController(const StepperController &) = delete;
-    StepperController &operator=(const StepperController &) = delete;
+    // While a transaction is applied, single parameter updates are held back for its TRANSACTION block
+    bool transactionActive;
+
+    // Outcome of the command in processCommand() for its ack - error notifications mark it rejected,
+    // warnings (auto-adjusted values) adjusted
+    bool processingCommand;
+    CommandResult commandResult;
 
     // Helper methods
-    bool initPreferences();
-    void saveSettings();
-    void loadSettings();
+    PersistentSettings collectSettings() const;
+    void saveSettings(); // Queues the settings for a debounced write on the settings task
+    void loadSettings(); // Loads this axis' settings record (the settings task is started by StepperTask)
     void configureDriver();
     void configureStallDetection(bool enableStealthChop = true);
-    bool checkPowerDeliveryReady();                       // Check if power delivery is ready for stepper initialization
-    inline uint32_t rpmToStepsPerSecond(float rpm) const; // Inline hint for frequent calls
 
     // Internal methods (called from command processing)
     void setSpeedInternal(float rpm);
@@ -111,23 +253,43 @@ private:
     void emergencyStopInternal();
     void setRunCurrentInternal(int current);
     void setAccelerationInternal(uint32_t accelerationStepsPerSec2);
+    void setJerkLimitInternal(uint32_t jerkStepsPerSec3);
     void resetCountersInternal();
     void resetStallCountInternal();
     void setSpeedVariationInternal(float strength);
     void setSpeedVariationPhaseInternal(float phase);
     void enableSpeedVariationInternal();
     void disableSpeedVariationInternal();
+    void setSpeedVariationAutoTuneInternal(bool enabled);
     void setStallGuardThresholdInternal(uint8_t threshold);
+    void startStallGuardCalibrationInternal(int revolutions);
+    void setStallGuardCalibrationMarginInternal(int marginPercent);
     void requestAllStatusInternal();
+    void applyTransactionInternal(const StepperTransaction &transaction, uint32_t id);
+    const char *validateTransaction(const StepperTransaction &transaction) const; // Error message or nullptr
+    void publishTransaction(uint32_t id, bool applied);
+    void acknowledgeCommand(const StepperCommandData &cmd); // Ack with the value in effect (clients that sent a seq)
 
     // Speed variation helper methods
-    inline float calculateVariableSpeed() const; // Inline hint for frequent calls
-    inline float getPositionAngle() const;       // Inline hint for frequent calls
+    inline uint32_t getSpeedVariationPosition();      // Microstep position within the variation revolution
+    void trackPosition();                              // Feed the current stepper position into positionTracker
+    uint64_t getLifetimeMicroSteps() const;
+    void saveOdometer();                               // Persist the lifetime odometer if it moved
+    void publishLifetimeRevolutions();
+    inline uint16_t getSpeedTableIndex(uint32_t positionInRevolution) const;
+    void rebuildSpeedTable();                        // Recompute speedTable from setpoint, k, k0 and phase
     uint32_t calculateRequiredAccelerationForVariableSpeed() const;
+    uint32_t calculateRequiredAccelerationForVariableSpeed(float k, float k0) const; // For arbitrary k/k0 (no enable check)
     void updateAccelerationForVariableSpeed();
     void updateSpeedForVariableSpeed();         // Update base speed for variable speed constraints
-    void updateSpeedVariationParameters();      // Helper to calculate k and k0
+    void updateSpeedVariationParameters();      // Helper to calculate k and k0 and rebuild the speed table
     float calculateMaxAllowedBaseSpeed() const; // Calculate max base speed to not exceed MAX_SPEED_RPM
+    float calculateMaxAllowedBaseSpeed(float k, float k0) const;
+
+    // Speed variation auto-tune (fits the load map and adjusts phase/strength to flatten it)
+    void updateAutoTune();                   // One tuning step once the load map is refreshed
+    float calculateMaxAutoTuneStrength() const; // Largest strength within the base speed and acceleration limits
+    void applyAutoTuneParameters(float strength, float phase);
 
     // Centralized stepper hardware control methods (always publish status when hardware is changed)
     void applyStepperSetpointSpeed(float rpm);                        // Set target speed in RPM and publish setpoint update
@@ -137,48 +299,118 @@ private:
     void applyStop();
     void applyCurrent(uint8_t current); // Set run current in mA
 
-    void publishTMC2209Communication(); // Check TMC2209 driver communication status
+    void applyDriverRegisters();        // Ask the driver backend to flush pending register writes
+    void refreshDriverDiagnostics();    // Pick up the latest driver snapshot and report communication transitions
+    void publishTMC2209Communication(); // Publish TMC2209 driver communication status
     void publishTMC2209Temperature();   // Check TMC2209 temperature status
     void publishStallDetection();       // Check stall detection status and update stallDetected, stallCount, lastStallTime
-    void publishStallGuardResult();     // Update StallGuard result (0-510)
-    void publishCurrentRPM();           // Update actual/measured RPM
-    void publishTotalRevolutions();     // Update total revolutions based on current position
-    void publishRuntime();
+    float calculateCurrentRPM() const;  // Actual/measured RPM
+    float calculateTotalRevolutions();  // Revolutions since the last counter reset
 
     // Split status update helpers
-    void publishFastStatusUpdates();  // Speed, runtime, revolutions (100ms)
+    void publishFastStatusUpdates();  // Speed, runtime, revolutions, StallGuard result as one telemetry snapshot (100ms)
     void publishStallStatusUpdates(); // Stall status/count (1s)
     void publishTMCStatusUpdates();   // TMC2209 status/temperature (2s)
 
+    // Status updates and notifications tagged with this axis
+    template <typename T>
+    void publishStatus(StatusUpdateType type, T value)
+    {
+        if (transactionActive)
+        {
+            return;
+        }
+        StatusUpdateData status(type, value);
+        status.axis = axis;
+        systemStatus.publishStatusUpdate(status);
+    }
+    void notify(NotificationType type, const String &message);
+
     void stepperSetSpeed(float rpm);                                // Set target speed
+    void stepperSetSpeedInHz(uint32_t stepsPerSecond);              // Set target speed in steps/s
     void stepperSetAcceleration(uint32_t accelerationStepsPerSec2); // Set target acceleration
 
-    // Speed variation control
-    void updateMotorSpeed();
+    // S-curve ramp (only while jerkLimit > 0): stepperSetSpeedInHz() moves the ramp target and the
+    // ramp job feeds the step generator one short constant-acceleration segment per update
+    void prepareSpeedRamp(bool reversing); // Before run*(): start from standstill or hand a reversal to the step generator
+    void applySpeedRampStep();             // Advance one update interval and program the step generator
+    uint32_t updateSpeedRamp();            // Returns ms until the next update is due
 
-protected:
-    // Task implementation
-    void run() override;
+    // Step generator access in MICRO_STEPS units, scaled to the driver resolution
+    uint32_t toEngineSteps(uint32_t steps) const;
+    int32_t getCurrentSpeedInMilliHz() const;
+    void setEngineSpeed(uint32_t stepsPerSecond);
+    void setEngineAcceleration(uint32_t accelerationStepsPerSec2);
+    void reprogramStepper(); // Current ramp speed/target and acceleration, e.g. after a resolution change
+    void applyEngineSpeedAcceleration(); // applySpeedAcceleration() and a backend update
+    void wakeStepperBackend();           // Run the backend's update() on the next pass (after every command)
 
-    // Internal methods
-    void processCommand(const StepperCommandData &cmd);
+    // Dynamic microstepping
+    float calculateMaxCommandedRPM() const;           // Fastest speed the axis runs or is heading for
+    uint32_t updateMicrostepResolution();             // Band check; returns ms until the next check
+    void requestMicrostepResolution(uint16_t microsteps);
+    uint32_t confirmMicrostepResolution();            // Switches once the driver acknowledged MRES
+    void applyMicrostepResolution(uint16_t microsteps, int32_t rawSwitchPosition);
+    bool isMicrostepSwitchInProgress() const { return microstepSwitchSettling || pendingMicrosteps != 0; }
 
-    // Helper methods for run() timing
-    TickType_t calculateQueueTimeout(unsigned long nextUpdate);
-    bool isUpdateDue(unsigned long nextUpdate);
+    // Scheduler job trampolines
+    static void motorSpeedJob(void *context);
+    static void fastStatusJob(void *context);
+    static void stallStatusJob(void *context);
+    static void tmcStatusJob(void *context);
+    static void loadMapJob(void *context);
+    static void loadMapPublishJob(void *context);
+    static void odometerJob(void *context);
+    static void speedRampJob(void *context);
+    static void microstepJob(void *context);
+    static void stepperBackendJob(void *context);
+
+    // Speed variation control
+    uint32_t updateMotorSpeed();                                                  // Returns ms until the next update is due
+    uint32_t calculateMsToNextSegment(uint32_t positionInRevolution, uint16_t index, uint16_t segmentsPerRevolution) const;
+    void resetSpeedScheduleTracking();
+    void trackSpeedScheduleWakeup(uint16_t index); // Publishes wakeups saved vs. polling once per revolution
+
+    // StallGuard load map
+    inline uint8_t getLoadMapBin(uint32_t positionInRevolution) const;
+    uint32_t updateLoadMap(); // Consume the last sample, request the next one; returns ms until the next bin
+    void resetLoadMap();
+    void publishLoadMap();
+
+    // StallGuard threshold calibration
+    void updateStallGuardCalibration(); // Finishes or cancels the run; samples are fed from updateLoadMap()
+    void finishStallGuardCalibration(bool success);
+    void publishStallGuardCalibration(uint8_t threshold);
 
     // Periodic status updates
     void publishPeriodicStatusUpdates();
 
 public:
-    // Initialization
+    StepperController(uint8_t axis, IStepperBackend &stepperBackend, IDriverBackend &driver);
+    StepperController(const StepperController &) = delete;
+    StepperController &operator=(const StepperController &) = delete;
+
+    // Initialization (called by StepperTask): start the backends and set the driver registers,
+    // then - once the driver I/O task runs - confirm communication and register the periodic jobs
     bool begin();
+    void confirmDriverCommunication(unsigned long waitStart);
+    void startJobs();
 
-    static StepperController &getInstance()
-    {
-        static StepperController instance;
-        return instance;
-    }
+    // Command processing and job scheduling, driven by the stepper task loop
+    void processCommand(const StepperCommandData &cmd);
+    TickType_t ticksUntilNextDue() { return scheduler.ticksUntilNextDue(); }
+    void runDueJobs() { scheduler.runDueJobs(); }
+    DeadlineScheduler &getScheduler() { return scheduler; } // Job statistics and latency histograms
+
+    uint8_t getAxis() const { return axis; }
+
+    // Speed variation profile - also used by the offline rotisserie simulation, so it replays
+    // exactly the speed commands the controller issues
+    static uint32_t rpmToStepsPerSecond(float rpm);
+    static void calculateSpeedVariationK(float strength, float &k, float &k0); // Internal k and compensation k0
+    static float calculateVariableSpeed(float setpointRPM, float k, float k0, float phase, float angle); // RPM at an output angle
+    static void buildSpeedTable(uint32_t *table, float setpointRPM, float k, float k0, float phase);     // SPEED_TABLE_SIZE entries (steps/s)
+    static uint16_t selectMicrosteps(float rpm, uint16_t currentMicrosteps); // Speed band with hysteresis
 };
 
 #endif // STEPPER_CONTROLLER_H
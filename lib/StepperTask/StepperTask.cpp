@@ -0,0 +1,549 @@
+#include "StepperTask.h"
+
+#if STEPPER_BACKEND_SIMULATED
+#include "SimulatedStepperBackend.h"
+#include "SimulatedDriverBackend.h"
+#else
+#include "FastAccelStepperBackend.h"
+#include "TMC2209DriverBackend.h"
+#include "DriverIOTask.h"
+#endif
+#if STEPPER_MOTION_VACTUAL
+#include "VactualStepperBackend.h"
+#endif
+
+StepperTask::StepperTask()
+    : Task("Stepper_Task", 4096, 1, STEPPER_TASK_CORE), // Task name, 4KB stack, priority 1, motion core
+      stepperBackends(), driverBackends(), axes(), powerDeliveryReady(false), motionLoopMaxLatencyUs(0),
+      motionTiming(MotionTiming::getInstance()), latencyDumpJobId(DEADLINE_SCHEDULER_INVALID_JOB),
+      latencyDumpActive(false), latencyDumpNext(0), latencyDumpProgressMs(0), commandLatencyPublishedCount(0),
+      coalescedPublishedCount(0), droppedPublishedCount(0),
+      systemStatus(SystemStatus::getInstance()), systemCommand(SystemCommand::getInstance())
+{
+}
+
+bool StepperTask::checkPowerDeliveryReady()
+{
+    PowerDeliveryTask &pdTask = PowerDeliveryTask::getInstance();
+
+    // Check if power delivery is ready (successful negotiation AND power good)
+    if (pdTask.isNegotiationComplete() && pdTask.isPowerGood())
+    {
+        if (!powerDeliveryReady)
+        {
+            powerDeliveryReady = true;
+            dbg_printf("StepperTask: Power delivery ready - %dV negotiated, %0.1fV measured\n",
+                       pdTask.getNegotiatedVoltage(), pdTask.getCurrentVoltage());
+        }
+        return true;
+    }
+
+    // If negotiation is complete but failed, check if it's because no PD adapter is connected
+    if (pdTask.isNegotiationComplete() && !pdTask.isPowerGood())
+    {
+        PDNegotiationState state = pdTask.getNegotiationState();
+
+        // If negotiation timed out or failed, assume no PD adapter and allow operation
+        if (state == PDNegotiationState::FAILED)
+        {
+            if (!powerDeliveryReady)
+            {
+                powerDeliveryReady = true;
+                dbg_println("StepperTask: No PD adapter detected, allowing operation without PD safety");
+            }
+            return true;
+        }
+    }
+
+    // If we get here, either negotiation is still in progress or power was lost
+    if (powerDeliveryReady)
+    {
+        powerDeliveryReady = false;
+        dbg_println("StepperTask: Power delivery lost or negotiation in progress");
+    }
+    return false;
+}
+
+void StepperTask::waitForPowerDelivery()
+{
+    // Wait for power delivery negotiation with timeout
+    dbg_println("Waiting for power delivery negotiation...");
+    unsigned long pdWaitStart = millis();
+    bool pdTimedOut = false;
+
+    while (!checkPowerDeliveryReady() && !pdTimedOut)
+    {
+        if (millis() - pdWaitStart >= PD_WAIT_TIMEOUT)
+        {
+            pdTimedOut = true;
+            dbg_println("StepperTask: Power delivery negotiation timed out");
+            dbg_println("StepperTask: Proceeding with stepper initialization (no PD adapter or negotiation failed)");
+            dbg_println("StepperTask: Motor control will be available but without PD safety features");
+        }
+        else
+        {
+            vTaskDelay(pdMS_TO_TICKS(500)); // Check every 500ms
+        }
+    }
+
+    if (!pdTimedOut)
+    {
+        dbg_println("StepperTask: Power delivery negotiation successful, proceeding with full safety features");
+    }
+}
+
+void StepperTask::createBackends()
+{
+#if STEPPER_BACKEND_SIMULATED
+    // Every axis turns the default spit load (see RotisserieModel)
+    RotisserieParameters load;
+    load.microStepsPerMotorRevolution = STEPS_PER_REVOLUTION * MICRO_STEPS;
+    load.gearRatio = GEAR_RATIO;
+
+    for (uint8_t i = 0; i < STEPPER_AXIS_COUNT; i++)
+    {
+        SimulatedStepperBackend *stepper = new SimulatedStepperBackend();
+        stepperBackends[i] = stepper;
+        driverBackends[i] = new SimulatedDriverBackend(*stepper, load);
+#if STEPPER_MOTION_VACTUAL
+        stepperBackends[i] = new VactualStepperBackend(*driverBackends[i], *stepper);
+#endif
+    }
+#else
+    DriverIOTask &driverIO = DriverIOTask::getInstance();
+
+    // Serial address straps of the on-board driver (MS1/MS2 low = address 0)
+    pinMode(MS1_PIN, OUTPUT);
+    pinMode(MS2_PIN, OUTPUT);
+    digitalWrite(MS1_PIN, LOW);
+    digitalWrite(MS2_PIN, LOW);
+
+    // All drivers share the TMC UART, driven by the driver I/O task
+    driverIO.begin(Serial2, TMC_RX_PIN, TMC_TX_PIN);
+    for (uint8_t i = 0; i < STEPPER_AXIS_COUNT; i++)
+    {
+        const StepperAxisConfig &config = STEPPER_AXES[i];
+        driverIO.attachDriver(i, static_cast<TMC2209::SerialAddress>(config.serialAddress));
+
+        // Step pulses of every axis come from one shared FastAccelStepper engine
+        stepperBackends[i] = new FastAccelStepperBackend(config.stepPin, config.dirPin, config.enablePin);
+        driverBackends[i] = new TMC2209DriverBackend(driverIO, i, config.diagPin);
+#if STEPPER_MOTION_VACTUAL
+        // The driver turns the motor itself; the step pulses only take over at standstill without UART
+        stepperBackends[i] = new VactualStepperBackend(*driverBackends[i], *stepperBackends[i]);
+#endif
+    }
+#endif
+}
+
+bool StepperTask::beginAxes()
+{
+    createBackends();
+
+    bool anyAxis = false;
+    for (uint8_t i = 0; i < STEPPER_AXIS_COUNT; i++)
+    {
+        StepperController *controller = new StepperController(i, *stepperBackends[i], *driverBackends[i]);
+        if (!controller->begin())
+        {
+            dbg_printf("Failed to initialize axis %u (%s)\n", i, STEPPER_AXES[i].name);
+            delete controller;
+            continue;
+        }
+        axes[i] = controller;
+        anyAxis = true;
+    }
+
+    if (!anyAxis)
+    {
+        return false;
+    }
+
+#if !STEPPER_BACKEND_SIMULATED
+    // Every axis has set its registers - the driver I/O task probes all drivers and writes them in one batch
+    DriverIOTask::getInstance().start();
+#endif
+
+    const unsigned long waitStart = millis();
+    for (StepperController *axis : axes)
+    {
+        if (axis)
+        {
+            axis->confirmDriverCommunication(waitStart);
+        }
+    }
+
+    // From here on all flash writes happen on the settings task
+    SettingsStore::getInstance().start();
+
+    for (StepperController *axis : axes)
+    {
+        if (axis)
+        {
+            axis->startJobs();
+        }
+    }
+
+    return true;
+}
+
+void StepperTask::run()
+{
+    dbg_println("Stepper Task started");
+
+    // This task publishes most status updates - give it the lock-free lane
+    systemStatus.claimRingLane();
+
+#if STEPPER_BACKEND_SIMULATED
+    dbg_println("StepperTask: Simulated backends - skipping power delivery wait");
+#else
+    waitForPowerDelivery();
+#endif
+
+    // Initialize stepper controllers
+    if (!beginAxes())
+    {
+        dbg_println("Failed to initialize stepper controller!");
+        return;
+    }
+
+    dbg_printf("Stepper Controller initialized successfully! (%d axes)\n", STEPPER_AXIS_COUNT);
+
+    scheduler.enableHistograms();
+    scheduler.addJob("loop_latency", TMC_UPDATE_INTERVAL, loopLatencyJob, this, TMC_UPDATE_INTERVAL);
+    scheduler.addJob("motion_timing", MOTION_TIMING_INTERVAL, motionTimingJob, this, MOTION_TIMING_INTERVAL);
+    latencyDumpJobId = scheduler.addJob("latency_dump", LATENCY_DUMP_IDLE_INTERVAL, latencyDumpJob, this, LATENCY_DUMP_IDLE_INTERVAL);
+    scheduler.addJob("command_stats", COMMAND_TRACE_INTERVAL, commandStatsJob, this, COMMAND_TRACE_INTERVAL);
+    motionTiming.begin(STEPPER_TASK_CORE);
+
+    StepperCommandData cmd;
+
+    while (true)
+    {
+        // Sleep until a command arrives or the earliest job of any axis is due
+        const TickType_t waitTicks = ticksUntilNextDue();
+        const uint32_t sleepTime = micros();
+        const bool hasCommand = systemCommand.getCommand(cmd, waitTicks);
+        const uint32_t wakeTime = micros();
+
+        if (hasCommand)
+        {
+            dispatchCommand(cmd);
+            const uint32_t appliedTime = micros();
+            motionTiming.recordCommandLatency(appliedTime - cmd.trace.queuedUs);
+            traceCommand(cmd, wakeTime, appliedTime);
+        }
+        else if (waitTicks != portMAX_DELAY)
+        {
+            motionTiming.recordLoopWake(sleepTime + waitTicks * portTICK_PERIOD_MS * 1000, wakeTime);
+        }
+
+        for (StepperController *axis : axes)
+        {
+            if (axis)
+            {
+                axis->runDueJobs();
+            }
+        }
+        scheduler.runDueJobs();
+
+        // Track how long one pass keeps the motion loop busy (no driver UART access may happen here)
+        const uint32_t loopTime = micros() - wakeTime;
+        if (loopTime > motionLoopMaxLatencyUs)
+        {
+            motionLoopMaxLatencyUs = loopTime;
+        }
+        motionTiming.recordLoopBusy(loopTime);
+    }
+}
+
+TickType_t StepperTask::ticksUntilNextDue()
+{
+    TickType_t ticks = scheduler.ticksUntilNextDue();
+    for (StepperController *axis : axes)
+    {
+        if (axis)
+        {
+            ticks = min(ticks, axis->ticksUntilNextDue());
+        }
+    }
+    return ticks;
+}
+
+void StepperTask::dispatchCommand(const StepperCommandData &cmd)
+{
+    // Latency histograms cover the task and all axes at once - the axis is not used
+    if (cmd.command == StepperCommand::REQUEST_LATENCY_HISTOGRAMS)
+    {
+        requestLatencyDump();
+        systemStatus.publishCommandAck(cmd.trace.seq, cmd.axis, CommandResult::OK);
+        return;
+    }
+    if (cmd.command == StepperCommand::RESET_LATENCY_HISTOGRAMS)
+    {
+        resetLatencyHistograms();
+        systemStatus.publishCommandAck(cmd.trace.seq, cmd.axis, CommandResult::OK);
+        return;
+    }
+
+    if (cmd.axis == STEPPER_AXIS_ALL)
+    {
+        for (StepperController *axis : axes)
+        {
+            if (axis)
+            {
+                axis->processCommand(cmd);
+            }
+        }
+    }
+    else if (cmd.axis < STEPPER_AXIS_COUNT && axes[cmd.axis])
+    {
+        axes[cmd.axis]->processCommand(cmd);
+    }
+    else
+    {
+        dbg_printf("StepperTask: Command type %d for unavailable axis %u dropped\n", (int)cmd.command, cmd.axis);
+        systemStatus.sendNotification(NotificationType::ERROR, "Axis not available");
+        systemStatus.publishCommandAck(cmd.trace.seq, cmd.axis, CommandResult::UNAVAILABLE);
+        return;
+    }
+
+    if (cmd.command == StepperCommand::REQUEST_ALL_STATUS)
+    {
+        publishSystemStatus();
+    }
+}
+
+void StepperTask::publishSystemStatus()
+{
+    // Settings persistence counters
+    SettingsStore &settingsStore = SettingsStore::getInstance();
+    systemStatus.publishStatusUpdate(StatusUpdateType::SETTINGS_FLASH_WRITES, settingsStore.getFlashWriteCount());
+    systemStatus.publishStatusUpdate(StatusUpdateType::SETTINGS_SAVE_REQUESTS, settingsStore.getSaveRequestCount());
+
+    publishCommandLatency();
+    publishCommandCounters();
+}
+
+void StepperTask::loopLatencyJob(void *context)
+{
+    static_cast<StepperTask *>(context)->publishMotionLoopLatency();
+}
+
+void StepperTask::publishMotionLoopLatency()
+{
+    systemStatus.publishStatusUpdate(StatusUpdateType::MOTION_LOOP_MAX_LATENCY_US, motionLoopMaxLatencyUs);
+    motionLoopMaxLatencyUs = 0;
+}
+
+void StepperTask::motionTimingJob(void *context)
+{
+    static_cast<StepperTask *>(context)->publishMotionTiming();
+}
+
+void StepperTask::publishMotionTiming()
+{
+    MotionTimingWindow window;
+    motionTiming.takeWindow(window);
+
+    StatusBlockData block(StatusBlockType::MOTION_TIMING);
+    block.info = window.windowMs;
+    block.addValue(window.isrCountPerSecond);
+    block.addValue(window.isrCyclesPerSecond);
+    block.addValue(window.isrMaxCycles);
+    block.addValue(window.cpuFrequencyMHz);
+    block.addValue(window.loopWakes);
+    block.addValue(window.loopJitterMeanUs);
+    block.addValue(window.loopJitterMaxUs);
+    block.addValue(window.loopBusyMaxUs);
+    block.addValue(window.commandCount);
+    block.addValue(window.commandLatencyMeanUs);
+    block.addValue(window.commandLatencyMaxUs);
+    systemStatus.publishStatusBlock(block);
+
+#if MOTION_TIMING_LOG
+    // Interrupt load as a share of the motion core
+    const float isrLoad = window.isrCyclesPerSecond / (window.cpuFrequencyMHz * 10000.0f);
+    dbg_printf("MotionTiming: ISR %u/s %.2f%% (max %u cycles), wake jitter %u/%u us, busy max %u us, "
+               "commands %u latency %u/%u us\n",
+               window.isrCountPerSecond, isrLoad, window.isrMaxCycles, window.loopJitterMeanUs, window.loopJitterMaxUs,
+               window.loopBusyMaxUs, window.commandCount, window.commandLatencyMeanUs, window.commandLatencyMaxUs);
+#endif
+}
+
+void StepperTask::latencyDumpJob(void *context)
+{
+    StepperTask *self = static_cast<StepperTask *>(context);
+    self->scheduler.rescheduleIn(self->latencyDumpJobId, self->continueLatencyDump());
+}
+
+void StepperTask::requestLatencyDump()
+{
+    // A new request restarts a dump that is still running
+    latencyDumpActive = true;
+    latencyDumpNext = 0;
+    latencyDumpProgressMs = millis();
+    scheduler.rescheduleIn(latencyDumpJobId, 0);
+}
+
+void StepperTask::resetLatencyHistograms()
+{
+    commandTracer.reset();
+    commandLatencyPublishedCount = 0;
+    scheduler.resetStats();
+    for (StepperController *axis : axes)
+    {
+        if (axis)
+        {
+            axis->getScheduler().resetStats();
+        }
+    }
+    dbg_println("StepperTask: Latency histograms reset");
+}
+
+uint32_t StepperTask::continueLatencyDump()
+{
+    if (!latencyDumpActive)
+    {
+        return LATENCY_DUMP_IDLE_INTERVAL;
+    }
+
+    // The status block queue is short - publish only what fits and continue once it was drained
+    while (systemStatus.getStatusBlockSpaces() > 0)
+    {
+        if (!publishLatencyHistogram(latencyDumpNext))
+        {
+            latencyDumpActive = false;
+            dbg_printf("StepperTask: Latency dump complete (%u histograms)\n", latencyDumpNext);
+            return LATENCY_DUMP_IDLE_INTERVAL;
+        }
+        latencyDumpNext++;
+        latencyDumpProgressMs = millis();
+    }
+
+    if (millis() - latencyDumpProgressMs >= LATENCY_DUMP_TIMEOUT)
+    {
+        latencyDumpActive = false;
+        dbg_printf("StepperTask: Latency dump abandoned after %u histograms - status blocks not drained\n", latencyDumpNext);
+        return LATENCY_DUMP_IDLE_INTERVAL;
+    }
+    return LATENCY_DUMP_INTERVAL;
+}
+
+bool StepperTask::publishLatencyHistogram(uint16_t index)
+{
+    // Order: command queue wait, then lateness and execution time of every job of the task
+    // scheduler and of each axis scheduler
+    if (index == 0)
+    {
+        publishLatencyBlock(0, "command_queue", LatencyKind::QUEUE_WAIT, commandTracer.getStage(CommandStage::QUEUE));
+        return true;
+    }
+    index--;
+
+    for (uint8_t source = 0; source <= STEPPER_AXIS_COUNT; source++)
+    {
+        StepperController *axis = source > 0 ? axes[source - 1] : nullptr;
+        if (source > 0 && !axis)
+        {
+            continue;
+        }
+
+        DeadlineScheduler &sourceScheduler = axis ? axis->getScheduler() : scheduler;
+        const uint16_t histogramCount = 2 * sourceScheduler.getJobCount();
+        if (index >= histogramCount)
+        {
+            index -= histogramCount;
+            continue;
+        }
+
+        const int8_t jobId = index / 2;
+        const DeadlineJobHistograms *histograms = sourceScheduler.getHistograms(jobId);
+        if (histograms)
+        {
+            const bool execution = index % 2 != 0;
+            publishLatencyBlock(axis ? axis->getAxis() : 0, sourceScheduler.getJobName(jobId),
+                                execution ? LatencyKind::EXECUTION : LatencyKind::LATENESS,
+                                execution ? histograms->execution : histograms->lateness);
+        }
+        return true;
+    }
+    return false;
+}
+
+void StepperTask::publishLatencyBlock(uint8_t axis, const char *label, LatencyKind kind, const LatencyHistogram &histogram)
+{
+    StatusBlockData block(StatusBlockType::LATENCY_HISTOGRAM);
+    block.axis = axis;
+    block.info = static_cast<uint32_t>(kind);
+    block.label = label;
+    block.addValue(histogram.getCount());
+    block.addValue(histogram.getMin());
+    block.addValue(histogram.getMean());
+    block.addValue(histogram.valueAtPercentile(50.0f));
+    block.addValue(histogram.valueAtPercentile(90.0f));
+    block.addValue(histogram.valueAtPercentile(99.0f));
+    block.addValue(histogram.valueAtPercentile(99.9f));
+    block.addValue(histogram.getMax());
+    block.count += 2 * histogram.exportBuckets(block.values + block.count, LATENCY_DUMP_MAX_BUCKETS);
+    systemStatus.publishStatusBlock(block);
+}
+
+void StepperTask::traceCommand(const StepperCommandData &cmd, uint32_t dequeuedUs, uint32_t appliedUs)
+{
+    const CommandTraceRecord trace = commandTracer.record(cmd, dequeuedUs, appliedUs);
+
+    // Stop commands are reported individually - their latency is the one that has to be proven
+    if (cmd.command != StepperCommand::EMERGENCY_STOP && cmd.command != StepperCommand::DISABLE)
+    {
+        return;
+    }
+
+    StatusBlockData block(StatusBlockType::COMMAND_TRACE);
+    block.info = trace.id;
+    block.addValue(static_cast<int32_t>(trace.command));
+    for (uint8_t i = 0; i < COMMAND_STAGE_COUNT; i++)
+    {
+        block.addValue(trace.stageUs[i]);
+    }
+    systemStatus.publishStatusBlock(block);
+}
+
+void StepperTask::commandStatsJob(void *context)
+{
+    StepperTask *self = static_cast<StepperTask *>(context);
+    if (self->commandTracer.getCommandCount() != self->commandLatencyPublishedCount)
+    {
+        self->publishCommandLatency();
+    }
+    if (self->systemCommand.getCoalescedCount() != self->coalescedPublishedCount ||
+        self->systemCommand.getDroppedCount() != self->droppedPublishedCount)
+    {
+        self->publishCommandCounters();
+    }
+}
+
+void StepperTask::publishCommandLatency()
+{
+    StatusBlockData block(StatusBlockType::COMMAND_LATENCY);
+    block.info = commandTracer.getCommandCount();
+    for (uint8_t i = 0; i < COMMAND_STAGE_COUNT; i++)
+    {
+        const LatencyHistogram &stage = commandTracer.getStage(static_cast<CommandStage>(i));
+        block.addValue(stage.getCount());
+        block.addValue(stage.valueAtPercentile(50.0f));
+        block.addValue(stage.valueAtPercentile(99.0f));
+        block.addValue(stage.valueAtPercentile(99.9f));
+        block.addValue(stage.getMax());
+    }
+    systemStatus.publishStatusBlock(block);
+    commandLatencyPublishedCount = commandTracer.getCommandCount();
+}
+
+void StepperTask::publishCommandCounters()
+{
+    coalescedPublishedCount = systemCommand.getCoalescedCount();
+    droppedPublishedCount = systemCommand.getDroppedCount();
+    systemStatus.publishStatusUpdate(StatusUpdateType::COMMANDS_COALESCED, coalescedPublishedCount);
+    systemStatus.publishStatusUpdate(StatusUpdateType::COMMANDS_DROPPED, droppedPublishedCount);
+}
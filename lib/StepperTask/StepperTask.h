@@ -0,0 +1,133 @@
+#ifndef STEPPER_TASK_H
+#define STEPPER_TASK_H
+
+/**
+ * @file StepperTask.h
+ * @brief Motion task running every stepper axis
+ *
+ * One task creates the step and driver backends of every axis from the axis table
+ * (FastAccelStepper on the shared engine and TMC2209s on the shared UART bus, or their
+ * software models when STEPPER_BACKEND_SIMULATED is set; with STEPPER_MOTION_VACTUAL the step
+ * generator only backs up the drivers' own velocity mode) and runs the per-axis
+ * StepperControllers: commands are dispatched by their axis ID and the task sleeps until
+ * a command arrives or the earliest job of any axis is due.
+ *
+ * Every scheduler job records lateness and execution time histograms, and the task records how
+ * long commands wait in the command queue. REQUEST_LATENCY_HISTOGRAMS dumps all of them as
+ * LATENCY_HISTOGRAM status blocks, paced by the free space of the status block queue.
+ * Every command is traced from the BLE write to its application (see CommandTracer): stop
+ * commands are reported one by one, the stage tail latencies every COMMAND_TRACE_INTERVAL
+ * together with the coalesced and dropped command counts of SystemCommand.
+ */
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "Task.h"
+#include "DeadlineScheduler.h"
+#include "StepperController.h"
+#include "IStepperBackend.h"
+#include "IDriverBackend.h"
+#include "SettingsStore.h"
+#include "SystemStatus.h"
+#include "SystemCommand.h"
+#include "PowerDeliveryTask.h"
+#include "MotionTiming.h"
+#include "LatencyHistogram.h"
+#include "CommandTracer.h"
+#include "dbg_print.h"
+
+#define PD_WAIT_TIMEOUT 10000 // Max wait for power delivery negotiation before the axes start (ms)
+#define STEPPER_TASK_CORE 1   // Motion core (also where FastAccelStepper's step interrupts run)
+#define MOTION_TIMING_INTERVAL 1000 // Motion core timing window / status block interval (ms)
+#define LATENCY_DUMP_INTERVAL 20      // Retry interval while a histogram dump waits for status block queue space (ms)
+#define LATENCY_DUMP_IDLE_INTERVAL 60000 // Dump job period without a pending dump (ms)
+#define LATENCY_DUMP_TIMEOUT 2000     // Give up a dump when nobody drains the status blocks for this long (ms)
+#define LATENCY_DUMP_MAX_BUCKETS 16   // Bucket pairs per histogram block (keeps a block within one BLE packet)
+#define COMMAND_TRACE_INTERVAL 5000   // Command latency and counter interval, each sent only when it changed (ms)
+
+// 1 = run the axes on simulated step generators and drivers (host build, no hardware touched)
+#ifndef STEPPER_BACKEND_SIMULATED
+#define STEPPER_BACKEND_SIMULATED 0
+#endif
+
+// 1 = move the motors with the drivers' internal step generators (VACTUAL over UART) instead of step
+// pulses; the step/dir generator stays attached as fallback (see VactualStepperBackend)
+#ifndef STEPPER_MOTION_VACTUAL
+#define STEPPER_MOTION_VACTUAL 0
+#endif
+
+class StepperTask : public Task
+{
+private:
+    IStepperBackend *stepperBackends[STEPPER_AXIS_COUNT];
+    IDriverBackend *driverBackends[STEPPER_AXIS_COUNT];
+    StepperController *axes[STEPPER_AXIS_COUNT];
+
+    bool powerDeliveryReady; // Track if power delivery negotiation is complete
+
+    // System-wide periodic jobs (per-axis jobs live in each StepperController)
+    DeadlineScheduler scheduler;
+    uint32_t motionLoopMaxLatencyUs; // Worst-case wake-to-idle time of one loop pass since the last report
+    MotionTiming &motionTiming;      // Interrupt load, wake jitter and command latency (MOTION_TIMING block)
+
+    // Latency histogram dump: index of the next histogram to publish (see publishLatencyHistogram())
+    int8_t latencyDumpJobId;
+    bool latencyDumpActive;
+    uint16_t latencyDumpNext;
+    uint32_t latencyDumpProgressMs;  // millis() of the last published block
+
+    CommandTracer commandTracer;     // Stage latencies of every command (queue wait included)
+    uint32_t commandLatencyPublishedCount; // Traced command count at the last COMMAND_LATENCY block
+    uint32_t coalescedPublishedCount;      // SystemCommand counters at their last status update
+    uint32_t droppedPublishedCount;
+
+    // Cached references to system singletons
+    SystemStatus &systemStatus;
+    SystemCommand &systemCommand;
+
+    StepperTask();
+    ~StepperTask() {}
+    StepperTask(const StepperTask &) = delete;
+    StepperTask &operator=(const StepperTask &) = delete;
+
+    bool checkPowerDeliveryReady(); // Check if power delivery is ready for stepper initialization
+    void waitForPowerDelivery();
+    void createBackends();          // Hardware or simulated backends for every axis in STEPPER_AXES
+    bool beginAxes();               // Shared UART bus, backends and every axis
+    void dispatchCommand(const StepperCommandData &cmd);
+    TickType_t ticksUntilNextDue();
+
+    void publishSystemStatus();     // Values shared by all axes (loop latency, settings counters)
+    void publishMotionLoopLatency(); // Publish and reset the worst-case motion loop latency
+    void publishMotionTiming();      // Close the timing window and publish it as a status block
+
+    // Latency histograms of the command queue, the task jobs and the jobs of every axis
+    void requestLatencyDump();
+    void resetLatencyHistograms();
+    uint32_t continueLatencyDump();  // Publish while the status block queue has space; returns ms until the next call
+    bool publishLatencyHistogram(uint16_t index); // false past the last histogram
+    void publishLatencyBlock(uint8_t axis, const char *label, LatencyKind kind, const LatencyHistogram &histogram);
+
+    void traceCommand(const StepperCommandData &cmd, uint32_t dequeuedUs, uint32_t appliedUs);
+    void publishCommandLatency();    // Stage tail latencies (COMMAND_LATENCY block)
+    void publishCommandCounters();   // Coalesced and dropped commands
+
+    // Scheduler job trampolines
+    static void loopLatencyJob(void *context);
+    static void motionTimingJob(void *context);
+    static void latencyDumpJob(void *context);
+    static void commandStatsJob(void *context);
+
+protected:
+    // Task implementation
+    void run() override;
+
+public:
+    static StepperTask &getInstance()
+    {
+        static StepperTask instance;
+        return instance;
+    }
+};
+
+#endif // STEPPER_TASK_H
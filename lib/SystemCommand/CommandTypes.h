@@ -1,6 +1,12 @@
 #ifndef COMMAND_TYPES_H
 #define COMMAND_TYPES_H
 
+#include <stdint.h>
+
+// Axis addressing - one axis per TMC2209 on the shared UART bus (addresses 0-3)
+#define STEPPER_MAX_AXES 4
+#define STEPPER_AXIS_ALL 0xFF       // Command applies to every configured axis
+
 // Command types for inter-task communication
 enum class StepperCommand {
     SET_SPEED,
@@ -10,14 +16,21 @@ enum class StepperCommand {
     EMERGENCY_STOP,
     SET_CURRENT,
     SET_ACCELERATION,
+    SET_JERK_LIMIT,             // S-curve jerk limit in steps/s³ (uint32), 0 = constant-acceleration ramps
     RESET_COUNTERS,
     RESET_STALL_COUNT,
     SET_SPEED_VARIATION,
     SET_SPEED_VARIATION_PHASE,
     ENABLE_SPEED_VARIATION,
     DISABLE_SPEED_VARIATION,
+    SET_SPEED_VARIATION_AUTO_TUNE, // Let phase/strength follow the StallGuard load map (bool)
     SET_STALLGUARD_THRESHOLD,   // Set StallGuard threshold (0-255, 0=least sensitive, 255=most sensitive)
-    REQUEST_ALL_STATUS  // Request all current status values
+    CALIBRATE_STALLGUARD,       // Derive the StallGuard threshold from SG_RESULT over N revolutions (int)
+    SET_STALLGUARD_CALIBRATION_MARGIN, // Calibration margin below the lowest SG_RESULT (0-90%)
+    REQUEST_ALL_STATUS, // Request all current status values
+    REQUEST_LATENCY_HISTOGRAMS, // Dump the job and command queue latency histograms (LATENCY_HISTOGRAM blocks)
+    RESET_LATENCY_HISTOGRAMS,   // Clear the latency histograms (and the scheduler statistics)
+    APPLY_TRANSACTION           // Apply a StepperTransaction at once (one TRANSACTION status block)
 };
 
 // Power delivery command types
@@ -27,35 +40,73 @@ enum class PowerDeliveryCommand {
     REQUEST_ALL_STATUS              // Request all status updates
 };
 
+// Parameters set by a transaction (StepperTransaction::fields)
+#define TRANSACTION_SPEED               0x01
+#define TRANSACTION_ACCELERATION        0x02
+#define TRANSACTION_VARIATION_STRENGTH  0x04
+#define TRANSACTION_VARIATION_PHASE     0x08
+#define TRANSACTION_VARIATION_ENABLE    0x10
+#define TRANSACTION_ENABLE              0x20
+
+// A group of parameter changes (e.g. a preset) that is validated together and applied at once:
+// either all flagged parameters change or none. Plain data so it fits the command union.
+struct StepperTransaction {
+    uint8_t fields;              // TRANSACTION_* flags of the parameters to change
+    bool enable;                 // Motor on/off
+    bool variationEnable;        // Speed variation on/off
+    float speed;                 // Setpoint in RPM
+    uint32_t acceleration;       // steps/s²
+    float variationStrength;     // 0.0-1.0
+    float variationPhase;        // radians
+};
+
+// Timestamps (micros()) of one command on its way to the motion task; 0 = hop not passed
+// (commands that do not come from BLE start at queuedUs)
+struct CommandTrace {
+    uint32_t id;             // Monotonic, assigned by SystemCommand when the command is queued
+    uint32_t receivedUs;     // BLE write received
+    uint32_t parsedUs;       // JSON parsed
+    uint32_t queuedUs;       // Handed to the command queue
+    uint16_t seq;            // Client sequence number (BLE "seq") to acknowledge, 0 = no ack
+
+    CommandTrace() : id(0), receivedUs(0), parsedUs(0), queuedUs(0), seq(0) {}
+};
+
 // Command data structure
 struct StepperCommandData {
     StepperCommand command;
+    uint8_t axis;            // Target axis (0 = main spit), STEPPER_AXIS_ALL for every axis
     union {
         float floatValue;    // for speed
         bool boolValue;      // for direction, enable/disable
         int intValue;        // for microsteps, current
         uint32_t uint32Value; // for acceleration
+        StepperTransaction transaction; // for APPLY_TRANSACTION
     };
+    CommandTrace trace;      // ID and hop timestamps (queue side set by SystemCommand)
     
     // Helper constructors
-    StepperCommandData() : command(StepperCommand::ENABLE) {
+    StepperCommandData() : command(StepperCommand::ENABLE), axis(0) {
         floatValue = 0.0f;
     }
-    StepperCommandData(StepperCommand cmd) : command(cmd) {
+    StepperCommandData(StepperCommand cmd) : command(cmd), axis(0) {
         floatValue = 0.0f;
     }
-    StepperCommandData(StepperCommand cmd, float value) : command(cmd) {
+    StepperCommandData(StepperCommand cmd, float value) : command(cmd), axis(0) {
         floatValue = value;
     }
-    StepperCommandData(StepperCommand cmd, bool value) : command(cmd) {
+    StepperCommandData(StepperCommand cmd, bool value) : command(cmd), axis(0) {
         boolValue = value;
     }
-    StepperCommandData(StepperCommand cmd, int value) : command(cmd) {
+    StepperCommandData(StepperCommand cmd, int value) : command(cmd), axis(0) {
         intValue = value;
     }
-    StepperCommandData(StepperCommand cmd, uint32_t value) : command(cmd) {
+    StepperCommandData(StepperCommand cmd, uint32_t value) : command(cmd), axis(0) {
         uint32Value = value;
     }
+    explicit StepperCommandData(const StepperTransaction& value) : command(StepperCommand::APPLY_TRANSACTION), axis(0) {
+        transaction = value;
+    }
 };
 
 // Power delivery command data structure
@@ -66,20 +117,21 @@ struct PowerDeliveryCommandData {
         bool boolValue;      // for enable/disable
         int intValue;        // for voltage selection
     };
+    uint16_t seq;            // Client sequence number to acknowledge, 0 = no ack
     
-    PowerDeliveryCommandData() : command(PowerDeliveryCommand::REQUEST_ALL_STATUS) {
+    PowerDeliveryCommandData() : command(PowerDeliveryCommand::REQUEST_ALL_STATUS), seq(0) {
         floatValue = 0.0f;
     }
-    PowerDeliveryCommandData(PowerDeliveryCommand cmd) : command(cmd) {
+    PowerDeliveryCommandData(PowerDeliveryCommand cmd) : command(cmd), seq(0) {
         floatValue = 0.0f;
     }
-    PowerDeliveryCommandData(PowerDeliveryCommand cmd, float value) : command(cmd) {
+    PowerDeliveryCommandData(PowerDeliveryCommand cmd, float value) : command(cmd), seq(0) {
         floatValue = value;
     }
-    PowerDeliveryCommandData(PowerDeliveryCommand cmd, bool value) : command(cmd) {
+    PowerDeliveryCommandData(PowerDeliveryCommand cmd, bool value) : command(cmd), seq(0) {
         boolValue = value;
     }
-    PowerDeliveryCommandData(PowerDeliveryCommand cmd, int value) : command(cmd) {
+    PowerDeliveryCommandData(PowerDeliveryCommand cmd, int value) : command(cmd), seq(0) {
         intValue = value;
     }
 };
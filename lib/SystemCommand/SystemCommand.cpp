@@ -1,4 +1,5 @@
 #include "SystemCommand.h"
+#include "SystemStatus.h"
 
 
 // Singleton implementation
@@ -7,7 +8,10 @@ SystemCommand& SystemCommand::getInstance() {
     return instance;
 }
 
-SystemCommand::SystemCommand() : commandQueue(nullptr), pdCommandQueue(nullptr) {
+SystemCommand::SystemCommand()
+    : commandQueue(nullptr), ringProducer(nullptr), pdCommandQueue(nullptr), nextTraceId(1), emergencyStopQueue(nullptr), lastEmergencyStopId(0),
+      setpointOrphaned(false), coalescedCount(0), droppedCount(0) {
+    portMUX_INITIALIZE(&setpointLock);
 }
 
 SystemCommand::~SystemCommand() {
@@ -19,6 +23,10 @@ SystemCommand::~SystemCommand() {
         vQueueDelete(pdCommandQueue);
         pdCommandQueue = nullptr;
     }
+    if (emergencyStopQueue != nullptr) {
+        vQueueDelete(emergencyStopQueue);
+        emergencyStopQueue = nullptr;
+    }
 }
 
 bool SystemCommand::begin() {
@@ -38,9 +46,30 @@ bool SystemCommand::begin() {
         return false;
     }
     
+    // Emergency stop fast lane (mailbox, see xQueueOverwrite)
+    emergencyStopQueue = xQueueCreate(1, sizeof(StepperCommandData));
+    if (emergencyStopQueue == nullptr) {
+        dbg_println("ERROR: Failed to create emergency stop mailbox");
+        vQueueDelete(commandQueue);
+        vQueueDelete(pdCommandQueue);
+        commandQueue = nullptr;
+        pdCommandQueue = nullptr;
+        return false;
+    }
+    
     return true;
 }
 
+bool SystemCommand::claimRingLane() {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TaskHandle_t owner = ringProducer.load(std::memory_order_relaxed);
+    if (owner == nullptr && ringProducer.compare_exchange_strong(owner, self, std::memory_order_relaxed)) {
+        dbg_println("SystemCommand: Ring lane claimed");
+        return true;
+    }
+    return owner == self;
+}
+
 // Command management methods
 bool SystemCommand::sendCommand(const StepperCommandData& command, TickType_t timeout) {
     if (commandQueue == nullptr) {
@@ -50,12 +79,60 @@ bool SystemCommand::sendCommand(const StepperCommandData& command, TickType_t ti
     
     dbg_printf("SystemCommand: Sending command type %d\n", (int)command.command);
     
-    BaseType_t result = xQueueSend(commandQueue, &command, timeout);
+    StepperCommandData queued = command;
+    queued.trace.id = nextTraceId.fetch_add(1, std::memory_order_relaxed);
+    queued.trace.queuedUs = micros();
+    
+    // A setpoint whose FIFO entry still waits only updates its mailbox slot
+    const int8_t slot = coalescingSlot(queued);
+    if (slot >= 0) {
+        SetpointSlot& setpoint = setpoints[slot][queued.axis];
+        portENTER_CRITICAL(&setpointLock);
+        const bool waiting = setpoint.pending;
+        setpoint.command = queued;
+        setpoint.pending = true;
+        portEXIT_CRITICAL(&setpointLock);
+        
+        if (waiting) {
+            coalescedCount.fetch_add(1, std::memory_order_relaxed);
+            dbg_printf("SystemCommand: Command type %d coalesced with the queued one\n", (int)queued.command);
+            return true;
+        }
+    }
+    
+    BaseType_t result;
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (self != nullptr && self == ringProducer.load(std::memory_order_relaxed)) {
+        result = commandRing.push(queued) ? pdTRUE : pdFALSE; // Notifies the motion task
+    } else {
+        result = xQueueSend(commandQueue, &queued, timeout);
+        if (result == pdTRUE) {
+            commandRing.wakeConsumer();
+        }
+    }
     
     if (result == pdTRUE) {
         dbg_printf("SystemCommand: Command queued successfully. Queue depth: %d\n", 
-                     uxQueueMessagesWaiting(commandQueue));
+                     (int)getPendingCommandCount());
     } else {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        if (slot >= 0) {
+            SetpointSlot& setpoint = setpoints[slot][queued.axis];
+            portENTER_CRITICAL(&setpointLock);
+            const bool overwritten = setpoint.pending && setpoint.command.trace.id != queued.trace.id;
+            if (overwritten) {
+                // Another sender coalesced into the entry that never made it and was told it was
+                // queued - keep its value; the motion task picks it up once the FIFO has drained
+                setpoint.orphaned = true;
+                setpointOrphaned.store(true, std::memory_order_release);
+            } else {
+                setpoint.pending = false; // Still this value - later ones must queue again
+            }
+            portEXIT_CRITICAL(&setpointLock);
+            if (overwritten) {
+                commandRing.wakeConsumer();
+            }
+        }
         dbg_println("ERROR: SystemCommand failed to queue command!");
     }
     
@@ -87,46 +164,177 @@ bool SystemCommand::sendCommand(StepperCommand cmd, uint32_t value, TickType_t t
     return sendCommand(commandData, timeout);
 }
 
-bool SystemCommand::emergencyStop() {
-    if (commandQueue == nullptr) return false;
+bool SystemCommand::sendTransaction(const StepperTransaction& transaction, uint8_t axis, TickType_t timeout) {
+    StepperCommandData commandData(transaction);
+    commandData.axis = axis;
+    return sendCommand(commandData, timeout);
+}
+
+bool SystemCommand::emergencyStop(const CommandTrace& origin) {
+    if (emergencyStopQueue == nullptr) return false;
     
     StepperCommandData emergencyCmd(StepperCommand::EMERGENCY_STOP);
-    // Emergency stop has no timeout - must be processed immediately
-    return xQueueSend(commandQueue, &emergencyCmd, 0) == pdTRUE;
+    emergencyCmd.axis = STEPPER_AXIS_ALL;
+    emergencyCmd.trace = origin;
+    emergencyCmd.trace.id = nextTraceId.fetch_add(1, std::memory_order_relaxed);
+    emergencyCmd.trace.queuedUs = micros();
+    
+    // The mailbox always takes the stop; getCommand() checks it first after every wakeup
+    xQueueOverwrite(emergencyStopQueue, &emergencyCmd);
+    commandRing.wakeConsumer();
+    return true;
+}
+
+int8_t SystemCommand::coalescingSlot(const StepperCommandData& command) {
+    // Axis-wide setpoints stay ordered against the per-axis ones
+    if (command.axis >= STEPPER_MAX_AXES) return -1;
+    
+    switch (command.command) {
+        case StepperCommand::SET_SPEED:                 return 0;
+        case StepperCommand::SET_CURRENT:               return 1;
+        case StepperCommand::SET_ACCELERATION:          return 2;
+        case StepperCommand::SET_SPEED_VARIATION:       return 3;
+        case StepperCommand::SET_SPEED_VARIATION_PHASE: return 4;
+        default:                                        return -1;
+    }
+}
+
+bool SystemCommand::startsMotion(const StepperCommandData& command) {
+    if (command.command == StepperCommand::APPLY_TRANSACTION) {
+        return (command.transaction.fields & TRANSACTION_ENABLE) && command.transaction.enable;
+    }
+    // A direction change enables a disabled driver as well (StepperController::applyRunClockwise())
+    return command.command == StepperCommand::ENABLE || command.command == StepperCommand::SET_DIRECTION ||
+           command.command == StepperCommand::CALIBRATE_STALLGUARD;
+}
+
+void SystemCommand::takeLatestSetpoint(StepperCommandData& command) {
+    const int8_t slot = coalescingSlot(command);
+    if (slot < 0) return;
+    
+    SetpointSlot& setpoint = setpoints[slot][command.axis];
+    portENTER_CRITICAL(&setpointLock);
+    if (setpoint.pending) {
+        command = setpoint.command;
+        setpoint.pending = false;
+        setpoint.orphaned = false;
+    }
+    portEXIT_CRITICAL(&setpointLock);
+}
+
+bool SystemCommand::takeOrphanedSetpoint(StepperCommandData& command) {
+    if (!setpointOrphaned.load(std::memory_order_acquire)) return false;
+    
+    bool found = false;
+    portENTER_CRITICAL(&setpointLock);
+    setpointOrphaned.store(false, std::memory_order_relaxed);
+    for (auto& type : setpoints) {
+        for (SetpointSlot& setpoint : type) {
+            if (!setpoint.pending || !setpoint.orphaned) continue;
+            if (found) {
+                setpointOrphaned.store(true, std::memory_order_relaxed); // Delivered on the next call
+                continue;
+            }
+            command = setpoint.command;
+            setpoint.pending = false;
+            setpoint.orphaned = false;
+            found = true;
+        }
+    }
+    portEXIT_CRITICAL(&setpointLock);
+    return found;
+}
+
+bool SystemCommand::takeEmergencyStop(StepperCommandData& command) {
+    if (xQueueReceive(emergencyStopQueue, &command, 0) != pdTRUE) {
+        return false;
+    }
+    lastEmergencyStopId = command.trace.id;
+    dbg_printf("SystemCommand: Emergency stop %u taken from the fast lane\n", command.trace.id);
+    return true;
+}
+
+bool SystemCommand::takeNextCommand(StepperCommandData& command) {
+    if (commandRing.pop(command)) {
+        return true;
+    }
+    return xQueueReceive(commandQueue, &command, 0) == pdTRUE;
 }
 
 bool SystemCommand::getCommand(StepperCommandData& command, TickType_t timeout) {
-    if (commandQueue == nullptr) {
+    if (commandQueue == nullptr || emergencyStopQueue == nullptr) {
         dbg_println("ERROR: SystemCommand queue not initialized for getCommand!");
         return false;
     }
     
-    BaseType_t result = xQueueReceive(commandQueue, &command, timeout);
-    
-    if (result == pdTRUE) {
-        dbg_printf("SystemCommand: Retrieved command type %d. Remaining queue depth: %d\n", 
-                     (int)command.command, uxQueueMessagesWaiting(commandQueue));
+    if (commandRing.getConsumerTask() == nullptr) {
+        commandRing.setConsumerTask(xTaskGetCurrentTaskHandle());
     }
     
-    return result == pdTRUE;
+    const TickType_t start = xTaskGetTickCount();
+    while (true) {
+        // A pending emergency stop overtakes everything in the FIFO
+        if (takeEmergencyStop(command)) {
+            return true;
+        }
+        
+        if (takeNextCommand(command)) {
+            dbg_printf("SystemCommand: Retrieved command type %d. Remaining queue depth: %d\n", 
+                         (int)command.command, (int)getPendingCommandCount());
+            
+            takeLatestSetpoint(command);
+            if (startsMotion(command) && static_cast<int32_t>(command.trace.id - lastEmergencyStopId) < 0) {
+                // Sent before a stop that overtook it - must not restart the motor
+                dbg_printf("SystemCommand: Command type %d from before emergency stop %u discarded\n",
+                           (int)command.command, lastEmergencyStopId);
+                SystemStatus::getInstance().publishCommandAck(command.trace.seq, command.axis, CommandResult::REJECTED);
+                continue;
+            }
+            return true;
+        }
+        
+        if (takeOrphanedSetpoint(command)) {
+            dbg_printf("SystemCommand: Setpoint type %d delivered without its FIFO entry\n", (int)command.command);
+            return true;
+        }
+        
+        // Every sender notifies after queueing, so nothing that arrives from here on is missed
+        const TickType_t elapsed = xTaskGetTickCount() - start;
+        if (timeout != portMAX_DELAY && elapsed >= timeout) {
+            return false;
+        }
+        if (ulTaskNotifyTake(pdTRUE, timeout == portMAX_DELAY ? portMAX_DELAY : timeout - elapsed) == 0) {
+            return false; // Timed out without a notification - nothing was queued, no need to poll again
+        }
+    }
 }
 
 bool SystemCommand::hasCommands() const {
-    if (commandQueue == nullptr) return false;
-    
-    return uxQueueMessagesWaiting(commandQueue) > 0;
+    return getPendingCommandCount() > 0;
 }
 
 UBaseType_t SystemCommand::getPendingCommandCount() const {
     if (commandQueue == nullptr) return 0;
     
-    return uxQueueMessagesWaiting(commandQueue);
+    return uxQueueMessagesWaiting(commandQueue) + commandRing.size() + uxQueueMessagesWaiting(emergencyStopQueue);
 }
 
 void SystemCommand::clearCommands() {
     if (commandQueue == nullptr) return;
     
     xQueueReset(commandQueue);
+    StepperCommandData discarded;
+    while (commandRing.pop(discarded)) {
+    }
+    portENTER_CRITICAL(&setpointLock);
+    for (auto& type : setpoints) {
+        for (SetpointSlot& setpoint : type) {
+            setpoint.pending = false;
+            setpoint.orphaned = false;
+        }
+    }
+    setpointOrphaned.store(false, std::memory_order_relaxed);
+    portEXIT_CRITICAL(&setpointLock);
 }
 
 // Power delivery command management methods
@@ -8,22 +8,75 @@
  * This class provides thread-safe command management using FreeRTOS queues.
  * It handles all command forwarding and eliminates the need for separate command queues
  * in individual components.
+ *
+ * The stepper command FIFO has two lanes: the task that claimed the ring lane (the BLE
+ * callback task, see claimRingLane()) pushes into a lock-free SpscRing, every other sender into
+ * a FreeRTOS queue. Order is kept per sender, not across lanes. Any push gives the motion task a
+ * task notification, which is all getCommand() sleeps on. A full ring never waits - the sender
+ * reports the command as not queued at once, like a full queue after its timeout.
+ *
+ * Emergency stops take a fast lane: a one-slot mailbox that is overwritten (never full, never
+ * waits) and checked before the command FIFO; the stop only notifies the motion task. So a
+ * stop is never dropped and waits for at most one command. Commands that would start the motor
+ * again (enable, direction change, StallGuard calibration, enabling transaction) and were sent
+ * before the stop are discarded.
+ *
+ * Setpoints (speed, current, acceleration, variation strength and phase of one axis) are
+ * coalesced last-writer-wins: the FIFO holds at most one entry per setpoint and axis, and a
+ * newer value sent while it waits overwrites the value in its mailbox slot. The consumer gets
+ * the latest value at the position of the first unprocessed write, so a slider drag costs one
+ * command instead of dozens. Setpoints may thereby overtake ordered commands queued after the
+ * first write; everything else (enable/disable, resets, axis-wide setpoints) stays strictly FIFO.
+ * If the first write finds the FIFO full, it fails, but a value another sender coalesced into it
+ * in the meantime is kept and delivered as soon as the FIFO has drained.
+ *
+ * A transaction (sendTransaction()) carries several parameter changes as one FIFO entry; the
+ * motion task validates and applies them together. It is never coalesced.
  */
 
 #include <Arduino.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
+#include <atomic>
 #include "CommandTypes.h"
+#include "SpscRing.h"
 #include "dbg_print.h"
 
 // Queue size configuration
 #define COMMAND_QUEUE_SIZE          20     // Command queue size
+#define COMMAND_RING_SIZE           16     // Ring lane size (power of two, BLE keeps at most 8 commands in flight)
 #define PD_COMMAND_QUEUE_SIZE       10     // Power delivery command queue size
+#define COALESCED_SETPOINT_TYPES    5      // Setpoint commands with a last-writer-wins mailbox (see coalescingSlot())
 
 class SystemCommand {
 private:
     QueueHandle_t commandQueue;
+    SpscRing<StepperCommandData, COMMAND_RING_SIZE> commandRing; // Lane of ringProducer, consumer: the motion task
+    std::atomic<TaskHandle_t> ringProducer;
     QueueHandle_t pdCommandQueue;  // Separate queue for power delivery commands
+    std::atomic<uint32_t> nextTraceId; // Command trace IDs (CommandTrace::id), shared by all senders
+    QueueHandle_t emergencyStopQueue;  // Fast lane: one-slot mailbox for the latest emergency stop
+    uint32_t lastEmergencyStopId;      // Consumer side: trace ID of the last stop delivered from the fast lane
+
+    // Setpoint mailboxes: latest value per setpoint type and axis, pending while its FIFO entry waits
+    struct SetpointSlot {
+        StepperCommandData command;
+        bool pending;
+        bool orphaned; // Pending, but its FIFO entry could not be queued - delivered once the FIFO is empty
+        SetpointSlot() : pending(false), orphaned(false) {}
+    };
+    SetpointSlot setpoints[COALESCED_SETPOINT_TYPES][STEPPER_MAX_AXES];
+    portMUX_TYPE setpointLock;
+    std::atomic<bool> setpointOrphaned;   // Some slot is orphaned (saves the scan on every getCommand())
+    std::atomic<uint32_t> coalescedCount; // Setpoints overwritten before the motion task took them
+    std::atomic<uint32_t> droppedCount;   // Commands not queued (queue full)
+
+    static int8_t coalescingSlot(const StepperCommandData& command); // -1 = ordered (FIFO) command
+    static bool startsMotion(const StepperCommandData& command);     // Discarded when sent before a fast-lane stop
+    bool takeEmergencyStop(StepperCommandData& command);
+    bool takeNextCommand(StepperCommandData& command); // Ring lane first, then the queue; never waits
+    void takeLatestSetpoint(StepperCommandData& command);
+    bool takeOrphanedSetpoint(StepperCommandData& command);
     
     // Singleton implementation
     SystemCommand();
@@ -40,22 +93,28 @@ public:
     // Initialization
     bool begin();
     
-    // Command management (thread-safe)
+    // Make the calling task the only sender on the lock-free ring lane; false if another task has it
+    bool claimRingLane();
+    
+    // Command management (thread-safe). Each queued command gets the next trace ID and its queue timestamp.
     bool sendCommand(const StepperCommandData& command, TickType_t timeout = pdMS_TO_TICKS(10));
     bool sendCommand(StepperCommand cmd, TickType_t timeout = pdMS_TO_TICKS(10));
     bool sendCommand(StepperCommand cmd, float value, TickType_t timeout = pdMS_TO_TICKS(10));
     bool sendCommand(StepperCommand cmd, bool value, TickType_t timeout = pdMS_TO_TICKS(10));
     bool sendCommand(StepperCommand cmd, int value, TickType_t timeout = pdMS_TO_TICKS(10));
     bool sendCommand(StepperCommand cmd, uint32_t value, TickType_t timeout = pdMS_TO_TICKS(10));
+    bool sendTransaction(const StepperTransaction& transaction, uint8_t axis = 0, TickType_t timeout = pdMS_TO_TICKS(10));
     
-    // Emergency stop with no timeout (highest priority)
-    bool emergencyStop();
+    // Emergency stop through the fast lane (never blocks, never dropped); origin = BLE trace stamps
+    bool emergencyStop(const CommandTrace& origin = CommandTrace());
     
-    // Command retrieval (thread-safe)
+    // Command retrieval (single consumer: the motion task). A pending emergency stop comes first.
     bool getCommand(StepperCommandData& command, TickType_t timeout = portMAX_DELAY);
     bool hasCommands() const;
     UBaseType_t getPendingCommandCount() const;
-    void clearCommands();
+    void clearCommands(); // Consumer side only (drains the ring lane)
+    uint32_t getCoalescedCount() const { return coalescedCount.load(std::memory_order_relaxed); }
+    uint32_t getDroppedCount() const { return droppedCount.load(std::memory_order_relaxed); }
     
     // Power delivery command management (thread-safe)
     bool sendPowerDeliveryCommand(const PowerDeliveryCommandData& command, TickType_t timeout = pdMS_TO_TICKS(10));
@@ -25,20 +25,33 @@ enum class StatusUpdateType {
     ENABLED_CHANGED,
     CURRENT_CHANGED,
     ACCELERATION_CHANGED,
+    JERK_LIMIT_CHANGED,         // S-curve jerk limit in steps/s³ (0 = off)
+    MICROSTEPS_CHANGED,         // Driver microstep resolution (dynamic microstepping speed band)
     SPEED_VARIATION_ENABLED_CHANGED,
     SPEED_VARIATION_STRENGTH_CHANGED,
     SPEED_VARIATION_PHASE_CHANGED,
+    SPEED_VARIATION_AUTO_TUNE_CHANGED, // Auto-tune of phase/strength from the load map on/off
     // Periodic updates - now separate for each value
     SPEED_UPDATE,
     TOTAL_REVOLUTIONS_UPDATE,
+    LIFETIME_REVOLUTIONS_UPDATE, // Persisted lifetime odometer in output revolutions
     RUNTIME_UPDATE,
     STALL_DETECTED_UPDATE,
     STALL_COUNT_UPDATE,
     TMC2209_STATUS_UPDATE,
     TMC2209_TEMPERATURE_UPDATE, // TMC2209 temperature status
+    SPEED_SCHEDULE_WAKEUPS_SAVED, // Speed update wakeups saved per revolution vs. fixed-interval polling
+    MOTION_LOOP_MAX_LATENCY_US,   // Worst-case stepper loop pass duration since the last report (µs)
+    SETTINGS_FLASH_WRITES,        // Settings records written to flash since boot
+    SETTINGS_SAVE_REQUESTS,       // Settings save requests since boot (coalesced into SETTINGS_FLASH_WRITES)
+    COMMANDS_COALESCED,           // Setpoint commands overwritten by a newer value before they were applied, since boot
+    COMMANDS_DROPPED,             // Commands not queued because the command queue was full, since boot
     // StallGuard updates
     STALLGUARD_THRESHOLD_CHANGED, // StallGuard threshold changed (0-255, 0=least sensitive, 255=most sensitive)
     STALLGUARD_RESULT_UPDATE,     // StallGuard result (0-510)
+    LOAD_RIPPLE_UPDATE,           // First-harmonic SG ripple relative to its mean (auto-tune residual)
+    STALLGUARD_CALIBRATION_ACTIVE,         // Threshold calibration run in progress
+    STALLGUARD_CALIBRATION_MARGIN_CHANGED, // Calibration margin (0-90%)
     // Power Delivery status updates
     PD_NEGOTIATION_STATUS,      // Power delivery negotiation status
     PD_NEGOTIATED_VOLTAGE,      // Negotiated voltage from PD chip
@@ -46,6 +59,42 @@ enum class StatusUpdateType {
     PD_POWER_GOOD_STATUS        // Power good signal status
 };
 
+// Status block types - array payloads published as one message instead of many single updates
+enum class StatusBlockType {
+    LOAD_MAP,                   // Angle-resolved StallGuard load map (one averaged SG_RESULT per bin, -1 = no samples)
+    STALLGUARD_CALIBRATION,     // Calibration result: min, mean, p5, p50, p95, max, threshold, margin,
+                                // then SG_RESULT histogram buckets (32 SG units each); info = sample count
+    MOTION_TIMING,              // Motion core timing (MotionTimingWindow field order, from isrCountPerSecond);
+                                // info = window length in ms
+    LATENCY_HISTOGRAM,          // One latency histogram (us): count, min, mean, p50, p90, p99, p99.9, max, then
+                                // (bucket lower bound, count) pairs; info = LatencyKind, label = job name
+    COMMAND_TRACE,              // One traced command: command type, then the CommandStage durations (us, -1 = not
+                                // passed); info = trace ID
+    COMMAND_LATENCY,            // Per CommandStage: count, p50, p99, p99.9, max (us); info = traced commands
+    TRANSACTION                 // Parameters after a transaction: applied (0/1), speed (mRPM), acceleration,
+                                // variation strength (1/1000), phase (mrad), variation enabled, auto-tune,
+                                // enabled, clockwise; info = trace ID of the transaction
+};
+
+// What a LATENCY_HISTOGRAM block measures
+enum class LatencyKind {
+    LATENESS,                   // Job start time minus its deadline
+    EXECUTION,                  // Job run time
+    QUEUE_WAIT                  // Command time in the command queue (sendCommand() to dequeue)
+};
+
+// Outcome of a command, reported to the client in its ack
+enum class CommandResult : uint8_t {
+    OK,                         // Applied as requested
+    ADJUSTED,                   // Applied with a different value (clamped or limited) - see the ack value
+    REJECTED,                   // Not applied (invalid value or state, or overtaken by an emergency stop)
+    QUEUE_FULL,                 // Not queued - may be sent again
+    UNAVAILABLE                 // Target axis not fitted
+};
+
+// Maximum number of values in one status block
+#define STATUS_BLOCK_MAX_VALUES 64
+
 // Notification structure (for warnings and errors only)
 struct NotificationData {
     NotificationType type;
@@ -64,6 +113,7 @@ struct NotificationData {
 // Status update structure
 struct StatusUpdateData {
     StatusUpdateType type;
+    uint8_t axis;            // Reporting axis (0 = main spit, also used for system-wide values)
     union {
         float floatValue;    // for speed, acceleration, revolutions, etc.
         bool boolValue;      // for direction, enabled, etc.
@@ -72,24 +122,66 @@ struct StatusUpdateData {
         unsigned long ulongValue; // for runtime, timestamps
     };
     // Helper constructors
-    StatusUpdateData() : type(StatusUpdateType::SPEED_UPDATE) {
+    StatusUpdateData() : type(StatusUpdateType::SPEED_UPDATE), axis(0) {
         floatValue = 0.0f;
     }
-    StatusUpdateData(StatusUpdateType t, float value) : type(t) {
+    StatusUpdateData(StatusUpdateType t, float value) : type(t), axis(0) {
         floatValue = value;
     }
-    StatusUpdateData(StatusUpdateType t, bool value) : type(t) {
+    StatusUpdateData(StatusUpdateType t, bool value) : type(t), axis(0) {
         boolValue = value;
     }
-    StatusUpdateData(StatusUpdateType t, int value) : type(t) {
+    StatusUpdateData(StatusUpdateType t, int value) : type(t), axis(0) {
         intValue = value;
     }
-    StatusUpdateData(StatusUpdateType t, uint32_t value) : type(t) {
+    StatusUpdateData(StatusUpdateType t, uint32_t value) : type(t), axis(0) {
         uint32Value = value;
     }
-    StatusUpdateData(StatusUpdateType t, unsigned long value) : type(t) {
+    StatusUpdateData(StatusUpdateType t, unsigned long value) : type(t), axis(0) {
         ulongValue = value;
     }
 };
 
+// Status block structure (fixed size so it can be passed through a FreeRTOS queue)
+struct StatusBlockData {
+    StatusBlockType type;
+    uint8_t axis;                            // Reporting axis
+    uint32_t info;                           // Block specific scalar (e.g. sample count)
+    const char* label;                       // Static name of what the block describes (e.g. a job), or nullptr
+    uint16_t count;                          // Number of valid entries in values
+    int32_t values[STATUS_BLOCK_MAX_VALUES];
+    StatusBlockData() : type(StatusBlockType::LOAD_MAP), axis(0), info(0), label(nullptr), count(0) {}
+    explicit StatusBlockData(StatusBlockType t) : type(t), axis(0), info(0), label(nullptr), count(0) {}
+    bool addValue(int32_t value) {
+        if (count >= STATUS_BLOCK_MAX_VALUES) return false;
+        values[count++] = value;
+        return true;
+    }
+};
+
+// Acknowledgement of one client command (BLE "seq"), sent once the command took effect or failed
+struct CommandAckData {
+    uint16_t seq;                // Client sequence number
+    uint8_t axis;                // Axis that applied the command
+    CommandResult result;
+    bool hasValue;               // False for commands without a value (resets, status requests)
+    float value;                 // Value in effect afterwards, e.g. the clamped speed
+    CommandAckData() : seq(0), axis(0), result(CommandResult::OK), hasValue(false), value(0.0f) {}
+};
+
+// Per-axis periodic telemetry. Exchanged as a latest-value snapshot per axis instead of four
+// queued status updates every FAST_UPDATE_INTERVAL, so queue traffic does not grow with the axis count.
+struct StepperTelemetry {
+    float currentSpeed;          // Measured speed (RPM)
+    float totalRevolutions;      // Output revolutions since the last counter reset
+    unsigned long runtime;       // ms since the motor was first started
+    bool runtimeValid;           // False until the motor was started once
+    int16_t stallGuardResult;    // SG_RESULT (0-510), -1 while the driver is not communicating
+    uint32_t stepRate;           // Step generator rate at the driver resolution (steps/s = step interrupts/s)
+    uint16_t microsteps;         // Driver microstep resolution
+    StepperTelemetry()
+        : currentSpeed(0.0f), totalRevolutions(0.0f), runtime(0), runtimeValid(false), stallGuardResult(-1),
+          stepRate(0), microsteps(0) {}
+};
+
 #endif // STATUS_TYPES_H
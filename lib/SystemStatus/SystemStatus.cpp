@@ -6,7 +6,8 @@ SystemStatus& SystemStatus::getInstance() {
     return instance;
 }
 
-SystemStatus::SystemStatus() : notificationQueue(nullptr), statusUpdateQueue(nullptr) {
+SystemStatus::SystemStatus()
+    : notificationQueue(nullptr), statusUpdateQueue(nullptr), ringProducer(nullptr), statusBlockQueue(nullptr), commandAckQueue(nullptr) {
 }
 
 SystemStatus::~SystemStatus() {
@@ -18,6 +19,14 @@ SystemStatus::~SystemStatus() {
         vQueueDelete(statusUpdateQueue);
         statusUpdateQueue = nullptr;
     }
+    if (statusBlockQueue != nullptr) {
+        vQueueDelete(statusBlockQueue);
+        statusBlockQueue = nullptr;
+    }
+    if (commandAckQueue != nullptr) {
+        vQueueDelete(commandAckQueue);
+        commandAckQueue = nullptr;
+    }
 }
 
 bool SystemStatus::begin() {
@@ -37,9 +46,42 @@ bool SystemStatus::begin() {
         return false;
     }
     
+    // Create status block queue
+    statusBlockQueue = xQueueCreate(STATUS_BLOCK_QUEUE_SIZE, sizeof(StatusBlockData));
+    if (statusBlockQueue == nullptr) {
+        dbg_println("ERROR: Failed to create status block queue");
+        vQueueDelete(notificationQueue);
+        notificationQueue = nullptr;
+        vQueueDelete(statusUpdateQueue);
+        statusUpdateQueue = nullptr;
+        return false;
+    }
+    
+    // Create command ack queue
+    commandAckQueue = xQueueCreate(COMMAND_ACK_QUEUE_SIZE, sizeof(CommandAckData));
+    if (commandAckQueue == nullptr) {
+        dbg_println("ERROR: Failed to create command ack queue");
+        vQueueDelete(notificationQueue);
+        notificationQueue = nullptr;
+        vQueueDelete(statusUpdateQueue);
+        statusUpdateQueue = nullptr;
+        vQueueDelete(statusBlockQueue);
+        statusBlockQueue = nullptr;
+        return false;
+    }
+    
     return true;
 }
 
+bool SystemStatus::claimRingLane() {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TaskHandle_t owner = ringProducer.load(std::memory_order_relaxed);
+    if (owner == nullptr && ringProducer.compare_exchange_strong(owner, self, std::memory_order_relaxed)) {
+        return true;
+    }
+    return owner == self;
+}
+
 // Notification management methods
 void SystemStatus::sendNotification(NotificationType type, const String& message) {
     if (notificationQueue == nullptr) return;
@@ -90,61 +132,124 @@ void SystemStatus::clearNotifications() {
 
 // Status update management methods
 void SystemStatus::publishStatusUpdate(StatusUpdateType type, float value) {
-    if (statusUpdateQueue == nullptr) return;
-    
-    StatusUpdateData statusData(type, value);
-    // Don't block if queue is full - just drop the update
-    xQueueSend(statusUpdateQueue, &statusData, 0);
+    publishStatusUpdate(StatusUpdateData(type, value));
 }
 
 void SystemStatus::publishStatusUpdate(StatusUpdateType type, bool value) {
-    if (statusUpdateQueue == nullptr) return;
-    
-    StatusUpdateData statusData(type, value);
-    xQueueSend(statusUpdateQueue, &statusData, 0);
+    publishStatusUpdate(StatusUpdateData(type, value));
 }
 
 void SystemStatus::publishStatusUpdate(StatusUpdateType type, int value) {
-    if (statusUpdateQueue == nullptr) return;
-    
-    StatusUpdateData statusData(type, value);
-    xQueueSend(statusUpdateQueue, &statusData, 0);
+    publishStatusUpdate(StatusUpdateData(type, value));
 }
 
 void SystemStatus::publishStatusUpdate(StatusUpdateType type, uint32_t value) {
-    if (statusUpdateQueue == nullptr) return;
-    
-    StatusUpdateData statusData(type, value);
-    xQueueSend(statusUpdateQueue, &statusData, 0);
+    publishStatusUpdate(StatusUpdateData(type, value));
 }
 
 void SystemStatus::publishStatusUpdate(StatusUpdateType type, unsigned long value) {
+    publishStatusUpdate(StatusUpdateData(type, value));
+}
+
+void SystemStatus::publishStatusUpdate(const StatusUpdateData& status) {
     if (statusUpdateQueue == nullptr) return;
     
-    StatusUpdateData statusData(type, value);
-    xQueueSend(statusUpdateQueue, &statusData, 0);
+    // Don't block if the ring or queue is full - just drop the update
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (self != nullptr && self == ringProducer.load(std::memory_order_relaxed)) {
+        statusUpdateRing.push(status);
+    } else {
+        xQueueSend(statusUpdateQueue, &status, 0);
+    }
 }
 
 bool SystemStatus::getStatusUpdate(StatusUpdateData& status) {
     if (statusUpdateQueue == nullptr) return false;
     
+    if (statusUpdateRing.pop(status)) {
+        return true;
+    }
     return xQueueReceive(statusUpdateQueue, &status, 0) == pdTRUE; // Non-blocking
 }
 
 bool SystemStatus::hasStatusUpdates() const {
-    if (statusUpdateQueue == nullptr) return false;
-    
-    return uxQueueMessagesWaiting(statusUpdateQueue) > 0;
+    return getPendingStatusUpdateCount() > 0;
 }
 
 UBaseType_t SystemStatus::getPendingStatusUpdateCount() const {
     if (statusUpdateQueue == nullptr) return 0;
     
-    return uxQueueMessagesWaiting(statusUpdateQueue);
+    return uxQueueMessagesWaiting(statusUpdateQueue) + statusUpdateRing.size();
 }
 
 void SystemStatus::clearStatusUpdates() {
     if (statusUpdateQueue == nullptr) return;
     
     xQueueReset(statusUpdateQueue);
+    StatusUpdateData discarded;
+    while (statusUpdateRing.pop(discarded)) {
+    }
+}
+
+// Status block management methods
+void SystemStatus::publishStatusBlock(const StatusBlockData& block) {
+    if (statusBlockQueue == nullptr) return;
+    
+    // Don't block if queue is full - just drop the block
+    xQueueSend(statusBlockQueue, &block, 0);
+}
+
+UBaseType_t SystemStatus::getStatusBlockSpaces() const {
+    if (statusBlockQueue == nullptr) return 0;
+    
+    return uxQueueSpacesAvailable(statusBlockQueue);
+}
+
+bool SystemStatus::getStatusBlock(StatusBlockData& block) {
+    if (statusBlockQueue == nullptr) return false;
+    
+    return xQueueReceive(statusBlockQueue, &block, 0) == pdTRUE; // Non-blocking
+}
+
+// Command ack methods
+void SystemStatus::publishCommandAck(uint16_t seq, uint8_t axis, CommandResult result) {
+    if (commandAckQueue == nullptr || seq == 0) return;
+    
+    CommandAckData ack;
+    ack.seq = seq;
+    ack.axis = axis;
+    ack.result = result;
+    xQueueSend(commandAckQueue, &ack, 0);
+}
+
+void SystemStatus::publishCommandAck(uint16_t seq, uint8_t axis, CommandResult result, float value) {
+    if (commandAckQueue == nullptr || seq == 0) return;
+    
+    CommandAckData ack;
+    ack.seq = seq;
+    ack.axis = axis;
+    ack.result = result;
+    ack.hasValue = true;
+    ack.value = value;
+    xQueueSend(commandAckQueue, &ack, 0);
+}
+
+bool SystemStatus::getCommandAck(CommandAckData& ack) {
+    if (commandAckQueue == nullptr) return false;
+    
+    return xQueueReceive(commandAckQueue, &ack, 0) == pdTRUE; // Non-blocking
+}
+
+// Telemetry snapshot methods
+void SystemStatus::publishTelemetry(uint8_t axis, const StepperTelemetry& values) {
+    if (axis >= STEPPER_MAX_AXES) return;
+    
+    telemetry[axis].publish(values);
+}
+
+bool SystemStatus::getTelemetry(uint8_t axis, StepperTelemetry& values) {
+    if (axis >= STEPPER_MAX_AXES || !telemetry[axis].update()) return false;
+    
+    values = telemetry[axis].read();
+    return true;
 }
@@ -8,22 +8,37 @@
  * This class provides thread-safe communication management using FreeRTOS queues.
  * It handles both notifications (warnings and errors) and status updates in a single
  * unified interface for the stepper motor system.
+ *
+ * Status updates from the task that claimed the ring lane (the motion task, which publishes
+ * most of them) go through a lock-free SpscRing instead of the queue. The BLE task polls both.
  */
 
 #include <Arduino.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
+#include <atomic>
 #include "StatusTypes.h"
+#include "CommandTypes.h"
+#include "TripleBuffer.h"
+#include "SpscRing.h"
 #include "dbg_print.h"
 
 // Queue size configuration
 #define NOTIFICATION_QUEUE_SIZE     10     // Notification queue size (smaller since only warnings/errors)
 #define STATUS_UPDATE_QUEUE_SIZE    30     // Status update queue size
+#define STATUS_UPDATE_RING_SIZE     32     // Ring lane size (power of two)
+#define STATUS_BLOCK_QUEUE_SIZE     4      // Status block queue size (blocks are large and infrequent)
+#define COMMAND_ACK_QUEUE_SIZE      20     // Command ack queue size (one per client command, like COMMAND_QUEUE_SIZE)
 
 class SystemStatus {
 private:
     QueueHandle_t notificationQueue;
     QueueHandle_t statusUpdateQueue;
+    SpscRing<StatusUpdateData, STATUS_UPDATE_RING_SIZE> statusUpdateRing; // Lane of ringProducer, consumer: BLE task
+    std::atomic<TaskHandle_t> ringProducer;
+    QueueHandle_t statusBlockQueue;
+    QueueHandle_t commandAckQueue;
+    TripleBuffer<StepperTelemetry> telemetry[STEPPER_MAX_AXES]; // Producer: stepper task, consumer: BLE task
     
     // Singleton implementation
     SystemStatus();
@@ -40,6 +55,9 @@ public:
     // Initialization
     bool begin();
     
+    // Make the calling task the only publisher on the lock-free status update ring lane
+    bool claimRingLane();
+    
     // Notification management (thread-safe)
     void sendNotification(NotificationType type, const String& message = "");
     bool getNotification(NotificationData& notification);
@@ -53,12 +71,27 @@ public:
     void publishStatusUpdate(StatusUpdateType type, int value);
     void publishStatusUpdate(StatusUpdateType type, uint32_t value);
     void publishStatusUpdate(StatusUpdateType type, unsigned long value);
+    void publishStatusUpdate(const StatusUpdateData& status); // Pre-built update (e.g. with an axis set)
     
-    // Status update retrieval (thread-safe)
+    // Status update retrieval (single consumer: the BLE task)
     bool getStatusUpdate(StatusUpdateData& status);
     bool hasStatusUpdates() const;
     UBaseType_t getPendingStatusUpdateCount() const;
     void clearStatusUpdates();
+
+    // Status block management (thread-safe, dropped if the queue is full)
+    void publishStatusBlock(const StatusBlockData& block);
+    UBaseType_t getStatusBlockSpaces() const; // Blocks that can be published right now without a drop
+    bool getStatusBlock(StatusBlockData& block);
+
+    // Command acks (thread-safe, dropped if the queue is full; seq 0 = nothing to acknowledge)
+    void publishCommandAck(uint16_t seq, uint8_t axis, CommandResult result);
+    void publishCommandAck(uint16_t seq, uint8_t axis, CommandResult result, float value);
+    bool getCommandAck(CommandAckData& ack);
+
+    // Per-axis telemetry snapshot (wait-free, newest value wins, one producer and one consumer per axis)
+    void publishTelemetry(uint8_t axis, const StepperTelemetry& values);
+    bool getTelemetry(uint8_t axis, StepperTelemetry& values); // False if nothing new since the last call
 };
 
 #endif // COMMUNICATION_MANAGER_H
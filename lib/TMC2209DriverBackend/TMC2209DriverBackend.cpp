@@ -0,0 +1,16 @@
+#include "TMC2209DriverBackend.h"
+
+TMC2209DriverBackend::TMC2209DriverBackend(DriverIOTask& driverIO, uint8_t channel, uint8_t diagPin)
+    : driverIO(driverIO), registers(driverIO.getRegisters(channel)), channel(channel), diagPin(diagPin) {
+}
+
+bool TMC2209DriverBackend::begin() {
+    if (diagPin != TMC2209_DIAG_PIN_NONE) {
+        pinMode(diagPin, INPUT);
+    }
+    return true;
+}
+
+bool TMC2209DriverBackend::isStallDetected() {
+    return diagPin != TMC2209_DIAG_PIN_NONE && digitalRead(diagPin);
+}
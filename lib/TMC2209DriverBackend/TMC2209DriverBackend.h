@@ -0,0 +1,47 @@
+#ifndef TMC2209_DRIVER_BACKEND_H
+#define TMC2209_DRIVER_BACKEND_H
+
+/**
+ * @file TMC2209DriverBackend.h
+ * @brief IDriverBackend on a TMC2209 served by the driver I/O task
+ *
+ * Register setters go to the channel's TMC2209RegisterCache; the UART itself is
+ * only ever touched by DriverIOTask. The stall output is the driver's DIAG line.
+ */
+
+#include <Arduino.h>
+#include "DriverIOTask.h"
+#include "IDriverBackend.h"
+
+#define TMC2209_DIAG_PIN_NONE 0xFF // No DIAG line wired (stall never reported)
+
+class TMC2209DriverBackend : public IDriverBackend {
+private:
+    DriverIOTask& driverIO;
+    TMC2209RegisterCache& registers;
+    const uint8_t channel;
+    const uint8_t diagPin;
+
+public:
+    TMC2209DriverBackend(DriverIOTask& driverIO, uint8_t channel, uint8_t diagPin);
+
+    bool begin() override;
+
+    void setStealthChop(bool enabled) override { registers.setStealthChop(enabled); }
+    void setAutomaticPwm(bool enabled) override { registers.setAutomaticPwm(enabled); }
+    void setRunCurrent(uint8_t percent) override { registers.setRunCurrent(percent); }
+    void setMicrostepsPerStep(uint16_t microsteps) override { registers.setMicrostepsPerStep(microsteps); }
+    void setEnabled(bool enabled) override { registers.setEnabled(enabled); }
+    void setCoolStepDurationThreshold(uint32_t threshold) override { registers.setCoolStepDurationThreshold(threshold); }
+    void setStallGuardThreshold(uint8_t threshold) override { registers.setStallGuardThreshold(threshold); }
+    void setVelocity(int32_t vactual) override { registers.setVelocity(vactual); }
+    void markAllDirty() override { registers.markAllDirty(); }
+    void applyRegisters() override { driverIO.requestFlush(); }
+
+    void requestStallGuardSample(uint8_t tag) override { driverIO.requestStallGuardSample(channel, tag); }
+    const DriverDiagnostics& getDiagnostics() override { return driverIO.getDiagnostics(channel); }
+
+    bool isStallDetected() override;
+};
+
+#endif // TMC2209_DRIVER_BACKEND_H
@@ -0,0 +1,181 @@
+#include "TMC2209RegisterCache.h"
+
+TMC2209RegisterCache::TMC2209RegisterCache(TMC2209& driver)
+    : driver(driver),
+      stealthChopEnabled(true), automaticPwmEnabled(true), runCurrent(30), microstepsPerStep(16),
+      driverEnabled(false), coolStepDurationThreshold(0), stallGuardThreshold(0), velocity(0), dirty(DIRTY_ALL),
+      stallGuardResult(0), status(),
+      communicating(false), lastTransmissionCounter(0), writeCount(0), communicationErrorCount(0),
+      appliedMicrosteps(0), microstepsAppliedUs(0), appliedVelocity(0) {
+}
+
+void TMC2209RegisterCache::setStealthChop(bool enabled) {
+    if (stealthChopEnabled.exchange(enabled) == enabled) return;
+    dirty.fetch_or(DIRTY_GCONF);
+}
+
+void TMC2209RegisterCache::setAutomaticPwm(bool enabled) {
+    if (automaticPwmEnabled.exchange(enabled) == enabled) return;
+    dirty.fetch_or(DIRTY_PWMCONF);
+}
+
+void TMC2209RegisterCache::setRunCurrent(uint8_t percent) {
+    if (runCurrent.exchange(percent) == percent) return;
+    dirty.fetch_or(DIRTY_IHOLD_IRUN);
+}
+
+void TMC2209RegisterCache::setMicrostepsPerStep(uint16_t microsteps) {
+    if (microstepsPerStep.exchange(microsteps) == microsteps) return;
+    dirty.fetch_or(DIRTY_CHOPCONF);
+}
+
+void TMC2209RegisterCache::setEnabled(bool enabled) {
+    if (driverEnabled.exchange(enabled) == enabled) return;
+    dirty.fetch_or(DIRTY_TOFF);
+}
+
+void TMC2209RegisterCache::setCoolStepDurationThreshold(uint32_t threshold) {
+    if (coolStepDurationThreshold.exchange(threshold) == threshold) return;
+    dirty.fetch_or(DIRTY_TCOOLTHRS);
+}
+
+void TMC2209RegisterCache::setStallGuardThreshold(uint8_t threshold) {
+    if (stallGuardThreshold.exchange(threshold) == threshold) return;
+    dirty.fetch_or(DIRTY_SGTHRS);
+}
+
+void TMC2209RegisterCache::setVelocity(int32_t vactual) {
+    if (velocity.exchange(vactual) == vactual) return;
+    dirty.fetch_or(DIRTY_VACTUAL);
+}
+
+void TMC2209RegisterCache::markAllDirty() {
+    dirty.store(DIRTY_ALL);
+}
+
+bool TMC2209RegisterCache::flush() {
+    // Keep changes pending while the driver is unreachable; probe() flushes them on recovery
+    if (!communicating) return false;
+
+    // Claim the pending set; setters racing with this flush simply mark their register dirty again
+    const uint32_t pending = dirty.exchange(0);
+    if (!pending) return true;
+
+    // Each library setter below is exactly one UART register write
+    uint8_t writes = 0;
+    uint16_t writtenMicrosteps = 0;
+    uint32_t microstepsWrittenUs = 0;
+    bool velocityWritten = false;
+    int32_t writtenVelocity = 0;
+
+    if (pending & DIRTY_GCONF) {
+        if (stealthChopEnabled) driver.enableStealthChop(); else driver.disableStealthChop();
+        writes++;
+    }
+    if (pending & DIRTY_PWMCONF) {
+        if (automaticPwmEnabled) {
+            driver.enableAutomaticCurrentScaling();
+            driver.enableAutomaticGradientAdaptation();
+        } else {
+            driver.disableAutomaticCurrentScaling();
+            driver.disableAutomaticGradientAdaptation();
+        }
+        writes += 2;
+    }
+    if (pending & DIRTY_IHOLD_IRUN) {
+        driver.setRunCurrent(runCurrent);
+        writes++;
+    }
+    if (pending & DIRTY_CHOPCONF) {
+        writtenMicrosteps = microstepsPerStep;
+        driver.setMicrostepsPerStep(writtenMicrosteps);
+        microstepsWrittenUs = micros(); // The driver switches MRES when the datagram is through
+        writes++;
+    }
+    if (pending & DIRTY_TOFF) {
+        if (driverEnabled) driver.enable(); else driver.disable();
+        writes++;
+    }
+    if (pending & DIRTY_TCOOLTHRS) {
+        driver.setCoolStepDurationThreshold(coolStepDurationThreshold);
+        writes++;
+    }
+    if (pending & DIRTY_SGTHRS) {
+        driver.setStallGuardThreshold(stallGuardThreshold);
+        writes++;
+    }
+    if (pending & DIRTY_VACTUAL) {
+        // Written after CHOPCONF, so a resolution change and the matching velocity land together
+        writtenVelocity = velocity;
+        if (writtenVelocity != 0) driver.moveAtVelocity(writtenVelocity); else driver.moveUsingStepDirInterface();
+        velocityWritten = true;
+        writes++;
+    }
+
+    writeCount += writes;
+
+    // IFCNT counts successful writes modulo 256
+    const uint8_t transmissionCounter = driver.getInterfaceTransmissionCounter();
+    const uint8_t acceptedWrites = transmissionCounter - lastTransmissionCounter;
+    lastTransmissionCounter = transmissionCounter;
+
+    if (acceptedWrites != writes) {
+        communicationErrorCount++;
+        dbg_printf("TMC2209: %u of %u register writes acknowledged\n", acceptedWrites, writes);
+
+        // The written values may not have landed - rewrite everything once the driver answers again
+        markAllDirty();
+        communicating = false;
+        return false;
+    }
+
+    communicating = true;
+    if (writtenMicrosteps != 0) {
+        appliedMicrosteps = writtenMicrosteps;
+        microstepsAppliedUs = microstepsWrittenUs;
+    }
+    if (velocityWritten) {
+        appliedVelocity = writtenVelocity;
+    }
+    return true;
+}
+
+bool TMC2209RegisterCache::verifyCommunication() {
+    const uint8_t transmissionCounter = driver.getInterfaceTransmissionCounter();
+
+    if (transmissionCounter != lastTransmissionCounter) {
+        // Either the read failed or the driver was reset and reconfigured behind our back
+        communicationErrorCount++;
+        lastTransmissionCounter = transmissionCounter;
+        communicating = false;
+        return false;
+    }
+
+    return communicating;
+}
+
+bool TMC2209RegisterCache::probe() {
+    const bool isCommunicating = driver.isSetupAndCommunicating();
+
+    if (isCommunicating && !communicating) {
+        // Driver came back - it may have lost power, so resynchronize all registers
+        dbg_println("TMC2209: Communication restored, resynchronizing registers");
+        lastTransmissionCounter = driver.getInterfaceTransmissionCounter();
+        markAllDirty();
+        communicating = true;
+        return flush();
+    }
+
+    communicating = isCommunicating;
+    return communicating;
+}
+
+uint16_t TMC2209RegisterCache::readStallGuardResult() {
+    stallGuardResult = driver.getStallGuardResult();
+    return stallGuardResult;
+}
+
+const TMC2209::Status& TMC2209RegisterCache::readStatus() {
+    status = driver.getStatus();
+    return status;
+}
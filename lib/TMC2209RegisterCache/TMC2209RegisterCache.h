@@ -0,0 +1,122 @@
+#ifndef TMC2209_REGISTER_CACHE_H
+#define TMC2209_REGISTER_CACHE_H
+
+/**
+ * @file TMC2209RegisterCache.h
+ * @brief RAM shadow of the TMC2209 configuration and read-back registers
+ *
+ * Setters only update the shadow and mark the register dirty; flush() writes all
+ * dirty registers in one batch. Communication health is derived from the driver's
+ * interface transmission counter (IFCNT), which increments once per successful
+ * UART write: after a flush of N writes it must have advanced by exactly N. This
+ * costs a single register read instead of the full isSetupAndCommunicating() probe.
+ *
+ * The desired-value setters are lock-free and may be called from another task than
+ * the one that owns the UART and calls flush(); everything else belongs to the
+ * UART-owning task.
+ */
+
+#include <Arduino.h>
+#include <atomic>
+#include <TMC2209.h>
+#include "dbg_print.h"
+
+class TMC2209RegisterCache {
+private:
+    // Dirty flags, one per driver register
+    enum DirtyFlag : uint8_t {
+        DIRTY_GCONF      = 1 << 0, // StealthChop enable
+        DIRTY_PWMCONF    = 1 << 1, // Automatic current scaling / gradient adaptation
+        DIRTY_IHOLD_IRUN = 1 << 2, // Run current
+        DIRTY_CHOPCONF   = 1 << 3, // Microstep resolution
+        DIRTY_TOFF       = 1 << 4, // Driver enable (also CHOPCONF)
+        DIRTY_TCOOLTHRS  = 1 << 5, // CoolStep/StallGuard lower velocity threshold
+        DIRTY_SGTHRS     = 1 << 6, // StallGuard threshold
+        DIRTY_VACTUAL    = 1 << 7, // Internal step generator velocity
+        DIRTY_ALL        = 0xFF
+    };
+
+    TMC2209& driver;
+
+    // Write-only register shadows (written by any task, applied by the UART owner)
+    std::atomic<bool> stealthChopEnabled;
+    std::atomic<bool> automaticPwmEnabled;
+    std::atomic<uint32_t> runCurrent;
+    std::atomic<uint32_t> microstepsPerStep;
+    std::atomic<bool> driverEnabled;
+    std::atomic<uint32_t> coolStepDurationThreshold;
+    std::atomic<uint32_t> stallGuardThreshold;
+    std::atomic<int32_t> velocity;
+    std::atomic<uint32_t> dirty;
+
+    // Read-back register shadows
+    uint16_t stallGuardResult;
+    TMC2209::Status status;
+
+    // Communication health
+    bool communicating;
+    uint8_t lastTransmissionCounter;
+    uint32_t writeCount;
+    uint32_t communicationErrorCount;
+
+    // Last MRES confirmed by IFCNT and when it was written
+    uint16_t appliedMicrosteps;
+    uint32_t microstepsAppliedUs;
+
+    // Last VACTUAL confirmed by IFCNT
+    int32_t appliedVelocity;
+
+public:
+    explicit TMC2209RegisterCache(TMC2209& driver);
+
+    // Desired register values (RAM only until flush())
+    void setStealthChop(bool enabled);
+    void setAutomaticPwm(bool enabled);
+    void setRunCurrent(uint8_t percent);
+    void setMicrostepsPerStep(uint16_t microsteps);
+    void setEnabled(bool enabled);
+    void setCoolStepDurationThreshold(uint32_t threshold);
+    void setStallGuardThreshold(uint8_t threshold);
+    void setVelocity(int32_t vactual); // 0 hands the motor back to the STEP/DIR inputs
+    void markAllDirty(); // Rewrite everything on the next flush (e.g. after the driver lost power)
+    bool isDirty() const { return dirty.load() != 0; }
+
+    // Write all dirty registers in one batch and verify them via IFCNT. Returns false on communication failure.
+    bool flush();
+
+    // Cheap health check: a single IFCNT read that must match the last known value
+    bool verifyCommunication();
+
+    // Full communication probe; on recovery all registers are marked dirty for resynchronization
+    bool probe();
+
+    bool isCommunicating() const { return communicating; }
+
+    // Read-back registers (UART read, result is kept in the shadow)
+    uint16_t readStallGuardResult();
+    const TMC2209::Status& readStatus();
+
+    // Last read-back values without touching the UART
+    uint16_t getStallGuardResult() const { return stallGuardResult; }
+    const TMC2209::Status& getStatus() const { return status; }
+
+    // Shadow values
+    uint8_t getRunCurrent() const { return runCurrent; }
+    uint8_t getStallGuardThreshold() const { return stallGuardThreshold; }
+    uint16_t getMicrostepsPerStep() const { return microstepsPerStep; }
+    bool isEnabled() const { return driverEnabled; }
+    int32_t getVelocity() const { return velocity; }
+
+    // Statistics
+    uint32_t getWriteCount() const { return writeCount; }
+    uint32_t getCommunicationErrorCount() const { return communicationErrorCount; }
+
+    // Microstep resolution the driver acknowledged (0 = none yet) and micros() of its write
+    uint16_t getAppliedMicrosteps() const { return appliedMicrosteps; }
+    uint32_t getMicrostepsAppliedUs() const { return microstepsAppliedUs; }
+
+    // VACTUAL the driver acknowledged (0 = following STEP/DIR)
+    int32_t getAppliedVelocity() const { return appliedVelocity; }
+};
+
+#endif // TMC2209_REGISTER_CACHE_H
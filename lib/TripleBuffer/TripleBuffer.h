@@ -0,0 +1,55 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+/**
+ * @file TripleBuffer.h
+ * @brief Wait-free single-producer/single-consumer snapshot exchange
+ *
+ * The producer fills its private back buffer and publishes it by swapping it with
+ * the shared middle buffer; the consumer swaps the middle buffer with its private
+ * front buffer whenever a new snapshot is flagged. Neither side ever waits for the
+ * other, so a slow or preempted producer can never stall the consumer.
+ */
+
+#include <atomic>
+#include <stdint.h>
+
+template <typename T>
+class TripleBuffer {
+private:
+    static const uint32_t INDEX_MASK = 0x3;
+    static const uint32_t NEW_DATA_FLAG = 0x4;
+
+    T buffers[3];
+    std::atomic<uint32_t> middle; // Shared buffer index, NEW_DATA_FLAG set when unread
+    uint32_t back;                // Producer-owned buffer index
+    uint32_t front;               // Consumer-owned buffer index
+
+public:
+    TripleBuffer() : buffers(), middle(1), back(0), front(2) {}
+
+    // Producer side: fill writeBuffer() completely, then publish()
+    T& writeBuffer() { return buffers[back]; }
+
+    void publish() {
+        back = middle.exchange(back | NEW_DATA_FLAG, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    void publish(const T& value) {
+        buffers[back] = value;
+        publish();
+    }
+
+    // Consumer side: update() picks up the newest snapshot (returns false if nothing new), read() returns it
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & NEW_DATA_FLAG)) {
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T& read() const { return buffers[front]; }
+};
+
+#endif // TRIPLE_BUFFER_H
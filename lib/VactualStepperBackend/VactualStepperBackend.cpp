@@ -0,0 +1,214 @@
+#include "VactualStepperBackend.h"
+#include <math.h>
+
+// VACTUAL counts microsteps per 2^24 internal clock cycles
+static const double VACTUAL_STEPS_PER_SECOND = VACTUAL_CLOCK_HZ / 16777216.0;
+
+VactualStepperBackend::VactualStepperBackend(IDriverBackend& driver, IStepperBackend& stepDir)
+    : driver(driver), stepDir(stepDir), velocityMode(true),
+      speedHz(0), acceleration(0), appliedSpeedHz(0), appliedAcceleration(0), direction(0), running(false),
+      rampSpeed(0.0), speed(0.0), position(0.0), vactual(0), lastPositionUs(0), lastRampUs(0) {
+}
+
+bool VactualStepperBackend::begin() {
+    if (!stepDir.begin()) {
+        return false;
+    }
+
+    // The driver moves the motor without step pulses, so its outputs must stay enabled
+    stepDir.setAutoEnable(false);
+
+    lastPositionUs = micros();
+    lastRampUs = lastPositionUs;
+    return true;
+}
+
+void VactualStepperBackend::setSpeedInHz(uint32_t stepsPerSecond) {
+    speedHz = stepsPerSecond;
+    stepDir.setSpeedInHz(stepsPerSecond);
+}
+
+void VactualStepperBackend::setAcceleration(uint32_t stepsPerSecond2) {
+    acceleration = stepsPerSecond2;
+    stepDir.setAcceleration(stepsPerSecond2);
+}
+
+void VactualStepperBackend::applySpeedAcceleration() {
+    appliedSpeedHz = speedHz;
+    appliedAcceleration = acceleration;
+
+    if (!velocityMode) {
+        stepDir.applySpeedAcceleration();
+    } else if (running) {
+        updateVelocity(true);
+    }
+}
+
+void VactualStepperBackend::runForward() {
+    selectMode(); // Pending mode change at standstill
+    appliedSpeedHz = speedHz;
+    appliedAcceleration = acceleration;
+    direction = 1;
+    running = true;
+
+    if (velocityMode) updateVelocity(true); else stepDir.runForward();
+}
+
+void VactualStepperBackend::runBackward() {
+    selectMode();
+    appliedSpeedHz = speedHz;
+    appliedAcceleration = acceleration;
+    direction = -1;
+    running = true;
+
+    if (velocityMode) updateVelocity(true); else stepDir.runBackward();
+}
+
+void VactualStepperBackend::stopMove() {
+    appliedAcceleration = acceleration; // Decelerates with the latest acceleration, like FastAccelStepper
+    direction = 0;
+
+    if (velocityMode) updateVelocity(true); else stepDir.stopMove();
+}
+
+void VactualStepperBackend::forceStopAndNewPosition(int32_t newPosition) {
+    stepDir.forceStopAndNewPosition(newPosition);
+
+    direction = 0;
+    running = false;
+    rampSpeed = 0.0;
+    writeVelocity(0.0);
+    position = newPosition;
+    lastPositionUs = micros();
+}
+
+bool VactualStepperBackend::isRunning() {
+    return velocityMode ? running : stepDir.isRunning();
+}
+
+int32_t VactualStepperBackend::getCurrentPosition() {
+    if (!velocityMode) {
+        return stepDir.getCurrentPosition();
+    }
+    advancePosition();
+    return getWrappedPosition();
+}
+
+int32_t VactualStepperBackend::getCurrentSpeedInMilliHz() {
+    return velocityMode ? (int32_t)lround(speed * 1000.0) : stepDir.getCurrentSpeedInMilliHz();
+}
+
+uint32_t VactualStepperBackend::update() {
+    selectMode();
+
+    if (!velocityMode) {
+        return VACTUAL_FALLBACK_CHECK_INTERVAL;
+    }
+    if (!running) {
+        return STEPPER_BACKEND_IDLE_UPDATE;
+    }
+
+    updateVelocity(false);
+    const bool ramping = direction == 0 || rampSpeed != direction * (double)appliedSpeedHz;
+    return ramping ? VACTUAL_UPDATE_INTERVAL : VACTUAL_FALLBACK_CHECK_INTERVAL;
+}
+
+void VactualStepperBackend::selectMode() {
+    // Step sources only change at standstill: while VACTUAL is not 0 the driver ignores STEP
+    const bool communicating = driver.getDiagnostics().communicating;
+    if (velocityMode && !communicating && !running) {
+        handOverToStepDir();
+    } else if (!velocityMode && communicating && !stepDir.isRunning()) {
+        handOverToVelocity();
+    }
+}
+
+void VactualStepperBackend::advancePosition() {
+    const uint32_t now = micros();
+    position += speed * ((uint32_t)(now - lastPositionUs) / 1000000.0);
+    lastPositionUs = now;
+}
+
+void VactualStepperBackend::updateVelocity(bool command) {
+    const uint32_t now = micros();
+    const double interval = VACTUAL_UPDATE_INTERVAL / 1000.0;
+    double dt = (uint32_t)(now - lastRampUs) / 1000000.0;
+    lastRampUs = now;
+    if (dt > interval) {
+        dt = interval; // Idle time is no ramp time - start from one update step
+    }
+
+    const DriverDiagnostics& diagnostics = driver.getDiagnostics();
+    if (!diagnostics.communicating) {
+        // The driver keeps running the velocity it acknowledged last - continue the estimate and,
+        // once it answers again, the ramp from there
+        writeVelocity(VACTUAL_DIRECTION * diagnostics.appliedVelocity * VACTUAL_STEPS_PER_SECOND);
+        rampSpeed = speed;
+        if (direction == 0 && rampSpeed == 0.0) {
+            running = false;
+        }
+        return;
+    }
+
+    // Constant acceleration towards the target; a new setpoint reachable within one update
+    // interval is written at once (e.g. the step rate jump of a microstep resolution change)
+    const double target = direction * (double)appliedSpeedHz;
+    const double delta = target - rampSpeed;
+    const double reachable = appliedAcceleration * interval;
+    const double change = appliedAcceleration * ((command && fabs(delta) <= reachable) ? interval : dt);
+    if (appliedAcceleration == 0 || fabs(delta) <= change) {
+        rampSpeed = target;
+    } else {
+        rampSpeed += delta > 0.0 ? change : -change;
+    }
+
+    writeVelocity(rampSpeed);
+
+    // Stopped once the driver confirmed VACTUAL = 0, until then it may still be turning
+    if (direction == 0 && rampSpeed == 0.0 && diagnostics.appliedVelocity == 0) {
+        running = false;
+    }
+}
+
+void VactualStepperBackend::writeVelocity(double stepsPerSecond) {
+    const int32_t value = (int32_t)lround(stepsPerSecond / VACTUAL_STEPS_PER_SECOND);
+    if (value == vactual) {
+        return;
+    }
+
+    // The estimate integrates what the driver actually runs: the quantized velocity
+    advancePosition();
+    vactual = value;
+    speed = value * VACTUAL_STEPS_PER_SECOND;
+    driver.setVelocity(VACTUAL_DIRECTION * value);
+    driver.applyRegisters();
+}
+
+int32_t VactualStepperBackend::getWrappedPosition() const {
+    // Wrap like the 32-bit hardware position counter
+    return (int32_t)(uint32_t)(uint64_t)(int64_t)floor(position);
+}
+
+void VactualStepperBackend::handOverToStepDir() {
+    // At a confirmed standstill (VACTUAL = 0): the driver follows STEP/DIR from the estimated position
+    advancePosition();
+    stepDir.forceStopAndNewPosition(getWrappedPosition());
+    velocityMode = false;
+
+    dbg_println("VACTUAL: Driver not answering, step/dir takes over");
+}
+
+void VactualStepperBackend::handOverToVelocity() {
+    // At standstill: continue the unwrapped estimate from the step/dir position
+    const int32_t stepDirPosition = stepDir.getCurrentPosition();
+    position += (int32_t)((uint32_t)stepDirPosition - (uint32_t)getWrappedPosition());
+    position = floor(position);
+    lastPositionUs = micros();
+    lastRampUs = lastPositionUs;
+
+    direction = 0;
+    running = false;
+    velocityMode = true;
+
+    dbg_println("VACTUAL: Velocity mode resumed");
+}
@@ -0,0 +1,87 @@
+#ifndef VACTUAL_STEPPER_BACKEND_H
+#define VACTUAL_STEPPER_BACKEND_H
+
+/**
+ * @file VactualStepperBackend.h
+ * @brief IStepperBackend on the TMC2209's internal step generator (VACTUAL)
+ *
+ * For continuous rotation the driver can move the motor by itself at the velocity written
+ * to VACTUAL over UART, so no step pulses - and no step interrupt load - are needed. VACTUAL
+ * changes the velocity instantly, so this backend ramps it in software: update() moves the
+ * commanded velocity towards the target with the configured acceleration and writes it every
+ * VACTUAL_UPDATE_INTERVAL while the speed changes. The position is an estimate, integrated from
+ * the velocities actually written (VACTUAL resolution).
+ *
+ * VACTUAL can only be changed over UART, and while it is not 0 the driver ignores STEP. When the
+ * driver stops answering, the ramp therefore holds at the velocity the driver acknowledged last
+ * and the estimate keeps integrating it; a stop is only finished once the driver acknowledged
+ * VACTUAL = 0. From that standstill on the attached step/dir backend drives the motor until the
+ * driver answers again, and the velocity mode resumes at the next standstill after that.
+ */
+
+#include <Arduino.h>
+#include "IStepperBackend.h"
+#include "IDriverBackend.h"
+#include "dbg_print.h"
+
+#define VACTUAL_CLOCK_HZ 12000000       // Internal clock; VACTUAL counts microsteps per 2^24 clocks
+#define VACTUAL_UPDATE_INTERVAL 10      // Velocity ramp update interval while the speed changes (ms)
+#define VACTUAL_FALLBACK_CHECK_INTERVAL 100 // Constant speed / step/dir mode: how often to check the driver (ms)
+#define VACTUAL_DIRECTION 1             // +1 or -1: VACTUAL sign that turns the motor like runForward()
+
+class VactualStepperBackend : public IStepperBackend {
+private:
+    IDriverBackend& driver;
+    IStepperBackend& stepDir;
+
+    bool velocityMode;       // false: the step/dir backend drives the motor
+
+    // Configured values (like FastAccelStepper, applied on run*() / applySpeedAcceleration())
+    uint32_t speedHz;
+    uint32_t acceleration;
+    uint32_t appliedSpeedHz;
+    uint32_t appliedAcceleration;
+    int8_t direction;        // +1 forward, -1 backward, 0 stopping/stopped
+    bool running;
+
+    // Velocity ramp and position estimate (microsteps, steps/s)
+    double rampSpeed;        // Signed ramp velocity before VACTUAL quantization
+    double speed;            // Signed velocity of the last VACTUAL write
+    double position;         // Estimated, not wrapped, at lastPositionUs
+    int32_t vactual;         // Last value handed to the driver
+    uint32_t lastPositionUs;
+    uint32_t lastRampUs;
+
+    void selectMode();              // Velocity or step/dir (see class description)
+    void advancePosition();         // Integrate the commanded velocity up to micros()
+    void updateVelocity(bool command); // One ramp step (held without UART); command = called for a new setpoint
+    void writeVelocity(double stepsPerSecond);
+    int32_t getWrappedPosition() const;
+    void handOverToStepDir();
+    void handOverToVelocity();
+
+public:
+    VactualStepperBackend(IDriverBackend& driver, IStepperBackend& stepDir);
+
+    bool begin() override;
+
+    void setSpeedInHz(uint32_t stepsPerSecond) override;
+    void setAcceleration(uint32_t stepsPerSecond2) override;
+    void applySpeedAcceleration() override;
+
+    void runForward() override;
+    void runBackward() override;
+    void stopMove() override;
+    void forceStopAndNewPosition(int32_t newPosition) override;
+
+    bool isRunning() override;
+    int32_t getCurrentPosition() override;
+    int32_t getCurrentSpeedInMilliHz() override;
+
+    uint32_t update() override;
+    bool needsUpdate() const override { return true; }
+
+    bool isVelocityMode() const { return velocityMode; }
+};
+
+#endif // VACTUAL_STEPPER_BACKEND_H
@@ -1,6 +1,6 @@
 #include <ArduinoOTA.h>
 #include "../../secrets.h"
-#include "StepperController.h"
+#include "StepperTask.h"
 
 void setupOTA()
 {
@@ -24,11 +24,13 @@ void setupOTA()
         type = "filesystem";
       }
 
-      SystemCommand::getInstance().sendCommand(StepperCommand::DISABLE);
+      StepperCommandData disableAll(StepperCommand::DISABLE);
+      disableAll.axis = STEPPER_AXIS_ALL;
+      SystemCommand::getInstance().sendCommand(disableAll);
       bleManager.stop();
       powerDeliveryTask.stop();
       delay(100); // Allow time for stepper to stop
-      StepperController::getInstance().stop();
+      stepperTask.stop();
 
       // NOTE: if updating SPIFFS this would be the place to unmount SPIFFS using SPIFFS.end()
       Serial.println("Start updating " + type); })
@@ -0,0 +1,179 @@
+/**
+ * @file driver_io_bench.cpp
+ * @brief Host benchmark - motion loop latency with inline TMC2209 reads against DriverIOTask
+ *
+ * Built by the "driver_io_bench" PlatformIO environment. Runs on the virtual clock (HostKernel.h)
+ * with the UART timing model of host/include/TMC2209.h, so a read costs its bytes at 115200 baud
+ * plus whatever delay the bus model injects. Two motion loops with the stepper task's periodic
+ * jobs run side by side, each with its own driver:
+ *
+ *   inline   the loop before DriverIOTask: SG_RESULT every 100 ms, a register write with flush
+ *            every second, flush + IFCNT check (probe on failure) + DRV_STATUS every 2 s - all
+ *            over the UART from the motion loop itself
+ *   task     the loop now: the same jobs only set registers and read the DriverIOTask snapshot
+ *
+ * Both loops also run the 10 ms speed update; its start lateness is recorded by the scheduler's
+ * lateness histograms. The bus goes through three phases - healthy, BENCH_SLOW_REPLY_US injected
+ * before every reply, and a driver that does not answer at all - and per phase the worst and
+ * 99th percentile lateness of the speed update are printed for both loops (us). The task loop must
+ * stay within BENCH_TASK_LATENESS_BOUND_US in every phase, otherwise the program exits with status 1.
+ *
+ * Usage: program [seconds per phase]   (default 60)
+ */
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "DeadlineScheduler.h"
+#include "DriverIOTask.h"
+#include "TMC2209RegisterCache.h"
+
+#define BENCH_DEFAULT_PHASE_SECONDS 60
+#define BENCH_SLOW_REPLY_US 3000          // Injected per read in the "slow replies" phase
+#define BENCH_TASK_LATENESS_BOUND_US 1000 // Speed update start lateness of the task loop (one tick)
+#define BENCH_SPEED_INTERVAL 10           // Same periods as the stepper task
+#define BENCH_STALL_INTERVAL 100
+#define BENCH_REGISTER_INTERVAL 1000
+#define BENCH_STATUS_INTERVAL 2000
+
+struct BenchPhase {
+    const char* name;
+    uint32_t replyDelayUs;
+    bool answering;
+};
+
+static const BenchPhase phases[] = {
+    {"healthy", 0, true},
+    {"slow replies", BENCH_SLOW_REPLY_US, true},
+    {"not answering", 0, false},
+};
+
+// One motion loop; the jobs either talk to the driver (inline) or to DriverIOTask (task)
+struct MotionLoop {
+    const char* name;
+    bool inlineReads;
+    DeadlineScheduler scheduler;
+    int8_t speedJobId;
+    TMC2209 driver;                  // Inline loop only
+    TMC2209RegisterCache registers;  // Inline loop: its own cache, task loop: unused
+    uint8_t runCurrent;
+
+    MotionLoop(const char* name, bool inlineReads)
+        : name(name), inlineReads(inlineReads), speedJobId(DEADLINE_SCHEDULER_INVALID_JOB),
+          registers(driver), runCurrent(30) {}
+
+    TMC2209RegisterCache& getRegisters() {
+        return inlineReads ? registers : DriverIOTask::getInstance().getRegisters(0);
+    }
+};
+
+static void speedJob(void*) {
+    // Speed update itself takes no bus time - only its start lateness is of interest
+}
+
+static void stallJob(void* context) {
+    MotionLoop* loop = static_cast<MotionLoop*>(context);
+    if (loop->inlineReads) {
+        if (loop->registers.isCommunicating()) {
+            loop->registers.readStallGuardResult();
+        }
+    } else {
+        DriverIOTask::getInstance().getDiagnostics(0);
+    }
+}
+
+static void registerJob(void* context) {
+    // A run current change, like a stall recalibration or a load-dependent current step
+    MotionLoop* loop = static_cast<MotionLoop*>(context);
+    loop->runCurrent = loop->runCurrent == 30 ? 35 : 30;
+    loop->getRegisters().setRunCurrent(loop->runCurrent);
+    if (loop->inlineReads) {
+        loop->registers.flush();
+    } else {
+        DriverIOTask::getInstance().requestFlush();
+    }
+}
+
+static void statusJob(void* context) {
+    MotionLoop* loop = static_cast<MotionLoop*>(context);
+    if (loop->inlineReads) {
+        loop->registers.flush();
+        if (loop->registers.verifyCommunication() || loop->registers.probe()) {
+            loop->registers.readStatus();
+        }
+    } else {
+        DriverIOTask::getInstance().getDiagnostics(0);
+    }
+}
+
+static void motionLoopTask(void* parameter) {
+    MotionLoop* loop = static_cast<MotionLoop*>(parameter);
+    host::Kernel& kernel = host::Kernel::get();
+    while (true) {
+        loop->scheduler.runDueJobs();
+        // FreeRTOS ends a timeout on a tick interrupt, vTaskDelay() on the host counts it from now
+        kernel.sleepUntil((kernel.nowUs() / 1000 + loop->scheduler.ticksUntilNextDue()) * 1000);
+    }
+}
+
+static bool startMotionLoop(MotionLoop& loop) {
+    loop.scheduler.enableHistograms();
+    loop.speedJobId = loop.scheduler.addJob("motor_speed", BENCH_SPEED_INTERVAL, speedJob, &loop, BENCH_SPEED_INTERVAL);
+    loop.scheduler.addJob("stall_status", BENCH_STALL_INTERVAL, stallJob, &loop, BENCH_STALL_INTERVAL);
+    loop.scheduler.addJob("registers", BENCH_REGISTER_INTERVAL, registerJob, &loop, BENCH_REGISTER_INTERVAL);
+    loop.scheduler.addJob("tmc_status", BENCH_STATUS_INTERVAL, statusJob, &loop, BENCH_STATUS_INTERVAL);
+    return xTaskCreate(motionLoopTask, loop.name, 4096, &loop, 3, nullptr) == pdPASS;
+}
+
+int main(int argc, char** argv) {
+    const uint32_t phaseSeconds = argc > 1 ? (uint32_t)atol(argv[1]) : BENCH_DEFAULT_PHASE_SECONDS;
+    int failures = 0;
+
+    host::Kernel::get().enableVirtualTime();
+
+    static HardwareSerial serial;
+    static MotionLoop inlineLoop("inline", true);
+    static MotionLoop taskLoop("task", false);
+
+    inlineLoop.driver.setup(serial, DRIVER_IO_BAUD_RATE, TMC2209::SERIAL_ADDRESS_0);
+    inlineLoop.registers.markAllDirty();
+    if (!inlineLoop.registers.probe() || !inlineLoop.registers.flush()) {
+        printf("Inline driver not communicating\n");
+        return 1;
+    }
+
+    DriverIOTask& driverIO = DriverIOTask::getInstance();
+    driverIO.begin(serial, -1, -1);
+    driverIO.attachDriver(0, TMC2209::SERIAL_ADDRESS_0);
+    if (!driverIO.start() || !startMotionLoop(inlineLoop) || !startMotionLoop(taskLoop)) {
+        printf("Failed to start tasks\n");
+        return 1;
+    }
+
+    printf("speed update start lateness (us), %u s per phase\n", (unsigned)phaseSeconds);
+    printf("phase           inline max   inline p99   task max   task p99\n");
+    for (const BenchPhase& phase : phases) {
+        TMC2209::bus().replyDelayUs = phase.replyDelayUs;
+        TMC2209::bus().answering = phase.answering;
+        inlineLoop.scheduler.resetStats();
+        taskLoop.scheduler.resetStats();
+
+        delay(phaseSeconds * 1000UL);
+
+        const LatencyHistogram& inlineLateness = inlineLoop.scheduler.getHistograms(inlineLoop.speedJobId)->lateness;
+        const LatencyHistogram& taskLateness = taskLoop.scheduler.getHistograms(taskLoop.speedJobId)->lateness;
+        printf("%-14s  %10u   %10u   %8u   %8u\n", phase.name,
+               (unsigned)inlineLateness.getMax(), (unsigned)inlineLateness.valueAtPercentile(99.0f),
+               (unsigned)taskLateness.getMax(), (unsigned)taskLateness.valueAtPercentile(99.0f));
+
+        if (taskLateness.getMax() > BENCH_TASK_LATENESS_BOUND_US) {
+            printf("CHECK FAILED: task loop %s: speed update %u us late (at most %u us expected)\n",
+                   phase.name, (unsigned)taskLateness.getMax(), (unsigned)BENCH_TASK_LATENESS_BOUND_US);
+            failures++;
+        }
+    }
+
+    printf("%s (%d failed checks)\n", failures == 0 ? "PASS" : "FAIL", failures);
+    fflush(stdout);
+    _Exit(failures == 0 ? 0 : 1); // Task fibers never return
+}
@@ -1,5 +1,5 @@
 #include <Arduino.h>
-#include "StepperController.h"
+#include "StepperTask.h"
 #include "BLEManager.h"
 #include "SystemStatus.h"
 #include "SystemCommand.h"
@@ -7,7 +7,7 @@
 #include "dbg_print.h"
 
 // Global task objects
-StepperController& stepperController = StepperController::getInstance();
+StepperTask& stepperTask = StepperTask::getInstance();
 BLEManager& bleManager = BLEManager::getInstance();
 PowerDeliveryTask& powerDeliveryTask = PowerDeliveryTask::getInstance();
 
@@ -70,7 +70,7 @@ void setup() {
         }
     }
     
-    if (!stepperController.start()) {
+    if (!stepperTask.start()) {
         dbg_println("Failed to start Stepper Task!");
         while (1) {
             digitalWrite(STATUS_LED_PIN, !digitalRead(STATUS_LED_PIN));
@@ -0,0 +1,432 @@
+/**
+ * @file native_main.cpp
+ * @brief Host entry point - runs the firmware tasks on the simulated backends
+ *
+ * Built by the "native" PlatformIO environment. Starts the power delivery and stepper
+ * tasks, replays a scripted cook through SystemCommand (exactly like BLEManager would)
+ * and prints what the tasks publish, so control loop changes can be tried without the
+ * rotisserie.
+ *
+ * The script covers a whole cook: spin-up with speed variation auto-tune and a StallGuard
+ * calibration (repeated after the slow-down, as SG_RESULT scales with speed), a run current
+ * drop that stalls the motor, a power-good dropout, a client reconnect (full status
+ * request) and the final stop. Events are placed at fractions of the run length.
+ * The emergency stop during a command flood is checked: the motor must be off and stay off
+ * until the resume, whatever was queued before the stop. In virtual time the run must also
+ * stay within NATIVE_VIRTUAL_BUDGET_MS_PER_HOUR of host time per hour of firmware time (1 s for
+ * the 12 h cook at -O2), so a slower control loop shows up here. A failed check makes the
+ * program exit with status 1.
+ *
+ * Usage: program [seconds] [--virtual]
+ *   default 30 s in real time; with --virtual the tasks run on the discrete-event clock
+ *   (default 12 h) and the run finishes as fast as the host allows.
+ */
+
+#include <Arduino.h>
+#include <chrono>
+#include "StepperTask.h"
+#include "PowerDeliveryTask.h"
+#include "SystemStatus.h"
+#include "SystemCommand.h"
+
+#define NATIVE_POLL_INTERVAL 100                // ms between status polls
+#define NATIVE_TELEMETRY_INTERVAL_REAL 1000     // ms between telemetry lines in real time
+#define NATIVE_TELEMETRY_INTERVAL_VIRTUAL 600000 // ms between telemetry lines in virtual time (10 min)
+#define NATIVE_VIRTUAL_BUDGET_MS_PER_HOUR 83     // Host time allowed per hour of firmware time in virtual time
+#define NATIVE_AUTO_TUNE_REVOLUTIONS 10         // Auto-tune must flatten the load and settle within this many revolutions
+
+enum class ScenarioAction {
+    START,
+    CALIBRATE_STALLGUARD,
+    CURRENT_LOW,
+    CURRENT_NORMAL,
+    POWER_LOST,
+    POWER_RESTORED,
+    RECONNECT,
+    SLOW_DOWN,
+    FLOOD_AND_EMERGENCY_STOP,
+    RESUME,
+    LATENCY_DUMP,
+    STOP
+};
+
+struct ScenarioEvent {
+    float at; // Fraction of the run
+    ScenarioAction action;
+    const char *description;
+};
+
+static const ScenarioEvent scenario[] = {
+    {0.0f, ScenarioAction::START, "start 5 RPM with S-curve ramps, speed variation with auto-tune"},
+    {0.0f, ScenarioAction::CALIBRATE_STALLGUARD, "StallGuard threshold calibration at 5 RPM (SG_RESULT scales with speed)"},
+    {0.15f, ScenarioAction::CURRENT_LOW, "run current 10% (overload)"},
+    {0.17f, ScenarioAction::CURRENT_NORMAL, "run current 30%"},
+    {0.35f, ScenarioAction::POWER_LOST, "power good lost"},
+    {0.36f, ScenarioAction::POWER_RESTORED, "power good restored"},
+    {0.5f, ScenarioAction::RECONNECT, "client reconnect (full status request)"},
+    {0.7f, ScenarioAction::SLOW_DOWN, "slow down to 3 RPM (client sequence number 1, acknowledged)"},
+    {0.7f, ScenarioAction::CALIBRATE_STALLGUARD, "StallGuard threshold calibration at 3 RPM"},
+    {0.85f, ScenarioAction::FLOOD_AND_EMERGENCY_STOP, "command flood (speed slider, enable, direction) fills the queue, then emergency stop"},
+    {0.87f, ScenarioAction::RESUME, "resume with a preset (one transaction: speed, acceleration, variation, enable)"},
+    {0.95f, ScenarioAction::LATENCY_DUMP, "latency histogram dump"},
+    {0.98f, ScenarioAction::STOP, "stop"},
+};
+
+// Scenario checks: a failed check is printed and makes the program exit with status 1
+static int checkFailures = 0;
+
+static void check(bool ok, const char *what) {
+    if (!ok) {
+        checkFailures++;
+        printf("CHECK FAILED: %s\n", what);
+    }
+}
+
+// Emergency stop phase (flood until resume): the motor must go off and stay off
+enum class StopPhase {
+    NONE,
+    STOP_SENT,
+    DISABLED,
+    DONE
+};
+static StopPhase stopPhase = StopPhase::NONE;
+static bool restartedAfterStop = false;
+
+// Auto-tune from the start until the overload (axis 0, in output revolutions since the start):
+// the load ripple must drop below AUTO_TUNE_RIPPLE_TOLERANCE and the strength must stop changing
+static bool autoTuneTracking = false;
+static float autoTuneStartRevolutions = 0.0f;
+static float autoTuneFlatRevolutions = -1.0f;      // First ripple report below the tolerance
+static float autoTuneLastChangeRevolutions = 0.0f; // Last strength change
+static float autoTuneWindowRevolutions = 0.0f;     // Revolutions tracked in total
+
+static float getRevolutions() {
+    // getTelemetry() only answers with a fresh snapshot - keep the last one between updates
+    static float revolutions = 0.0f;
+    StepperTelemetry telemetry;
+    if (SystemStatus::getInstance().getTelemetry(0, telemetry)) {
+        revolutions = telemetry.totalRevolutions;
+    }
+    return revolutions;
+}
+
+// Client reconnect: every fitted axis must answer the full status request
+static bool reconnectPending = false;
+static uint32_t reconnectAxesReported = 0; // Bit per axis that sent its setpoint after the request
+
+static void runScenarioAction(ScenarioAction action) {
+    SystemCommand &systemCommand = SystemCommand::getInstance();
+    reconnectPending = false; // Later setpoint changes are not answers to the reconnect
+
+    switch (action) {
+    case ScenarioAction::START:
+        autoTuneTracking = true;
+        autoTuneStartRevolutions = getRevolutions();
+        systemCommand.sendCommand(StepperCommand::SET_SPEED, 5.0f);
+        systemCommand.sendCommand(StepperCommandData(StepperCommand::SET_JERK_LIMIT, static_cast<uint32_t>(100000)));
+        systemCommand.sendCommand(StepperCommand::ENABLE);
+        systemCommand.sendCommand(StepperCommand::ENABLE_SPEED_VARIATION);
+        systemCommand.sendCommand(StepperCommand::SET_SPEED_VARIATION_AUTO_TUNE, true);
+        break;
+    case ScenarioAction::CALIBRATE_STALLGUARD:
+        systemCommand.sendCommand(StepperCommand::CALIBRATE_STALLGUARD, 3);
+        break;
+    case ScenarioAction::CURRENT_LOW:
+        autoTuneTracking = false;
+        autoTuneWindowRevolutions = getRevolutions() - autoTuneStartRevolutions;
+        systemCommand.sendCommand(StepperCommand::SET_CURRENT, 10);
+        break;
+    case ScenarioAction::CURRENT_NORMAL:
+        systemCommand.sendCommand(StepperCommand::SET_CURRENT, 30);
+        break;
+    case ScenarioAction::POWER_LOST:
+        digitalWrite(PG_PIN, HIGH); // PG is active low
+        break;
+    case ScenarioAction::POWER_RESTORED:
+        digitalWrite(PG_PIN, LOW);
+        break;
+    case ScenarioAction::RECONNECT: {
+        // Same requests as BLEManager::sendAllCurrentStatus()
+        StepperCommandData statusRequest(StepperCommand::REQUEST_ALL_STATUS);
+        statusRequest.axis = STEPPER_AXIS_ALL;
+        reconnectPending = systemCommand.sendCommand(statusRequest);
+        systemCommand.sendPowerDeliveryCommand(PowerDeliveryCommand::REQUEST_ALL_STATUS);
+        break;
+    }
+    case ScenarioAction::SLOW_DOWN: {
+        StepperCommandData slowDown(StepperCommand::SET_SPEED, 3.0f);
+        slowDown.trace.seq = 1;
+        systemCommand.sendCommand(slowDown);
+        break;
+    }
+    case ScenarioAction::FLOOD_AND_EMERGENCY_STOP: {
+        // More commands than the queue holds, without waiting - the stop must still get through at once.
+        // The speed values coalesce into one queue entry; the ordered enables and direction changes
+        // (both start a stopped motor) fill the queue and must all be discarded once the stop is taken.
+        int queued = 0;
+        for (int i = 0; i < 2 * COMMAND_QUEUE_SIZE; i++) {
+            queued += systemCommand.sendCommand(StepperCommand::SET_SPEED, 3.0f + 0.01f * (i % 10), (TickType_t)0) ? 1 : 0;
+            queued += systemCommand.sendCommand(StepperCommandData(StepperCommand::ENABLE), 0) ? 1 : 0;
+            queued += systemCommand.sendCommand(StepperCommand::SET_DIRECTION, (i % 2) == 0, (TickType_t)0) ? 1 : 0;
+        }
+        printf("    %d commands accepted, %u pending\n", queued, (unsigned)systemCommand.getPendingCommandCount());
+        systemCommand.emergencyStop();
+        stopPhase = StopPhase::STOP_SENT;
+        break;
+    }
+    case ScenarioAction::RESUME: {
+        check(stopPhase == StopPhase::DISABLED, "emergency stop disabled the motor before the resume");
+        check(!restartedAfterStop, "no command queued before the emergency stop re-enabled the motor");
+        stopPhase = StopPhase::DONE;
+        StepperTransaction preset = {};
+        preset.fields = TRANSACTION_SPEED | TRANSACTION_ACCELERATION | TRANSACTION_VARIATION_STRENGTH |
+                        TRANSACTION_VARIATION_PHASE | TRANSACTION_ENABLE;
+        preset.speed = 3.0f;
+        preset.acceleration = 2000;
+        preset.variationStrength = 0.4f;
+        preset.variationPhase = 1.0f;
+        preset.enable = true;
+        systemCommand.sendTransaction(preset);
+        break;
+    }
+    case ScenarioAction::LATENCY_DUMP:
+        systemCommand.sendCommand(StepperCommand::REQUEST_LATENCY_HISTOGRAMS);
+        break;
+    case ScenarioAction::STOP:
+        systemCommand.sendCommand(StepperCommand::DISABLE);
+        break;
+    }
+}
+
+static void printTime() {
+    const unsigned long seconds = millis() / 1000;
+    printf("[%02lu:%02lu:%02lu.%03lu] ", seconds / 3600, (seconds / 60) % 60, seconds % 60, millis() % 1000);
+}
+
+static void printStatusUpdate(const StatusUpdateData &status) {
+    switch (status.type) {
+    case StatusUpdateType::SPEED_SETPOINT_CHANGED:
+        printTime();
+        printf("axis %u setpoint %.2f RPM\n", status.axis, status.floatValue);
+        break;
+    case StatusUpdateType::ENABLED_CHANGED:
+        printTime();
+        printf("axis %u %s\n", status.axis, status.boolValue ? "enabled" : "disabled");
+        break;
+    case StatusUpdateType::CURRENT_CHANGED:
+        printTime();
+        printf("axis %u run current %d%%\n", status.axis, status.intValue);
+        break;
+    case StatusUpdateType::SPEED_VARIATION_STRENGTH_CHANGED:
+        printTime();
+        printf("axis %u speed variation strength %.3f\n", status.axis, status.floatValue);
+        break;
+    case StatusUpdateType::SPEED_VARIATION_PHASE_CHANGED:
+        printTime();
+        printf("axis %u speed variation phase %.3f rad\n", status.axis, status.floatValue);
+        break;
+    case StatusUpdateType::COMMANDS_COALESCED:
+        printTime();
+        printf("%u setpoint commands coalesced\n", status.uint32Value);
+        break;
+    case StatusUpdateType::COMMANDS_DROPPED:
+        printTime();
+        printf("%u commands dropped (queue full)\n", status.uint32Value);
+        break;
+    case StatusUpdateType::STALL_COUNT_UPDATE:
+        static int lastStallCount = 0;
+        if (status.intValue != lastStallCount) {
+            lastStallCount = status.intValue;
+            printTime();
+            printf("axis %u stall count %d\n", status.axis, status.intValue);
+        }
+        break;
+    case StatusUpdateType::STALLGUARD_THRESHOLD_CHANGED:
+        printTime();
+        printf("axis %u StallGuard threshold %d\n", status.axis, status.intValue);
+        break;
+    case StatusUpdateType::MICROSTEPS_CHANGED:
+        printTime();
+        printf("axis %u microsteps %d\n", status.axis, status.intValue);
+        break;
+    case StatusUpdateType::PD_POWER_GOOD_STATUS:
+        static int lastPowerGood = -1;
+        if (status.boolValue != lastPowerGood) {
+            lastPowerGood = status.boolValue;
+            printTime();
+            printf("power good %s\n", status.boolValue ? "yes" : "no");
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+int main(int argc, char **argv) {
+    bool virtualTime = false;
+    unsigned long durationSeconds = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--virtual") == 0) {
+            virtualTime = true;
+        } else {
+            durationSeconds = strtoul(argv[i], nullptr, 10);
+        }
+    }
+    if (durationSeconds == 0) {
+        durationSeconds = virtualTime ? 12 * 3600 : 30;
+    }
+    const unsigned long durationMs = durationSeconds * 1000UL;
+    const unsigned long telemetryInterval = virtualTime ? NATIVE_TELEMETRY_INTERVAL_VIRTUAL : NATIVE_TELEMETRY_INTERVAL_REAL;
+
+    if (virtualTime) {
+        host::Kernel::get().enableVirtualTime();
+    }
+    const auto wallStart = std::chrono::steady_clock::now();
+
+    SystemStatus &systemStatus = SystemStatus::getInstance();
+    SystemCommand &systemCommand = SystemCommand::getInstance();
+    if (!systemStatus.begin() || !systemCommand.begin()) {
+        fprintf(stderr, "Failed to initialize system queues\n");
+        return 1;
+    }
+
+    if (!PowerDeliveryTask::getInstance().start() || !StepperTask::getInstance().start()) {
+        fprintf(stderr, "Failed to start tasks\n");
+        return 1;
+    }
+
+    size_t nextEvent = 0;
+    unsigned long lastTelemetryPrint = 0;
+    unsigned long statusUpdates = 0;
+    StatusBlockData motionTiming(StatusBlockType::MOTION_TIMING); // Latest motion core timing window
+    StatusBlockData commandLatency(StatusBlockType::COMMAND_LATENCY); // Latest command stage latencies
+    while (millis() < durationMs) {
+        while (nextEvent < sizeof(scenario) / sizeof(scenario[0]) && millis() >= scenario[nextEvent].at * durationMs) {
+            printTime();
+            printf("--- %s\n", scenario[nextEvent].description);
+            runScenarioAction(scenario[nextEvent].action);
+            nextEvent++;
+        }
+
+        NotificationData notification;
+        while (systemStatus.getNotification(notification)) {
+            printTime();
+            printf("%s: %s\n", notification.type == NotificationType::ERROR ? "ERROR" : "WARNING", notification.message);
+        }
+
+        StatusUpdateData status;
+        while (systemStatus.getStatusUpdate(status)) {
+            statusUpdates++;
+            printStatusUpdate(status);
+            if (autoTuneTracking && status.axis == 0) {
+                const float revolutions = getRevolutions() - autoTuneStartRevolutions;
+                if (status.type == StatusUpdateType::LOAD_RIPPLE_UPDATE && status.floatValue < AUTO_TUNE_RIPPLE_TOLERANCE &&
+                    autoTuneFlatRevolutions < 0.0f) {
+                    autoTuneFlatRevolutions = revolutions;
+                } else if (status.type == StatusUpdateType::SPEED_VARIATION_STRENGTH_CHANGED) {
+                    autoTuneLastChangeRevolutions = revolutions;
+                }
+            }
+            if (reconnectPending && status.type == StatusUpdateType::SPEED_SETPOINT_CHANGED) {
+                reconnectAxesReported |= 1u << status.axis;
+            }
+            if (status.type == StatusUpdateType::ENABLED_CHANGED && stopPhase != StopPhase::NONE && stopPhase != StopPhase::DONE) {
+                if (!status.boolValue) {
+                    stopPhase = StopPhase::DISABLED;
+                } else if (stopPhase == StopPhase::DISABLED) {
+                    restartedAfterStop = true;
+                }
+            }
+        }
+
+        CommandAckData ack;
+        while (systemStatus.getCommandAck(ack)) {
+            static const char *const results[] = {"ok", "adjusted", "rejected", "queue full", "unavailable"};
+            printTime();
+            printf("ack seq %u axis %u: %s", ack.seq, ack.axis, results[static_cast<uint8_t>(ack.result)]);
+            if (ack.hasValue) {
+                printf(", value %.2f", ack.value);
+            }
+            printf("\n");
+        }
+
+        StatusBlockData block;
+        while (systemStatus.getStatusBlock(block)) {
+            if (block.type == StatusBlockType::MOTION_TIMING) {
+                motionTiming = block;
+            } else if (block.type == StatusBlockType::COMMAND_LATENCY) {
+                commandLatency = block;
+            } else if (block.type == StatusBlockType::COMMAND_TRACE && block.count >= 6) {
+                printTime();
+                printf("command %u (type %d) applied: queue %d us, apply %d us, total %d us\n", block.info,
+                       block.values[0], block.values[3], block.values[4], block.values[5]);
+            } else if (block.type == StatusBlockType::TRANSACTION && block.count >= 9) {
+                printTime();
+                printf("axis %u transaction %u %s: %.2f RPM, %d steps/s^2, variation %s %.2f at %.2f rad, %s\n",
+                       block.axis, block.info, block.values[0] ? "applied" : "rejected", block.values[1] / 1000.0f,
+                       block.values[2], block.values[5] ? "on" : "off", block.values[3] / 1000.0f,
+                       block.values[4] / 1000.0f, block.values[7] ? "enabled" : "disabled");
+            } else if (block.type == StatusBlockType::LATENCY_HISTOGRAM && block.count >= 8) {
+                static const char *const kinds[] = {"lateness", "execution", "queue wait"};
+                printTime();
+                printf("axis %u %s %s: %d runs, p50 %d / p99 %d / p99.9 %d / max %d us\n", block.axis,
+                       block.label ? block.label : "?", block.info < 3 ? kinds[block.info] : "?", block.values[0],
+                       block.values[3], block.values[5], block.values[6], block.values[7]);
+            }
+        }
+
+        if (millis() - lastTelemetryPrint >= telemetryInterval) {
+            lastTelemetryPrint = millis();
+            for (uint8_t axis = 0; axis < STEPPER_AXIS_COUNT; axis++) {
+                StepperTelemetry telemetry;
+                if (systemStatus.getTelemetry(axis, telemetry)) {
+                    if (stopPhase == StopPhase::DISABLED) {
+                        check(telemetry.stepRate == 0, "motor stands still between emergency stop and resume");
+                    }
+                    printTime();
+                    printf("axis %u %.2f RPM, %.2f rev, SG %d, %u steps/s at 1/%u\n", axis,
+                           telemetry.currentSpeed, telemetry.totalRevolutions, telemetry.stallGuardResult,
+                           telemetry.stepRate, telemetry.microsteps);
+                }
+            }
+            if (motionTiming.count >= 11) {
+                printTime();
+                printf("motion loop: wake jitter %d/%d us, busy max %d us, %d commands in %u ms, latency %d/%d us\n",
+                       motionTiming.values[5], motionTiming.values[6], motionTiming.values[7], motionTiming.values[8],
+                       motionTiming.info, motionTiming.values[9], motionTiming.values[10]);
+            }
+            if (commandLatency.count >= 25) {
+                // Stage order parse, handoff, queue, apply, total - 5 values each (count, p50, p99, p99.9, max)
+                printTime();
+                printf("commands: %u traced, queue p99 %d / max %d us, apply p99 %d / max %d us, total p99 %d / max %d us\n",
+                       commandLatency.info, commandLatency.values[12], commandLatency.values[14], commandLatency.values[17],
+                       commandLatency.values[19], commandLatency.values[22], commandLatency.values[24]);
+            }
+        }
+
+        delay(NATIVE_POLL_INTERVAL);
+    }
+
+    const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    printf("%lu s of firmware time in %.2f s (%s time), %lu status updates\n",
+           durationSeconds, wallSeconds, virtualTime ? "virtual" : "real", statusUpdates);
+    check(stopPhase == StopPhase::DONE, "emergency stop scenario ran");
+    check(reconnectAxesReported == (1u << STEPPER_AXIS_COUNT) - 1, "reconnect status request answered by every axis");
+    if (autoTuneWindowRevolutions >= NATIVE_AUTO_TUNE_REVOLUTIONS) {
+        // Needs the long run - 30 s in real time is not even one revolution at 5 RPM
+        printf("auto-tune: ripple below %.3f after %.1f rev, strength last changed after %.1f of %.1f rev\n",
+               AUTO_TUNE_RIPPLE_TOLERANCE, autoTuneFlatRevolutions, autoTuneLastChangeRevolutions, autoTuneWindowRevolutions);
+        check(autoTuneFlatRevolutions >= 0.0f && autoTuneFlatRevolutions <= NATIVE_AUTO_TUNE_REVOLUTIONS,
+              "auto-tune flattens the load ripple within NATIVE_AUTO_TUNE_REVOLUTIONS");
+        check(autoTuneLastChangeRevolutions <= NATIVE_AUTO_TUNE_REVOLUTIONS,
+              "auto-tune strength settles within NATIVE_AUTO_TUNE_REVOLUTIONS");
+    }
+    if (virtualTime) {
+        const double budgetSeconds = durationSeconds / 3600.0 * NATIVE_VIRTUAL_BUDGET_MS_PER_HOUR / 1000.0;
+        printf("virtual time budget %.2f s\n", budgetSeconds);
+        check(wallSeconds <= budgetSeconds, "virtual time run within its host time budget");
+    }
+    printf("%s (%d failed checks)\n", checkFailures == 0 ? "PASS" : "FAIL", checkFailures);
+    fflush(stdout);
+    _Exit(checkFailures == 0 ? 0 : 1); // Task threads never return
+}
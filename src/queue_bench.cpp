@@ -0,0 +1,315 @@
+/**
+ * @file queue_bench.cpp
+ * @brief Benchmark - SpscRing against a FreeRTOS queue on the real command and status payloads
+ *
+ * Built by the "queue_bench" (host) and "queue_bench_esp32" (target) PlatformIO environments.
+ * Two measurements per payload (StepperCommandData, StatusUpdateData):
+ *
+ *   push+pop   one task fills and drains the channel in bursts of COMMAND_RING_SIZE / 2 -
+ *              the bare cost of one item without any wakeup (ns per item)
+ *   handoff    ping-pong between two tasks over a pair of channels; the echo task sleeps in
+ *              ulTaskNotifyTake() (ring) or xQueueReceive() (queue) - half a round trip (us)
+ *
+ * On the target the echo task runs once on the benchmark's core and once on the other core.
+ * On the host the queue is the shim in host/include (one kernel mutex), so the numbers show
+ * the ring's code path and not FreeRTOS; only the target numbers compare against xQueue.
+ *
+ * Then the emergency stop fast lane of SystemCommand is checked under a command flood: a sender
+ * task fills the FIFO with enable and direction commands and sends the stop, while a consumer
+ * of lower priority on the same core (the motion task's place) waits in getCommand(). The stop
+ * must come out first, none of the flooded commands may come out after it, and it must be
+ * dequeued within BENCH_STOP_LATENCY_BOUND_US of emergencyStop(). On the host there are no
+ * priorities, so the consumer may take flooded commands before the stop and the latency is only
+ * reported. A failed check prints FAIL and makes the host program exit with status 1.
+ *
+ * Usage: program [round trips]   (default 10000; the target uses the default)
+ */
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "SpscRing.h"
+#include "SystemCommand.h"
+#include "StatusTypes.h"
+
+#ifdef ARDUINO
+#define bench_printf(...) Serial.printf(__VA_ARGS__)
+#else
+#define bench_printf(...) printf(__VA_ARGS__)
+#endif
+
+#define BENCH_RING_SIZE COMMAND_RING_SIZE
+#define BENCH_BURST (BENCH_RING_SIZE / 2)
+#define BENCH_PUSH_POP_ITEMS 200000
+#define BENCH_DEFAULT_ROUND_TRIPS 10000
+#define BENCH_ECHO_STACK 4096
+#define BENCH_ECHO_PRIORITY 5
+#define BENCH_STOP_ROUNDS 200
+#define BENCH_STOP_LATENCY_BOUND_US 200 // Stop sent -> dequeued by the motion task, well inside one tick
+
+// Ping-pong pair: request is consumed by the echo task, reply by the benchmark task
+template <typename T>
+struct RingPair {
+    SpscRing<T, BENCH_RING_SIZE> request;
+    SpscRing<T, BENCH_RING_SIZE> reply;
+    uint32_t roundTrips;
+    TaskHandle_t done;
+};
+
+template <typename T>
+struct QueuePair {
+    QueueHandle_t request;
+    QueueHandle_t reply;
+    uint32_t roundTrips;
+    TaskHandle_t done;
+};
+
+template <typename T>
+static void ringEcho(void* parameter) {
+    RingPair<T>* pair = static_cast<RingPair<T>*>(parameter);
+    pair->request.setConsumerTask(xTaskGetCurrentTaskHandle());
+    xTaskNotifyGive(pair->done); // Registered - the benchmark may start
+
+    T item;
+    for (uint32_t i = 0; i < pair->roundTrips; i++) {
+        pair->request.pop(item, portMAX_DELAY);
+        pair->reply.push(item);
+    }
+    vTaskDelete(nullptr);
+}
+
+template <typename T>
+static void queueEcho(void* parameter) {
+    QueuePair<T>* pair = static_cast<QueuePair<T>*>(parameter);
+    xTaskNotifyGive(pair->done);
+
+    T item;
+    for (uint32_t i = 0; i < pair->roundTrips; i++) {
+        xQueueReceive(pair->request, &item, portMAX_DELAY);
+        xQueueSend(pair->reply, &item, portMAX_DELAY);
+    }
+    vTaskDelete(nullptr);
+}
+
+template <typename T>
+static float ringPushPopNs(SpscRing<T, BENCH_RING_SIZE>& ring) {
+    T item;
+    const uint32_t start = micros();
+    for (uint32_t i = 0; i < BENCH_PUSH_POP_ITEMS; i += BENCH_BURST) {
+        for (uint32_t j = 0; j < BENCH_BURST; j++) {
+            ring.push(item);
+        }
+        for (uint32_t j = 0; j < BENCH_BURST; j++) {
+            ring.pop(item);
+        }
+    }
+    return (micros() - start) * 1000.0f / BENCH_PUSH_POP_ITEMS;
+}
+
+template <typename T>
+static float queuePushPopNs(QueueHandle_t queue) {
+    T item;
+    const uint32_t start = micros();
+    for (uint32_t i = 0; i < BENCH_PUSH_POP_ITEMS; i += BENCH_BURST) {
+        for (uint32_t j = 0; j < BENCH_BURST; j++) {
+            xQueueSend(queue, &item, 0);
+        }
+        for (uint32_t j = 0; j < BENCH_BURST; j++) {
+            xQueueReceive(queue, &item, 0);
+        }
+    }
+    return (micros() - start) * 1000.0f / BENCH_PUSH_POP_ITEMS;
+}
+
+template <typename T>
+static float ringHandoffUs(RingPair<T>& pair, uint32_t roundTrips, BaseType_t core) {
+    pair.roundTrips = roundTrips;
+    pair.done = xTaskGetCurrentTaskHandle();
+    pair.reply.setConsumerTask(pair.done);
+    ulTaskNotifyTake(pdTRUE, 0);
+    xTaskCreatePinnedToCore(ringEcho<T>, "ring_echo", BENCH_ECHO_STACK, &pair, BENCH_ECHO_PRIORITY, nullptr, core);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    T item;
+    const uint32_t start = micros();
+    for (uint32_t i = 0; i < roundTrips; i++) {
+        pair.request.push(item);
+        pair.reply.pop(item, portMAX_DELAY);
+    }
+    const uint32_t elapsed = micros() - start;
+
+    vTaskDelay(pdMS_TO_TICKS(10)); // Let the echo task return from its last push before it is forgotten
+    pair.request.setConsumerTask(nullptr);
+    pair.reply.setConsumerTask(nullptr);
+    return elapsed / (2.0f * roundTrips);
+}
+
+template <typename T>
+static float queueHandoffUs(QueuePair<T>& pair, uint32_t roundTrips, BaseType_t core) {
+    pair.roundTrips = roundTrips;
+    pair.done = xTaskGetCurrentTaskHandle();
+    ulTaskNotifyTake(pdTRUE, 0);
+    xTaskCreatePinnedToCore(queueEcho<T>, "queue_echo", BENCH_ECHO_STACK, &pair, BENCH_ECHO_PRIORITY, nullptr, core);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    T item;
+    const uint32_t start = micros();
+    for (uint32_t i = 0; i < roundTrips; i++) {
+        xQueueSend(pair.request, &item, portMAX_DELAY);
+        xQueueReceive(pair.reply, &item, portMAX_DELAY);
+    }
+    const uint32_t elapsed = micros() - start;
+
+    vTaskDelay(pdMS_TO_TICKS(10)); // Let the echo task return from its last send
+    return elapsed / (2.0f * roundTrips);
+}
+
+template <typename T>
+static void benchmark(const char* name, uint32_t roundTrips) {
+    static RingPair<T> ringPair;
+    QueuePair<T> queuePair;
+    queuePair.request = xQueueCreate(BENCH_RING_SIZE, sizeof(T));
+    queuePair.reply = xQueueCreate(BENCH_RING_SIZE, sizeof(T));
+
+    bench_printf("%s (%u bytes)\n", name, (unsigned)sizeof(T));
+    bench_printf("  push+pop   ring %7.0f ns   queue %7.0f ns\n",
+                 ringPushPopNs<T>(ringPair.request), queuePushPopNs<T>(queuePair.request));
+
+#ifdef ARDUINO
+    const BaseType_t ownCore = xPortGetCoreID();
+    const BaseType_t cores[] = {ownCore, (BaseType_t)(1 - ownCore)};
+    const char* coreNames[] = {"same core ", "other core"};
+    const int coreCount = 2;
+#else
+    const BaseType_t cores[] = {tskNO_AFFINITY};
+    const char* coreNames[] = {"threads   "};
+    const int coreCount = 1;
+#endif
+    for (int i = 0; i < coreCount; i++) {
+        const float ring = ringHandoffUs<T>(ringPair, roundTrips, cores[i]);
+        const float queue = queueHandoffUs<T>(queuePair, roundTrips, cores[i]);
+        bench_printf("  handoff    ring %7.2f us   queue %7.2f us   (%s, %u round trips)\n",
+                     ring, queue, coreNames[i], (unsigned)roundTrips);
+    }
+
+    vQueueDelete(queuePair.request);
+    vQueueDelete(queuePair.reply);
+}
+
+// Emergency stop under a full command FIFO (see the file description)
+struct StopBench {
+    BaseType_t core;
+    TaskHandle_t done;         // Benchmark task, notified when all rounds are through
+    TaskHandle_t sender;       // Notified by the consumer when it is ready and after every round
+    uint32_t maxLatencyUs;
+    uint64_t latencySumUs;
+    uint32_t stopNotFirst;     // Rounds in which a flooded command came out before the stop
+    uint32_t passedAfterStop;  // Flooded commands that came out after the stop (must never happen)
+};
+
+static void stopConsumer(void* parameter) {
+    StopBench* bench = static_cast<StopBench*>(parameter);
+    SystemCommand& systemCommand = SystemCommand::getInstance();
+    xTaskNotifyGive(bench->sender);
+
+    StepperCommandData command;
+    for (uint32_t round = 0; round < BENCH_STOP_ROUNDS; round++) {
+        bool first = true;
+        while (systemCommand.getCommand(command, portMAX_DELAY) && command.command != StepperCommand::EMERGENCY_STOP) {
+            first = false;
+        }
+        const uint32_t latency = micros() - command.trace.queuedUs;
+        bench->maxLatencyUs = max(bench->maxLatencyUs, latency);
+        bench->latencySumUs += latency;
+        if (!first) {
+            bench->stopNotFirst++;
+        }
+
+        // Everything still queued was sent before the stop and would start the motor again
+        while (systemCommand.getCommand(command, 0)) {
+            bench->passedAfterStop++;
+        }
+        xTaskNotifyGive(bench->sender);
+    }
+    vTaskDelete(nullptr);
+}
+
+static void stopSender(void* parameter) {
+    StopBench* bench = static_cast<StopBench*>(parameter);
+    SystemCommand& systemCommand = SystemCommand::getInstance();
+    bench->sender = xTaskGetCurrentTaskHandle();
+    xTaskCreatePinnedToCore(stopConsumer, "stop_consumer", BENCH_ECHO_STACK, bench, BENCH_ECHO_PRIORITY, nullptr, bench->core);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    for (uint32_t round = 0; round < BENCH_STOP_ROUNDS; round++) {
+        for (uint32_t i = 0; i < COMMAND_QUEUE_SIZE; i++) {
+            if (i % 2 == 0) {
+                systemCommand.sendCommand(StepperCommand::ENABLE, true, 0);
+            } else {
+                systemCommand.sendCommand(StepperCommand::SET_DIRECTION, (round + i) % 4 == 1, 0);
+            }
+        }
+        systemCommand.emergencyStop();
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // Blocks - the consumer runs from here
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(10)); // Let the consumer return from its last notification
+    xTaskNotifyGive(bench->done);
+    vTaskDelete(nullptr);
+}
+
+static bool emergencyStopCheck() {
+    static StopBench bench;
+    bench = StopBench();
+    bench.done = xTaskGetCurrentTaskHandle();
+#ifdef ARDUINO
+    bench.core = xPortGetCoreID();
+    const bool enforced = true;
+#else
+    bench.core = tskNO_AFFINITY;
+    const bool enforced = false;
+#endif
+    SystemCommand::getInstance().begin();
+
+    // The sender preempts the consumer on the same core, so the FIFO fills before the consumer runs
+    ulTaskNotifyTake(pdTRUE, 0);
+    xTaskCreatePinnedToCore(stopSender, "stop_sender", BENCH_ECHO_STACK, &bench, BENCH_ECHO_PRIORITY + 1, nullptr, bench.core);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    bench_printf("Emergency stop behind a full FIFO (%u commands, %u rounds)\n", (unsigned)COMMAND_QUEUE_SIZE, (unsigned)BENCH_STOP_ROUNDS);
+    bench_printf("  latency    mean %7.1f us   max %7u us   (bound %u us%s)\n",
+                 (double)bench.latencySumUs / BENCH_STOP_ROUNDS, (unsigned)bench.maxLatencyUs,
+                 (unsigned)BENCH_STOP_LATENCY_BOUND_US, enforced ? "" : ", not checked on the host");
+    bench_printf("  ordering   stop not first %u, flooded commands after the stop %u\n",
+                 (unsigned)bench.stopNotFirst, (unsigned)bench.passedAfterStop);
+
+    bool ok = bench.passedAfterStop == 0;
+    if (enforced) {
+        ok = ok && bench.stopNotFirst == 0 && bench.maxLatencyUs <= BENCH_STOP_LATENCY_BOUND_US;
+    }
+    bench_printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+static bool runBenchmarks(uint32_t roundTrips) {
+    benchmark<StepperCommandData>("StepperCommandData", roundTrips);
+    benchmark<StatusUpdateData>("StatusUpdateData", roundTrips);
+    return emergencyStopCheck();
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200);
+    delay(2000); // Give the USB CDC monitor time to attach
+    runBenchmarks(BENCH_DEFAULT_ROUND_TRIPS);
+}
+
+void loop() {
+    delay(1000);
+}
+#else
+int main(int argc, char** argv) {
+    return runBenchmarks(argc > 1 ? (uint32_t)atol(argv[1]) : BENCH_DEFAULT_ROUND_TRIPS) ? 0 : 1;
+}
+#endif
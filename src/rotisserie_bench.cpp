@@ -0,0 +1,119 @@
+/**
+ * @file rotisserie_bench.cpp
+ * @brief Host benchmark - sweeps speed variation profiles against the spit load model
+ *
+ * Built by the "rotisserie_bench" PlatformIO environment. Every strength/phase/acceleration/jerk
+ * combination is replayed for a full cook with RotisserieSimulation and reported as one CSV
+ * line (torques in mN·m at the motor shaft), followed by the profile with the lowest ripple and
+ * the peak torque of each S-curve jerk limit relative to constant-acceleration ramps. Profiles
+ * run at the controller's microstep speed band; a second sweep over setpoints compares the step
+ * interrupt rate of the speed bands against a fixed MICRO_STEPS resolution.
+ *
+ * Usage: program [hours] [setpoint RPM] [eccentric angle deg]   (defaults 8, 5, 0)
+ */
+
+#include <Arduino.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "RotisserieSimulation.h"
+
+static const float strengths[] = {0.0f, 0.25f, 0.5f, 0.75f, 1.0f};
+static const float phasesDeg[] = {0.0f, 90.0f, 180.0f, 270.0f};
+static const uint32_t accelerations[] = {1000, 3200, 10000, 32000};
+static const uint32_t jerks[] = {0, 1000000, 100000, 10000}; // steps/s³, 0 = constant acceleration (as SET_JERK_LIMIT)
+static const float stepRateSetpoints[] = {0.5f, 1.0f, 2.0f, 3.0f, 5.0f, 8.0f, 12.0f, 20.0f, 30.0f}; // RPM
+#define STEP_RATE_STRENGTH 0.5f
+#define STEP_RATE_DURATION 600.0 // s per setpoint
+
+int main(int argc, char** argv) {
+    const double hours = argc > 1 ? atof(argv[1]) : 8.0;
+    const float setpointRPM = argc > 2 ? (float)atof(argv[2]) : 5.0f;
+
+    RotisserieParameters parameters;
+    if (argc > 3) {
+        parameters.eccentricAngle = (float)(atof(argv[3]) * PI / 180.0);
+    }
+
+    std::vector<SpeedProfileCase> profiles;
+    for (float strength : strengths) {
+        for (float phaseDeg : phasesDeg) {
+            for (uint32_t acceleration : accelerations) {
+                for (uint32_t jerk : jerks) {
+                    profiles.push_back(SpeedProfileCase(setpointRPM, strength, (float)(phaseDeg * PI / 180.0), acceleration, jerk));
+                }
+                if (strength == 0.0f) {
+                    break; // Phase and acceleration do not matter at constant speed beyond the start
+                }
+            }
+            if (strength == 0.0f) {
+                break;
+            }
+        }
+    }
+
+    // Profiles are independent - spread them over the host cores
+    const RotisserieSimulation simulation(parameters);
+    std::vector<RotisserieStats> results(profiles.size());
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    const unsigned int threads = max(1u, std::thread::hardware_concurrency());
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int t = 0; t < threads; t++) {
+        workers.emplace_back([&] {
+            for (size_t i = next++; i < profiles.size(); i = next++) {
+                results[i] = simulation.run(profiles[i], hours * 3600.0);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("strength,phase_deg,acceleration,jerk,peak_mNm,ripple_mNm,mean_mNm,rms_mNm,min_stall_margin_pct,microsteps,mean_step_rate,peak_step_rate\n");
+    size_t best = 0;
+    for (size_t i = 0; i < profiles.size(); i++) {
+        const RotisserieStats& stats = results[i];
+        printf("%.2f,%.0f,%u,%u,%.2f,%.2f,%.2f,%.2f,%.1f,%u,%.0f,%.0f\n",
+               profiles[i].strength, profiles[i].phase * 180.0 / PI, profiles[i].acceleration, profiles[i].jerk,
+               stats.peakMotorTorque * 1000.0f, stats.torqueRipple * 1000.0f, stats.meanMotorTorque * 1000.0f,
+               stats.rmsMotorTorque * 1000.0f, stats.minStallMargin * 100.0f,
+               stats.microsteps, stats.meanStepRate, stats.peakStepRate);
+        if (stats.torqueRipple < results[best].torqueRipple) {
+            best = i;
+        }
+    }
+
+    fprintf(stderr, "%zu profiles x %.1f h simulated in %.2f s (%u threads)\n", profiles.size(), hours, wallSeconds, threads);
+    fprintf(stderr, "Lowest ripple: strength %.2f, phase %.0f deg, acceleration %u, jerk %u (%.2f mNm, stall margin %.1f%%)\n",
+            profiles[best].strength, profiles[best].phase * 180.0 / PI, profiles[best].acceleration, profiles[best].jerk,
+            results[best].torqueRipple * 1000.0f, results[best].minStallMargin * 100.0f);
+
+    // Each jerk limit against the constant-acceleration run of the same profile (jerks[0] = 0)
+    const size_t jerkCount = sizeof(jerks) / sizeof(jerks[0]);
+    for (size_t j = 1; j < jerkCount; j++) {
+        double reductionSum = 0.0;
+        double bestReduction = 0.0;
+        size_t count = 0;
+        for (size_t i = j; i < profiles.size(); i += jerkCount) {
+            const double reduction = 1.0 - results[i].peakMotorTorque / results[i - j].peakMotorTorque;
+            reductionSum += reduction;
+            bestReduction = max(bestReduction, reduction);
+            count++;
+        }
+        fprintf(stderr, "Jerk %u steps/s^3: peak torque %.1f%% lower on average, up to %.1f%%\n",
+                jerks[j], 100.0 * reductionSum / count, 100.0 * bestReduction);
+    }
+
+    // Step interrupt load: fixed MICRO_STEPS against the speed bands of dynamic microstepping
+    fprintf(stderr, "Step rate at strength %.2f (steps/s, mean/peak): fixed 1/%u vs speed band\n", STEP_RATE_STRENGTH, MICRO_STEPS);
+    for (float rpm : stepRateSetpoints) {
+        const RotisserieStats fixed = simulation.run(SpeedProfileCase(rpm, STEP_RATE_STRENGTH, 0.0f, 10000, 0, MICRO_STEPS), STEP_RATE_DURATION);
+        const RotisserieStats banded = simulation.run(SpeedProfileCase(rpm, STEP_RATE_STRENGTH, 0.0f, 10000, 0, 0), STEP_RATE_DURATION);
+        fprintf(stderr, "  %5.1f RPM: %6.0f/%6.0f  vs 1/%-2u %6.0f/%6.0f  (%+.0f%%)\n", rpm,
+                fixed.meanStepRate, fixed.peakStepRate, banded.microsteps, banded.meanStepRate, banded.peakStepRate,
+                100.0 * (banded.meanStepRate / fixed.meanStepRate - 1.0));
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file speed_table_bench.cpp
+ * @brief Host benchmark - speed variation lookup: closed-form path against the speed table
+ *
+ * Built by the "speed_table_bench" PlatformIO environment. Compares the two ways of getting
+ * the variable speed for a shaft position:
+ *
+ *   formula   position -> angle, then fmodf + cosf + divide in calculateVariableSpeed() and
+ *             rpmToStepsPerSecond() - what the 10 ms speed update did before the table
+ *   table     wrap-safe table index and one load from buildSpeedTable()'s output
+ *
+ * Both are timed over the same position sequence (ns per lookup). The table is then checked
+ * against the exact profile at every microstep of an output revolution, for every strength,
+ * phase and setpoint below: the relative error must stay within k/sqrt(1-k²) * pi/SPEED_TABLE_SIZE
+ * (the slope of the profile over half a bin) plus one step/s of integer truncation, and the table
+ * must be at least SPEED_TABLE_BENCH_MIN_SPEEDUP times faster. The "bound" column is the widest
+ * checked bound of its row, truncation term included. A failed check makes the program exit with
+ * status 1.
+ *
+ * Usage: program [lookups]   (default 10000000)
+ */
+
+#include <Arduino.h>
+#include <chrono>
+#include "StepperController.h"
+
+#define SPEED_TABLE_BENCH_DEFAULT_LOOKUPS 10000000
+#define SPEED_TABLE_BENCH_MIN_SPEEDUP 2.0 // Table lookup against the closed-form path
+#define SPEED_TABLE_BENCH_POSITION_STRIDE 7919 // Microsteps between timed lookups (prime, covers every bin)
+
+static const float strengths[] = {0.25f, 0.5f, 0.75f, 1.0f};
+static const float phases[] = {0.0f, 1.0f, 3.14159265f, 5.0f}; // radians
+static const float setpoints[] = {1.0f, 5.0f, 20.0f};           // RPM
+
+// The speed update before the table: position angle, closed form, RPM conversion
+__attribute__((noinline)) static uint32_t formulaLookup(int32_t relativePosition, float setpointRPM, float k, float k0, float phase) {
+    const float stepsPerOutputRev = static_cast<float>(TOTAL_MICRO_STEPS_PER_REVOLUTION);
+    const float angle = (6.28318530718f * static_cast<float>(relativePosition)) / stepsPerOutputRev;
+    return StepperController::rpmToStepsPerSecond(StepperController::calculateVariableSpeed(setpointRPM, k, k0, phase, angle));
+}
+
+// The speed update now: reduce to one revolution, index, load
+__attribute__((noinline)) static uint32_t tableLookup(int32_t relativePosition, const uint32_t* table) {
+    int32_t positionInRevolution = relativePosition % TOTAL_MICRO_STEPS_PER_REVOLUTION;
+    if (positionInRevolution < 0) {
+        positionInRevolution += TOTAL_MICRO_STEPS_PER_REVOLUTION;
+    }
+    return table[(static_cast<uint32_t>(positionInRevolution) * SPEED_TABLE_SIZE) / TOTAL_MICRO_STEPS_PER_REVOLUTION];
+}
+
+// Exact profile in steps/s (double precision, no truncation)
+static double exactStepsPerSecond(int32_t position, float setpointRPM, float k, float k0, float phase) {
+    const double angle = 2.0 * PI * position / TOTAL_MICRO_STEPS_PER_REVOLUTION + phase;
+    const double rpm = constrain(setpointRPM * k0 / (1.0 + k * cos(angle)), (double)MIN_SPEED_RPM, (double)MAX_SPEED_RPM);
+    return rpm * TOTAL_MICRO_STEPS_PER_REVOLUTION / 60.0;
+}
+
+static double elapsedNs(std::chrono::steady_clock::time_point start, uint32_t lookups) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / lookups;
+}
+
+int main(int argc, char** argv) {
+    const uint32_t lookups = argc > 1 ? (uint32_t)atol(argv[1]) : SPEED_TABLE_BENCH_DEFAULT_LOOKUPS;
+    int failures = 0;
+
+    // Timing at 50% strength, 5 RPM
+    float k, k0;
+    StepperController::calculateSpeedVariationK(0.5f, k, k0);
+    const float phase = 1.0f;
+    uint32_t table[SPEED_TABLE_SIZE];
+    StepperController::buildSpeedTable(table, 5.0f, k, k0, phase);
+
+    volatile uint32_t sink = 0;
+    uint32_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < lookups; i++) {
+        sum += formulaLookup(static_cast<int32_t>(i * SPEED_TABLE_BENCH_POSITION_STRIDE), 5.0f, k, k0, phase);
+    }
+    const double formulaNs = elapsedNs(start, lookups);
+    sink = sum;
+
+    sum = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < lookups; i++) {
+        sum += tableLookup(static_cast<int32_t>(i * SPEED_TABLE_BENCH_POSITION_STRIDE), table);
+    }
+    const double tableNs = elapsedNs(start, lookups);
+    sink = sum;
+    (void)sink;
+
+    const double speedup = formulaNs / tableNs;
+    printf("lookup    formula %6.1f ns   table %6.1f ns   speed-up %.1fx   (%u lookups)\n",
+           formulaNs, tableNs, speedup, (unsigned)lookups);
+    if (speedup < SPEED_TABLE_BENCH_MIN_SPEEDUP) {
+        printf("CHECK FAILED: table lookup only %.1fx faster (at least %.1fx expected)\n", speedup, SPEED_TABLE_BENCH_MIN_SPEEDUP);
+        failures++;
+    }
+
+    // Error of both paths against the exact profile at every microstep of one revolution
+    printf("strength  setpoint  bound     table max  formula max\n");
+    for (float strength : strengths) {
+        StepperController::calculateSpeedVariationK(strength, k, k0);
+        const double bound = k / sqrt(1.0 - k * k) * PI / SPEED_TABLE_SIZE;
+
+        for (float setpointRPM : setpoints) {
+            double tableWorst = 0.0;
+            double formulaWorst = 0.0;
+            double checkedBound = 0.0; // Widest bound + truncation term checked in this row
+            for (float profilePhase : phases) {
+                StepperController::buildSpeedTable(table, setpointRPM, k, k0, profilePhase);
+                for (int32_t position = 0; position < TOTAL_MICRO_STEPS_PER_REVOLUTION; position++) {
+                    const double exact = exactStepsPerSecond(position, setpointRPM, k, k0, profilePhase);
+                    const double tableError = fabs(tableLookup(position, table) - exact) / exact;
+                    const double formulaError = fabs(formulaLookup(position, setpointRPM, k, k0, profilePhase) - exact) / exact;
+                    const double positionBound = bound + 1.0 / exact;
+                    tableWorst = max(tableWorst, tableError);
+                    formulaWorst = max(formulaWorst, formulaError);
+                    checkedBound = max(checkedBound, positionBound);
+
+                    if (tableError > positionBound) {
+                        printf("CHECK FAILED: strength %.2f, %.1f RPM, phase %.2f, position %d: error %.3f%% above bound %.3f%%\n",
+                               strength, setpointRPM, profilePhase, (int)position, 100.0 * tableError, 100.0 * positionBound);
+                        failures++;
+                    }
+                }
+            }
+            printf("%8.2f  %6.1f    %6.3f%%   %6.3f%%    %6.3f%%\n",
+                   strength, setpointRPM, 100.0 * checkedBound, 100.0 * tableWorst, 100.0 * formulaWorst);
+        }
+    }
+
+    printf("%s (%d failed checks)\n", failures == 0 ? "PASS" : "FAIL", failures);
+    return failures == 0 ? 0 : 1;
+}
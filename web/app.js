@@ -538,6 +538,11 @@ class BratenDreherApp {
         this.controls.get('presetButtons').options.onClick = (value, index, button) => {
             const speed = parseFloat(button.dataset.speed);
             this.controls.get('speedSlider').setValue(speed);
+            if (button.dataset.acceleration || button.dataset.variationStrength) {
+                // Full preset: all parameters in one transaction (controls follow its status update)
+                this.applyPreset(button.dataset);
+                return;
+            }
             this.bindings.get('speed').handleValueChange(speed);
         };
 
@@ -732,12 +737,25 @@ class BratenDreherApp {
         }
     }
 
+    async applyPreset(dataset) {
+        const parameters = { speed: parseFloat(dataset.speed) };
+        if (dataset.acceleration) parameters.acceleration = parseInt(dataset.acceleration, 10);
+        if (dataset.variationStrength) {
+            parameters.speedVariationStrength = parseFloat(dataset.variationStrength);
+            parameters.speedVariationEnabled = parameters.speedVariationStrength > 0;
+        }
+        if (dataset.variationPhase) parameters.speedVariationPhase = parseFloat(dataset.variationPhase);
+        await this.commandManager.sendTransaction(parameters);
+    }
+
     async emergencyStop() {
         console.log('Emergency stop triggered');
         
         // Hide speed fill during emergency stop
         this.controls.get('speedSlider').hideFill();
         
+        // Immediate stop through the firmware's fast lane, then disable like the motor switch
+        await this.commandManager.sendCommand('emergency_stop', true);
         await this.bindings.get('motor').handleValueChange(false);
         
         // Visual feedback
@@ -2,6 +2,19 @@
  * Command Manager - Handles all BLE communication and command processing
  * Separated from UI controls for better architecture
  */
+
+// Command ack result codes (CommandResult in the firmware)
+const CommandResult = {
+    OK: 0,          // Applied as requested
+    ADJUSTED: 1,    // Applied with a different value (ack value)
+    REJECTED: 2,    // Not applied (the device also sends an error notification)
+    QUEUE_FULL: 3,  // Device command queue full - may be sent again
+    UNAVAILABLE: 4  // Axis not fitted
+};
+
+// Setpoints the device coalesces last-writer-wins: one ack settles older writes of the same setpoint
+const COALESCED_COMMANDS = ['speed', 'current', 'acceleration', 'speed_variation_strength', 'speed_variation_phase'];
+
 class CommandManager {
     constructor() {
         // BLE Service and Characteristic UUIDs (must match ESP32)
@@ -18,14 +31,23 @@ class CommandManager {
         this.connected = false;
         this.intentionalDisconnect = false;
         
-        // Timeout and retry handling
-        this.pendingCommands = new Map(); // Track pending commands for timeout/retry
+        // Acks, timeout and retry handling. Every tracked command carries a sequence number that the
+        // device acknowledges once it took effect, so commands are pipelined without waiting for each other;
+        // the timeout only covers lost acks.
+        this.pendingCommands = new Map(); // In-flight commands by sequence number
         this.commandTimeout = 5000; // 5 second timeout
+        this.nextSeq = 1; // 1-65535 (0 = no ack)
+        this.sendOrder = 0; // Monotonic, orders pending commands across sequence number wrap-around
+        this.maxInFlight = 8; // Unacknowledged commands before further ones wait (device queue holds 20)
+        this.sendQueue = []; // Commands waiting for an in-flight slot
+        this.writeChain = Promise.resolve(); // GATT writes must not overlap
+        this.acksSupported = false; // Firmware without acks: status updates settle pending commands instead
         
         // Event callbacks
         this.onConnectionChange = null;
         this.onStatusUpdate = null;
         this.onNotification = null;
+        this.onCommandAck = null; // ({type, value, result, appliedValue}) for every acknowledged command
         
         // Bind the disconnect handler
         this.onDisconnectedHandler = () => {
@@ -149,6 +171,7 @@ class CommandManager {
 
         // Clear pending commands
         this.pendingCommands.clear();
+        this.sendQueue = [];
 
         this.updateConnectionStatus('Disconnected');
         console.log('Disconnected from BratenDreher');
@@ -238,7 +261,7 @@ class CommandManager {
         }
     }
 
-    // Command Sending with Timeout and Retry
+    // Command Sending with Acks, Timeout and Retry
     async sendCommand(type, value, additionalParams = {}) {
         if (!this.device || !this.device.gatt || !this.device.gatt.connected) {
             console.error(`Cannot send ${type} command: Device not connected`);
@@ -251,54 +274,85 @@ class CommandManager {
             return false;
         }
 
+        const tracked = type !== 'status_request';
+        if (type === 'emergency_stop') {
+            // Commands still waiting for a slot were issued before the stop - they must not restart the motor
+            this.sendQueue = [];
+        } else if (tracked && this.pendingCommands.size >= this.maxInFlight) {
+            this.sendQueue.push({ type, value, additionalParams });
+            return true;
+        }
+        
+        return this.writeCommand(type, value, additionalParams, tracked, 0);
+    }
+
+    async writeCommand(type, value, additionalParams, tracked, retryCount) {
+        const command = { type, value, ...additionalParams };
+        let seq = 0;
+        if (tracked) {
+            seq = this.nextSeq;
+            this.nextSeq = this.nextSeq >= 65535 ? 1 : this.nextSeq + 1;
+            command.seq = seq;
+            
+            // Registered before the write - the ack may arrive before writeValue() resolves
+            this.pendingCommands.set(seq, {
+                type,
+                value,
+                additionalParams,
+                axis: additionalParams.axis || 0,
+                order: this.sendOrder++,
+                timestamp: Date.now(),
+                retryCount
+            });
+            setTimeout(() => {
+                this.handleCommandTimeout(seq);
+            }, this.commandTimeout);
+        }
+
         try {
-            const command = { type, value, ...additionalParams };
             const commandString = JSON.stringify(command);
-            await this.commandCharacteristic.writeValue(new TextEncoder().encode(commandString));
+            const write = this.writeChain.then(() =>
+                this.commandCharacteristic.writeValue(new TextEncoder().encode(commandString)));
+            this.writeChain = write.catch(() => {});
+            await write;
             console.log(`Command sent: ${commandString}`);
-            
-            // Track command for timeout handling (if not a status request)
-            if (type !== 'status_request') {
-                const commandId = `${type}_${Date.now()}`;
-                this.pendingCommands.set(commandId, {
-                    type,
-                    value,
-                    additionalParams,
-                    timestamp: Date.now(),
-                    retryCount: 0
-                });
-                
-                // Set timeout
-                setTimeout(() => {
-                    this.handleCommandTimeout(commandId);
-                }, this.commandTimeout);
-            }
-            
             return true;
         } catch (error) {
+            this.pendingCommands.delete(seq);
             console.error(`Failed to send ${type} command:`, error);
             this.handleBLEError(error, `Failed to send ${type} command`);
             return false;
         }
     }
 
-    handleCommandTimeout(commandId) {
-        const command = this.pendingCommands.get(commandId);
-        if (!command) return; // Command was already processed
+    // Several parameters in one message, validated and applied together by the device and acknowledged
+    // once (keys as in status updates: speed, acceleration, speedVariationStrength, speedVariationPhase,
+    // speedVariationEnabled, enabled)
+    async sendTransaction(parameters, additionalParams = {}) {
+        return this.sendCommand('transaction', parameters, additionalParams);
+    }
+
+    flushSendQueue() {
+        while (this.sendQueue.length > 0 && this.pendingCommands.size < this.maxInFlight && this.connected) {
+            const { type, value, additionalParams } = this.sendQueue.shift();
+            this.writeCommand(type, value, additionalParams, true, 0);
+        }
+    }
+
+    handleCommandTimeout(seq) {
+        const command = this.pendingCommands.get(seq);
+        if (!command) return; // Command was already acknowledged
+        this.pendingCommands.delete(seq);
         
         if (command.retryCount === 0) {
-            // First timeout - attempt retry
+            // No ack - attempt one retry
             console.log(`Retrying command ${command.type} (attempt 2/2)...`);
-            command.retryCount = 1;
-            
-            // Retry the command
             setTimeout(() => {
-                this.sendCommand(command.type, command.value, command.additionalParams);
+                this.writeCommand(command.type, command.value, command.additionalParams, true, 1);
             }, 500);
         } else {
             // Second timeout - give up
             console.warn(`Command ${command.type} failed after retry - giving up`);
-            this.pendingCommands.delete(commandId);
             
             // Notify about communication failure
             if (this.onNotification) {
@@ -308,6 +362,42 @@ class CommandManager {
                 });
             }
         }
+        this.flushSendQueue();
+    }
+
+    handleAck(message) {
+        this.acksSupported = true;
+        // Compact acks: [seq, result] or [seq, result, value in effect]
+        (message.acks || []).forEach(([seq, result, appliedValue]) => {
+            const command = this.pendingCommands.get(seq);
+            if (!command) return; // Settled already (e.g. the other axes of an all-axes command)
+            this.pendingCommands.delete(seq);
+            
+            if (COALESCED_COMMANDS.includes(command.type)) {
+                this.pendingCommands.forEach((other, otherSeq) => {
+                    if (other.type === command.type && other.axis === command.axis && other.order < command.order) {
+                        this.pendingCommands.delete(otherSeq);
+                    }
+                });
+            }
+            
+            if (result === CommandResult.QUEUE_FULL && command.retryCount === 0) {
+                // The device queue drains within milliseconds - send again right away
+                console.log(`Device queue full - resending ${command.type}`);
+                this.writeCommand(command.type, command.value, command.additionalParams, true, 1);
+            } else if (result === CommandResult.REJECTED || result === CommandResult.UNAVAILABLE ||
+                       result === CommandResult.QUEUE_FULL) {
+                console.warn(`Command ${command.type} not applied (result ${result})`);
+            } else if (result === CommandResult.ADJUSTED) {
+                console.log(`Command ${command.type} applied as ${appliedValue} instead of ${command.value}`);
+            }
+            
+            if (this.onCommandAck) {
+                this.onCommandAck({ type: command.type, value: command.value, result, appliedValue });
+            }
+        });
+        
+        this.flushSendQueue();
     }
 
     // Message Handling
@@ -317,12 +407,17 @@ class CommandManager {
             const message = JSON.parse(value);
             
             if (message.type === 'status_update') {
-                // Clear any pending commands that might be related to this status
-                this.clearRelatedPendingCommands(message);
+                // Older firmware without acks: clear pending commands that might be related to this status
+                if (!this.acksSupported) {
+                    this.clearRelatedPendingCommands(message);
+                    this.flushSendQueue();
+                }
                 
                 if (this.onStatusUpdate) {
                     this.onStatusUpdate(message);
                 }
+            } else if (message.type === 'ack') {
+                this.handleAck(message);
             } else if (message.type === 'notification') {
                 if (this.onNotification) {
                     this.onNotification(message);
@@ -361,11 +456,13 @@ class CommandManager {
             'enabled': ['enable'],
             'current': ['current'],
             'acceleration': ['acceleration'],
+            'jerkLimit': ['jerk_limit'],
             'speedVariationEnabled': ['enable_speed_variation', 'disable_speed_variation'],
             'speedVariationStrength': ['speed_variation_strength'],
             'speedVariationPhase': ['speed_variation_phase'],
             'stallguardThreshold': ['stallguard_threshold'],
-            'pdNegotiationStatus': ['pd_voltage', 'pd_auto_negotiate']
+            'pdNegotiationStatus': ['pd_voltage', 'pd_auto_negotiate'],
+            'transaction': ['transaction']
         };
         
         for (const [statusKey, relatedCommands] of Object.entries(statusToCommandMap)) {